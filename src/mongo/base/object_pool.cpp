@@ -0,0 +1,60 @@
+#include "mongo/base/object_pool.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+AtomicInt32 objectPoolThreadCacheBytes(256 * 1024);
+AtomicInt32 objectPoolSharedCacheBytes(4 * 1024 * 1024);
+
+ObjectPoolStats::ObjectPoolStats(const std::type_info& type, size_t objectSize)
+    : typeName(demangleName(type)), objectSize(objectSize) {}
+
+void ObjectPoolStats::append(BSONObjBuilder* bob) const {
+    auto residentCnt = std::max<long long>(0, resident.load(std::memory_order_relaxed));
+    bob->append("objectSize", static_cast<long long>(objectSize));
+    bob->append("hits", static_cast<long long>(hits.load(std::memory_order_relaxed)));
+    bob->append("sharedHits", static_cast<long long>(sharedHits.load(std::memory_order_relaxed)));
+    bob->append("misses", static_cast<long long>(misses.load(std::memory_order_relaxed)));
+    bob->append("sharedReturns",
+                static_cast<long long>(sharedReturns.load(std::memory_order_relaxed)));
+    bob->append("freed", static_cast<long long>(freed.load(std::memory_order_relaxed)));
+    bob->append("resident", residentCnt);
+    bob->append("residentBytes", residentCnt * static_cast<long long>(objectSize));
+}
+
+ObjectPoolRegistry& ObjectPoolRegistry::get() {
+    // Leaked on purpose, see ObjectPool<T>::_shared().
+    static ObjectPoolRegistry* const registry = new ObjectPoolRegistry();
+    return *registry;
+}
+
+void ObjectPoolRegistry::add(ObjectPoolStats* stats, TrimFn trimShared, TrimFn trimThreads) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _pools.push_back({stats, trimShared, trimThreads});
+}
+
+void ObjectPoolRegistry::trim() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& pool : _pools) {
+        pool.trimShared();
+    }
+    _trimEpoch.fetch_add(1, std::memory_order_relaxed);
+
+    // Objects handed over by idle threads go to the shared caches, which free them at the next
+    // trim if nobody needs them.
+    for (const auto& pool : _pools) {
+        pool.trimThreads();
+    }
+}
+
+void ObjectPoolRegistry::appendStats(BSONObjBuilder* bob) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& pool : _pools) {
+        BSONObjBuilder poolBuilder(bob->subobjStart(pool.stats->typeName));
+        pool.stats->append(&poolBuilder);
+    }
+}
+
+}  // namespace mongo
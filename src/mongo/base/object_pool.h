@@ -1,14 +1,109 @@
 #pragma once
 
-#include "mongo/db/modules/monograph/tx_service/include/circular_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <stack>
+#include <string>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+#include <bthread/moodycamelqueue.h>
+
 namespace mongo {
+class BSONObjBuilder;
+
 template <typename T>
 void deinit(T* ptr) {}
 
+/*
+  Byte budgets for cached objects of a single type. The number of objects a cache may hold is
+  the budget divided by sizeof(T), so large types keep fewer objects around than small ones.
+  Exported as server parameters by the server status section which reports pool statistics.
+*/
+extern AtomicInt32 objectPoolThreadCacheBytes;
+extern AtomicInt32 objectPoolSharedCacheBytes;
+
+/*
+  Counters for one pooled type, aggregated over all threads. Thread caches publish their
+  counters in batches, so the values may lag behind by a few operations per thread.
+*/
+struct ObjectPoolStats {
+    ObjectPoolStats(const std::type_info& type, size_t objectSize);
+
+    void append(BSONObjBuilder* bob) const;
+
+    const std::string typeName;
+    const size_t objectSize;
+
+    // Objects served from the calling thread's cache.
+    std::atomic<uint64_t> hits{0};
+    // Objects served from the shared cache.
+    std::atomic<uint64_t> sharedHits{0};
+    // Objects which had to be constructed.
+    std::atomic<uint64_t> misses{0};
+    // Objects handed to the shared cache because a thread cache was full, trimmed or exiting.
+    std::atomic<uint64_t> sharedReturns{0};
+    // Objects deleted because every cache was full, or by trimming.
+    std::atomic<uint64_t> freed{0};
+    // Objects currently cached in thread caches and in the shared cache.
+    std::atomic<int64_t> resident{0};
+};
+
+/*
+  Keeps track of every ObjectPool<T> instantiated in the process.
+*/
+class ObjectPoolRegistry {
+public:
+    using TrimFn = void (*)();
+
+    static ObjectPoolRegistry& get();
+
+    void add(ObjectPoolStats* stats, TrimFn trimShared, TrimFn trimThreads);
+
+    /*
+      Frees objects which sat unused in the shared caches since the previous trim, and asks
+      each thread cache to hand over its own unused objects the next time it is used. Thread
+      caches which are not in use right now are trimmed right away, so that threads which stay
+      idle do not hold on to their objects forever.
+    */
+    void trim();
+
+    uint64_t trimEpoch() const {
+        return _trimEpoch.load(std::memory_order_relaxed);
+    }
+
+    void appendStats(BSONObjBuilder* bob) const;
+
+private:
+    struct Pool {
+        ObjectPoolStats* stats;
+        TrimFn trimShared;
+        TrimFn trimThreads;
+    };
+
+    mutable stdx::mutex _mutex;
+    std::vector<Pool> _pools;
+    std::atomic<uint64_t> _trimEpoch{0};
+};
+
+/*
+  Recycles objects of type T. T must provide reset() taking the same arguments as one of its
+  constructors.
+
+  Each thread keeps a bounded LIFO cache. Objects recycled by a thread whose cache is full go
+  to a lock-free cache shared by all threads, from which threads refill on a local miss, so
+  objects freed away from the thread that allocated them flow back to the threads which need
+  them instead of piling up. Beyond both caches, objects are deleted.
+
+  A thread cache is only used by its thread, except by ObjectPoolRegistry::trim() while the
+  thread does not use it. An uncontended flag tells them apart.
+*/
 template <typename T>
 class ObjectPool {
 public:
@@ -20,8 +115,7 @@ public:
     class Deleter {
     public:
         void operator()(T* ptr) {
-            deinit(ptr);
-            _localPool.Enqueue(std::unique_ptr<T>(ptr));
+            recycleObject(ptr);
         }
     };
 
@@ -31,51 +125,23 @@ public:
     */
     template <typename Base>
     static void PolyDeleter(Base* ptr) {
-        T* dptr = static_cast<T*>(ptr);
-        deinit(dptr);
-        _localPool.Enqueue(std::unique_ptr<T>(dptr));
+        recycleObject(static_cast<T*>(ptr));
     }
 
     template <typename... Args>
     static std::unique_ptr<T, Deleter> newObject(Args&&... args) {
-        T* ptr{nullptr};
-
-        if (_localPool.Size() == 0) {
-            ptr = new T(std::forward<Args>(args)...);
-        } else {
-            ptr = _localPool.Peek().release();
-            _localPool.Dequeue();
-            ptr->reset(std::forward<Args>(args)...);
-        }
-        return std::unique_ptr<T, Deleter>(ptr);
+        return std::unique_ptr<T, Deleter>(newObjectRawPointer(std::forward<Args>(args)...));
     }
 
     template <typename Base, typename... Args>
     static std::unique_ptr<Base, void (*)(Base*)> newObject(Args&&... args) {
-        T* ptr{nullptr};
-
-        if (_localPool.Size() == 0) {
-            ptr = new T(std::forward<Args>(args)...);
-        } else {
-            ptr = _localPool.Peek().release();
-            _localPool.Dequeue();
-            ptr->reset(std::forward<Args>(args)...);
-        }
-        return std::unique_ptr<Base, void (*)(Base*)>(ptr, &PolyDeleter<Base>);
+        return std::unique_ptr<Base, void (*)(Base*)>(
+            newObjectRawPointer(std::forward<Args>(args)...), &PolyDeleter<Base>);
     }
 
     template <typename... Args>
     static std::shared_ptr<T> newObjectSharedPointer(Args&&... args) {
-        T* ptr{nullptr};
-
-        if (_localPool.Size() == 0) {
-            ptr = new T(std::forward<Args>(args)...);
-        } else {
-            ptr = _localPool.Peek().release();
-            _localPool.Dequeue();
-            ptr->reset(std::forward<Args>(args)...);
-        }
-        return std::shared_ptr<T>(ptr, Deleter());
+        return std::shared_ptr<T>(newObjectRawPointer(std::forward<Args>(args)...), Deleter());
     }
 
     /*
@@ -86,15 +152,11 @@ public:
     */
     template <typename... Args>
     static T* newObjectRawPointer(Args&&... args) {
-        T* ptr{nullptr};
-
-        if (_localPool.Size() == 0) {
-            ptr = new T(std::forward<Args>(args)...);
-        } else {
-            ptr = _localPool.Peek().release();
-            _localPool.Dequeue();
-            ptr->reset(std::forward<Args>(args)...);
+        T* ptr = _acquire();
+        if (!ptr) {
+            return new T(std::forward<Args>(args)...);
         }
+        ptr->reset(std::forward<Args>(args)...);
         return ptr;
     }
 
@@ -104,125 +166,249 @@ public:
     */
     static void recycleObject(T* ptr) {
         deinit(ptr);
-        _localPool.Enqueue(std::unique_ptr<T>(ptr));
+
+        LocalCache& cache = _localCache;
+        CacheGuard guard(cache);
+        _maybeTrimLocal(cache);
+        if (cache.objects.size() < _threadCapacity()) {
+            cache.objects.push_back(ptr);
+            cache.resident++;
+            _countOp(cache);
+        } else {
+            _releaseToShared(ptr);
+        }
+    }
+
+    static const ObjectPoolStats& stats() {
+        return _shared().stats;
+    }
+
+    /*
+      Number of objects cached by the calling thread and by the shared cache.
+    */
+    static size_t localCacheSize() {
+        return _localCache.objects.size();
+    }
+
+    static size_t sharedCacheSize() {
+        return _shared().size.load(std::memory_order_relaxed);
     }
 
 private:
-    static constexpr size_t kDefaultCapacity{32};
-    static thread_local CircularQueue<std::unique_ptr<T>> _localPool;
-};
+    // Number of operations after which a thread cache publishes its counters.
+    static constexpr uint32_t kStatsFlushInterval{64};
 
-template <typename T>
-thread_local CircularQueue<std::unique_ptr<T>> ObjectPool<T>::_localPool = {};
+    struct LocalCache;
 
-}  // namespace mongo
+    struct Shared {
+        Shared() : stats(typeid(T), sizeof(T)) {
+            ObjectPoolRegistry::get().add(
+                &stats, &ObjectPool::_trimShared, &ObjectPool::_trimIdleThreads);
+        }
 
+        ObjectPoolStats stats;
+        moodycamel::ConcurrentQueue<T*> queue;
+        std::atomic<size_t> size{0};
+        // Smallest size since the previous trim. Approximate, objects above it were idle.
+        std::atomic<size_t> lowWater{0};
+
+        // Thread caches of the live threads.
+        stdx::mutex cachesMutex;
+        std::vector<LocalCache*> caches;
+    };
 
-// namespace mongo {
-// template <typename T>
-// class ObjectPool {
-// public:
-//     ObjectPool() = default;
-//     ~ObjectPool() = default;
-//     ObjectPool(const ObjectPool&) = delete;
-//     ObjectPool(ObjectPool&&) = delete;
-
-//     class Deleter {
-//     public:
-//         void operator()(T* ptr) {
-//             _localPool.push(std::unique_ptr<T>(ptr));
-//         }
-//     };
-
-//     /*
-//       Implicitly convert type for classes which need a polymorphism Deleter.
-//       For example, RecoveryUnit and MonographRecoveryUnit
-//     */
-//     template <typename Base>
-//     static void PolyDeleter(Base* ptr) {
-//         _localPool.push(std::unique_ptr<T>(static_cast<T*>(ptr)));
-//     }
-
-//     template <typename... Args>
-//     static std::unique_ptr<T, Deleter> newObject(Args&&... args) {
-//         T* ptr{nullptr};
-
-//         if (_localPool.empty()) {
-//             ptr = new T(std::forward<Args>(args)...);
-//         } else {
-//             ptr = _localPool.top().release();
-//             _localPool.pop();
-//             ptr->reset(std::forward<Args>(args)...);
-//         }
-//         return std::unique_ptr<T, Deleter>(ptr);
-//     }
-
-//     template <typename Base, typename... Args>
-//     static std::unique_ptr<Base, void (*)(Base*)> newObject(Args&&... args) {
-//         T* ptr{nullptr};
-
-//         if (_localPool.empty()) {
-//             ptr = new T(std::forward<Args>(args)...);
-//         } else {
-//             ptr = _localPool.top().release();
-//             _localPool.pop();
-//             ptr->reset(std::forward<Args>(args)...);
-//         }
-//         return std::unique_ptr<Base, void (*)(Base*)>(ptr, &PolyDeleter<Base>);
-//     }
-
-//     template <typename... Args>
-//     static std::shared_ptr<T> newObjectSharedPointer(Args&&... args) {
-//         T* ptr{nullptr};
-
-//         if (_localPool.empty()) {
-//             ptr = new T(std::forward<Args>(args)...);
-//         } else {
-//             ptr = _localPool.top().release();
-//             _localPool.pop();
-//             ptr->reset(std::forward<Args>(args)...);
-//         }
-//         return std::shared_ptr<T>(ptr, Deleter());
-//     }
-
-//     /*
-//       Some Mongo classes have owned custom deleter.
-//       We could modify their custom to reuse Object
-//       instead of returning std::unique_ptr<T, Deleter> when creation.
-//       For example, PlanExecutor
-//     */
-//     template <typename... Args>
-//     static T* newObjectRawPointer(Args&&... args) {
-//         T* ptr{nullptr};
-
-//         if (_localPool.empty()) {
-//             ptr = new T(std::forward<Args>(args)...);
-//         } else {
-//             ptr = _localPool.top().release();
-//             _localPool.pop();
-//             ptr->reset(std::forward<Args>(args)...);
-//         }
-//         return ptr;
-//     }
-
-//     /*
-//       Only class that allocate call newObjectRawPointer
-//       need call this function to recycle object manually.
-//     */
-//     static void recycleObject(T* ptr) {
-//         _localPool.push(std::unique_ptr<T>(ptr));
-//     }
-
-// private:
-//     static constexpr size_t kDefaultCapacity{32};
-//     static thread_local std::stack<std::unique_ptr<T>, std::vector<std::unique_ptr<T>>>
-//     _localPool;
-// };
-
-// template <typename T>
-// thread_local std::stack<std::unique_ptr<T>, std::vector<std::unique_ptr<T>>>
-// ObjectPool<T>::_localPool = {};
-
-
-// }  // namespace mongo
+    struct LocalCache {
+        LocalCache() {
+            Shared& shared = _shared();
+            stdx::lock_guard<stdx::mutex> lk(shared.cachesMutex);
+            shared.caches.push_back(this);
+        }
+
+        ~LocalCache() {
+            {
+                Shared& shared = _shared();
+                stdx::lock_guard<stdx::mutex> lk(shared.cachesMutex);
+                shared.caches.erase(std::find(shared.caches.begin(), shared.caches.end(), this));
+            }
+
+            for (T* ptr : objects) {
+                resident--;
+                _releaseToShared(ptr);
+            }
+            objects.clear();
+            _flushStats(*this);
+        }
 
+        // Set while the owning thread or the trimmer uses the cache.
+        std::atomic<bool> inUse{false};
+
+        std::vector<T*> objects;
+        // Smallest size since the previous trim.
+        size_t lowWater{0};
+        uint64_t trimEpoch{0};
+
+        // Counter deltas not yet published to the shared stats.
+        uint64_t hits{0};
+        uint64_t misses{0};
+        int64_t resident{0};
+        uint32_t pendingOps{0};
+    };
+
+    class CacheGuard {
+    public:
+        explicit CacheGuard(LocalCache& cache) : _cache(cache) {
+            // Only contended while the trimmer works on an idle cache, which takes microseconds.
+            while (_cache.inUse.exchange(true, std::memory_order_acquire)) {
+            }
+        }
+
+        ~CacheGuard() {
+            _cache.inUse.store(false, std::memory_order_release);
+        }
+
+    private:
+        LocalCache& _cache;
+    };
+
+    static size_t _capacity(int budgetBytes) {
+        return budgetBytes > 0 ? static_cast<size_t>(budgetBytes) / sizeof(T) : 0;
+    }
+
+    static size_t _threadCapacity() {
+        return std::max<size_t>(_capacity(objectPoolThreadCacheBytes.load()), 1);
+    }
+
+    static size_t _sharedCapacity() {
+        return _capacity(objectPoolSharedCacheBytes.load());
+    }
+
+    // Leaked on purpose, threads may still recycle objects while the process exits.
+    static Shared& _shared() {
+        static Shared* const shared = new Shared();
+        return *shared;
+    }
+
+    static T* _acquire() {
+        LocalCache& cache = _localCache;
+        {
+            CacheGuard guard(cache);
+            _maybeTrimLocal(cache);
+            if (!cache.objects.empty()) {
+                T* ptr = cache.objects.back();
+                cache.objects.pop_back();
+                cache.lowWater = std::min(cache.lowWater, cache.objects.size());
+                cache.hits++;
+                cache.resident--;
+                _countOp(cache);
+                return ptr;
+            }
+        }
+
+        Shared& shared = _shared();
+        T* ptr{nullptr};
+        if (shared.size.load(std::memory_order_relaxed) > 0 && shared.queue.try_dequeue(ptr)) {
+            size_t size = shared.size.fetch_sub(1, std::memory_order_relaxed) - 1;
+            if (size < shared.lowWater.load(std::memory_order_relaxed)) {
+                shared.lowWater.store(size, std::memory_order_relaxed);
+            }
+            shared.stats.sharedHits.fetch_add(1, std::memory_order_relaxed);
+            shared.stats.resident.fetch_sub(1, std::memory_order_relaxed);
+            return ptr;
+        }
+
+        CacheGuard guard(cache);
+        cache.misses++;
+        _countOp(cache);
+        return nullptr;
+    }
+
+    static void _releaseToShared(T* ptr) {
+        Shared& shared = _shared();
+        if (shared.size.load(std::memory_order_relaxed) < _sharedCapacity()) {
+            shared.size.fetch_add(1, std::memory_order_relaxed);
+            shared.queue.enqueue(ptr);
+            shared.stats.sharedReturns.fetch_add(1, std::memory_order_relaxed);
+            shared.stats.resident.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            delete ptr;
+            shared.stats.freed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /*
+      Hands the objects this thread did not need since the previous trim over to the shared
+      cache, where other threads can use them or the next trim frees them.
+    */
+    static void _maybeTrimLocal(LocalCache& cache) {
+        uint64_t epoch = ObjectPoolRegistry::get().trimEpoch();
+        if (cache.trimEpoch == epoch) {
+            return;
+        }
+        cache.trimEpoch = epoch;
+
+        size_t idle = std::min(cache.lowWater, cache.objects.size());
+        for (size_t i = 0; i < idle; ++i) {
+            cache.resident--;
+            _releaseToShared(cache.objects.back());
+            cache.objects.pop_back();
+        }
+        cache.lowWater = cache.objects.size();
+        _flushStats(cache);
+    }
+
+    static void _trimShared() {
+        Shared& shared = _shared();
+        size_t idle = std::min(shared.lowWater.load(std::memory_order_relaxed),
+                               shared.size.load(std::memory_order_relaxed));
+        T* ptr{nullptr};
+        for (size_t i = 0; i < idle && shared.queue.try_dequeue(ptr); ++i) {
+            shared.size.fetch_sub(1, std::memory_order_relaxed);
+            delete ptr;
+            shared.stats.freed.fetch_add(1, std::memory_order_relaxed);
+            shared.stats.resident.fetch_sub(1, std::memory_order_relaxed);
+        }
+        shared.lowWater.store(shared.size.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+    }
+
+    /*
+      Trims, on behalf of their threads, the thread caches not in use at the moment. A thread
+      which stays idle would otherwise never trim its cache. Caches in use are left to their
+      thread, which trims it at its next operation.
+    */
+    static void _trimIdleThreads() {
+        Shared& shared = _shared();
+        stdx::lock_guard<stdx::mutex> lk(shared.cachesMutex);
+        for (LocalCache* cache : shared.caches) {
+            if (cache->inUse.exchange(true, std::memory_order_acquire)) {
+                continue;
+            }
+            _maybeTrimLocal(*cache);
+            cache->inUse.store(false, std::memory_order_release);
+        }
+    }
+
+    static void _countOp(LocalCache& cache) {
+        if (++cache.pendingOps >= kStatsFlushInterval) {
+            _flushStats(cache);
+        }
+    }
+
+    static void _flushStats(LocalCache& cache) {
+        ObjectPoolStats& stats = _shared().stats;
+        stats.hits.fetch_add(cache.hits, std::memory_order_relaxed);
+        stats.misses.fetch_add(cache.misses, std::memory_order_relaxed);
+        stats.resident.fetch_add(cache.resident, std::memory_order_relaxed);
+        cache.hits = 0;
+        cache.misses = 0;
+        cache.resident = 0;
+        cache.pendingOps = 0;
+    }
+
+    static thread_local LocalCache _localCache;
+};
+
+template <typename T>
+thread_local typename ObjectPool<T>::LocalCache ObjectPool<T>::_localCache;
+
+}  // namespace mongo
@@ -0,0 +1,177 @@
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/base/object_pool.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+// Every test uses its own type, pools are shared by all objects of a type in the process.
+struct Widget {
+    explicit Widget(int v) : value(v) {}
+    void reset(int v) {
+        value = v;
+        ++resets;
+    }
+
+    int value;
+    int resets{0};
+};
+
+struct Big {
+    void reset() {}
+    char buf[64 * 1024];
+};
+
+struct Migrating {
+    void reset() {}
+    int value{0};
+};
+
+struct Trimmed {
+    void reset() {}
+    int value{0};
+};
+
+struct Parked {
+    void reset() {}
+    int value{0};
+};
+
+TEST(ObjectPoolTest, RecycledObjectIsReset) {
+    Widget* first = nullptr;
+    {
+        auto widget = ObjectPool<Widget>::newObject(1);
+        first = widget.get();
+    }
+    ASSERT_EQ(1U, ObjectPool<Widget>::localCacheSize());
+
+    auto widget = ObjectPool<Widget>::newObject(2);
+    ASSERT_EQ(first, widget.get());
+    ASSERT_EQ(2, widget->value);
+    ASSERT_EQ(1, widget->resets);
+    ASSERT_EQ(0U, ObjectPool<Widget>::localCacheSize());
+}
+
+TEST(ObjectPoolTest, ThreadCacheIsBoundedBySize) {
+    const int threadCacheBytes = objectPoolThreadCacheBytes.load();
+    ON_BLOCK_EXIT([&] { objectPoolThreadCacheBytes.store(threadCacheBytes); });
+    objectPoolThreadCacheBytes.store(2 * sizeof(Big));
+
+    std::vector<Big*> objects;
+    for (int i = 0; i < 4; ++i) {
+        objects.push_back(ObjectPool<Big>::newObjectRawPointer());
+    }
+    for (Big* big : objects) {
+        ObjectPool<Big>::recycleObject(big);
+    }
+
+    ASSERT_EQ(2U, ObjectPool<Big>::localCacheSize());
+    ASSERT_EQ(2U, ObjectPool<Big>::sharedCacheSize());
+}
+
+TEST(ObjectPoolTest, ObjectsRecycledByAnotherThreadAreReused) {
+    Migrating* migrating = ObjectPool<Migrating>::newObjectRawPointer();
+
+    // The other thread's cache hands its objects to the shared cache when the thread exits.
+    stdx::thread([migrating] { ObjectPool<Migrating>::recycleObject(migrating); }).join();
+    ASSERT_EQ(0U, ObjectPool<Migrating>::localCacheSize());
+    ASSERT_EQ(1U, ObjectPool<Migrating>::sharedCacheSize());
+
+    auto sharedHits = ObjectPool<Migrating>::stats().sharedHits.load();
+    auto reused = ObjectPool<Migrating>::newObject();
+    ASSERT_EQ(migrating, reused.get());
+    ASSERT_EQ(sharedHits + 1, ObjectPool<Migrating>::stats().sharedHits.load());
+    ASSERT_EQ(0U, ObjectPool<Migrating>::sharedCacheSize());
+}
+
+TEST(ObjectPoolTest, TrimReleasesObjectsIdleForAWholePeriod) {
+    using Pool = ObjectPool<Trimmed>;
+    auto& registry = ObjectPoolRegistry::get();
+
+    std::vector<Trimmed*> objects;
+    for (int i = 0; i < 3; ++i) {
+        objects.push_back(Pool::newObjectRawPointer());
+    }
+    for (Trimmed* trimmed : objects) {
+        Pool::recycleObject(trimmed);
+    }
+    ASSERT_EQ(3U, Pool::localCacheSize());
+
+    // The first trim only starts tracking how many objects stay unused.
+    registry.trim();
+    Pool::recycleObject(Pool::newObjectRawPointer());
+    ASSERT_EQ(3U, Pool::localCacheSize());
+
+    // Two objects were never used since, the thread cache hands them to the shared cache.
+    registry.trim();
+    Pool::recycleObject(Pool::newObjectRawPointer());
+    ASSERT_EQ(1U, Pool::localCacheSize());
+    ASSERT_EQ(2U, Pool::sharedCacheSize());
+
+    // Same for the shared cache, which frees them. The thread cache stays in use meanwhile.
+    auto freed = Pool::stats().freed.load();
+    registry.trim();
+    ASSERT_EQ(2U, Pool::sharedCacheSize());
+    Pool::recycleObject(Pool::newObjectRawPointer());
+    registry.trim();
+    ASSERT_EQ(0U, Pool::sharedCacheSize());
+    ASSERT_EQ(freed + 2, Pool::stats().freed.load());
+}
+
+TEST(ObjectPoolTest, TrimReachesIdleThreads) {
+    using Pool = ObjectPool<Parked>;
+    auto& registry = ObjectPoolRegistry::get();
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool filled = false;
+    bool done = false;
+    size_t cachedWhenDone = 0;
+
+    stdx::thread idleThread([&] {
+        std::vector<Parked*> objects;
+        for (int i = 0; i < 3; ++i) {
+            objects.push_back(Pool::newObjectRawPointer());
+        }
+        for (Parked* parked : objects) {
+            Pool::recycleObject(parked);
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        filled = true;
+        cond.notify_all();
+        cond.wait(lk, [&] { return done; });
+        cachedWhenDone = Pool::localCacheSize();
+    });
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return filled; });
+    }
+
+    // The thread does not touch its cache again, the trimmer hands its objects over instead.
+    registry.trim();
+    size_t sharedAfterFirstTrim = Pool::sharedCacheSize();
+    registry.trim();
+    size_t sharedAfterSecondTrim = Pool::sharedCacheSize();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        done = true;
+        cond.notify_all();
+    }
+    idleThread.join();
+
+    ASSERT_EQ(0U, sharedAfterFirstTrim);
+    ASSERT_EQ(3U, sharedAfterSecondTrim);
+    ASSERT_EQ(0U, cachedWhenDone);
+}
+
+}  // namespace
+}  // namespace mongo
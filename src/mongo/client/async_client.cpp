@@ -190,7 +190,7 @@ Future<void> AsyncDBClient::initWireVersion(const std::string& appName,
 }
 
 Future<Message> AsyncDBClient::_call(Message request, const transport::BatonHandle& baton) {
-    auto swm = _compressorManager.compressMessage(request);
+    auto swm = _compressorManager.maybeCompressMessage(request);
     if (!swm.isOK()) {
         return swm.getStatus();
     }
@@ -215,6 +215,104 @@ Future<Message> AsyncDBClient::_call(Message request, const transport::BatonHand
         });
 }
 
+Future<Message> AsyncDBClient::_pipelinedCall(Message request) {
+    auto swm = _compressorManager.maybeCompressMessage(request);
+    if (!swm.isOK()) {
+        return swm.getStatus();
+    }
+
+    request = std::move(swm.getValue());
+    auto msgId = nextMessageId();
+    request.header().setId(msgId);
+    request.header().setResponseToMsgId(0);
+
+    auto pf = makePromiseFuture<Message>();
+    stdx::unique_lock<stdx::mutex> lk(_pipelineMutex);
+    if (!_pipelineStatus.isOK()) {
+        return _pipelineStatus;
+    }
+    _pipelineReplies.emplace(msgId, std::move(pf.promise));
+    _pipelineSendQueue.push_back(std::move(request));
+    _pumpPipeline(std::move(lk));
+
+    return std::move(pf.future).then([this](Message response) -> StatusWith<Message> {
+        if (response.operation() == dbCompressed) {
+            return _compressorManager.decompressMessage(response);
+        } else {
+            return response;
+        }
+    });
+}
+
+void AsyncDBClient::_pumpPipeline(stdx::unique_lock<stdx::mutex> lk) {
+    boost::optional<Message> toSend;
+    if (!_pipelineSending && !_pipelineSendQueue.empty() && _pipelineStatus.isOK()) {
+        toSend = std::move(_pipelineSendQueue.front());
+        _pipelineSendQueue.pop_front();
+        _pipelineSending = true;
+    }
+
+    bool receive = false;
+    if (!_pipelineReceiving && !_pipelineReplies.empty() && _pipelineStatus.isOK()) {
+        _pipelineReceiving = true;
+        receive = true;
+    }
+
+    // The session may complete an operation inline, so it must not be called under the lock.
+    lk.unlock();
+
+    if (toSend) {
+        _session->asyncSinkMessage(*toSend).getAsync([self = shared_from_this()](Status status) {
+            stdx::unique_lock<stdx::mutex> lk(self->_pipelineMutex);
+            self->_pipelineSending = false;
+            if (!status.isOK()) {
+                return self->_failPipeline(std::move(lk), std::move(status));
+            }
+            self->_pumpPipeline(std::move(lk));
+        });
+    }
+
+    if (receive) {
+        _session->asyncSourceMessage().getAsync([self = shared_from_this()](
+            StatusWith<Message> swm) {
+            stdx::unique_lock<stdx::mutex> lk(self->_pipelineMutex);
+            self->_pipelineReceiving = false;
+            if (!swm.isOK()) {
+                return self->_failPipeline(std::move(lk), swm.getStatus());
+            }
+
+            auto response = std::move(swm.getValue());
+            auto it = self->_pipelineReplies.find(response.header().getResponseToMsgId());
+            if (it == self->_pipelineReplies.end()) {
+                return self->_failPipeline(
+                    std::move(lk),
+                    {ErrorCodes::ProtocolError,
+                     str::stream() << "Received a reply to unknown message id "
+                                   << response.header().getResponseToMsgId()});
+            }
+            auto promise = std::move(it->second);
+            self->_pipelineReplies.erase(it);
+
+            self->_pumpPipeline(std::move(lk));
+            promise.emplaceValue(std::move(response));
+        });
+    }
+}
+
+void AsyncDBClient::_failPipeline(stdx::unique_lock<stdx::mutex> lk, Status status) {
+    if (_pipelineStatus.isOK()) {
+        _pipelineStatus = status;
+    }
+    auto replies = std::move(_pipelineReplies);
+    _pipelineReplies.clear();
+    _pipelineSendQueue.clear();
+    lk.unlock();
+
+    for (auto& reply : replies) {
+        reply.second.setError(status);
+    }
+}
+
 Future<rpc::UniqueReply> AsyncDBClient::runCommand(OpMsgRequest request,
                                                    const transport::BatonHandle& baton) {
     invariant(_negotiatedProtocol);
@@ -242,6 +340,26 @@ Future<executor::RemoteCommandResponse> AsyncDBClient::runCommandRequest(
         });
 }
 
+Future<executor::RemoteCommandResponse> AsyncDBClient::runPipelinedCommandRequest(
+    executor::RemoteCommandRequest request) {
+    invariant(_negotiatedProtocol);
+    auto clkSource = _svcCtx->getPreciseClockSource();
+    auto start = clkSource->now();
+    auto opMsgRequest = OpMsgRequest::fromDBAndBody(
+        std::move(request.dbname), std::move(request.cmdObj), std::move(request.metadata));
+    auto requestMsg = rpc::messageFromOpMsgRequest(*_negotiatedProtocol, std::move(opMsgRequest));
+    return _pipelinedCall(std::move(requestMsg))
+        .then([start, clkSource](Message response) {
+            rpc::UniqueReply reply(response, rpc::makeReply(&response));
+            auto duration = duration_cast<Milliseconds>(clkSource->now() - start);
+            return executor::RemoteCommandResponse(*reply, duration);
+        })
+        .onError([start, clkSource](Status status) {
+            auto duration = duration_cast<Milliseconds>(clkSource->now() - start);
+            return executor::RemoteCommandResponse(status, duration);
+        });
+}
+
 void AsyncDBClient::cancel(const transport::BatonHandle& baton) {
     _session->cancelAsyncOperations(baton);
 }
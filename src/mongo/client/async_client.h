@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/service_context.h"
@@ -36,6 +37,8 @@
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/rpc/protocol.h"
 #include "mongo/rpc/unique_message.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/transport/baton.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/transport_layer.h"
@@ -63,6 +66,15 @@ public:
     Future<rpc::UniqueReply> runCommand(OpMsgRequest request,
                                         const transport::BatonHandle& baton = nullptr);
 
+    /**
+     * Like runCommandRequest, but may be called again before earlier requests finish. Requests
+     * are written in call order and replies are matched to them by responseTo, so that several
+     * requests share the connection. The network I/O runs on the session's reactor. A network
+     * error fails every request in flight, and the connection must not be reused.
+     */
+    Future<executor::RemoteCommandResponse> runPipelinedCommandRequest(
+        executor::RemoteCommandRequest request);
+
     Future<void> authenticate(const BSONObj& params);
 
     Future<void> initWireVersion(const std::string& appName,
@@ -79,6 +91,16 @@ public:
 
 private:
     Future<Message> _call(Message request, const transport::BatonHandle& baton = nullptr);
+
+    Future<Message> _pipelinedCall(Message request);
+
+    /**
+     * Starts sending the next queued request and receiving the next reply, unless either is
+     * already in progress.
+     */
+    void _pumpPipeline(stdx::unique_lock<stdx::mutex> lk);
+    void _failPipeline(stdx::unique_lock<stdx::mutex> lk, Status status);
+
     BSONObj _buildIsMasterRequest(const std::string& appName);
     void _parseIsMasterResponse(BSONObj request,
                                 const std::unique_ptr<rpc::ReplyInterface>& response);
@@ -88,6 +110,14 @@ private:
     ServiceContext* const _svcCtx;
     MessageCompressorManager _compressorManager;
     boost::optional<rpc::Protocol> _negotiatedProtocol;
+
+    stdx::mutex _pipelineMutex;
+    std::deque<Message> _pipelineSendQueue;
+    // Requests written or queued whose reply has not arrived yet, by message id.
+    stdx::unordered_map<int32_t, Promise<Message>> _pipelineReplies;
+    bool _pipelineSending = false;
+    bool _pipelineReceiving = false;
+    Status _pipelineStatus = Status::OK();
 };
 
 }  // namespace mongo
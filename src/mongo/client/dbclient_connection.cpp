@@ -552,7 +552,7 @@ void DBClientConnection::say(Message& toSend, bool isRetry, string* actualServer
     toSend.header().setId(nextMessageId());
     toSend.header().setResponseToMsgId(0);
     uassertStatusOK(
-        _session->sinkMessage(uassertStatusOK(_compressorManager.compressMessage(toSend))));
+        _session->sinkMessage(uassertStatusOK(_compressorManager.maybeCompressMessage(toSend))));
     killSessionOnError.Dismiss();
 }
 
@@ -594,7 +594,7 @@ bool DBClientConnection::call(Message& toSend,
 
     toSend.header().setId(nextMessageId());
     toSend.header().setResponseToMsgId(0);
-    auto swm = _compressorManager.compressMessage(toSend);
+    auto swm = _compressorManager.maybeCompressMessage(toSend);
     uassertStatusOK(swm.getStatus());
 
     auto sinkStatus = _session->sinkMessage(swm.getValue());
@@ -0,0 +1,103 @@
+#include "mongo/db/catalog/catalog_epoch.h"
+
+#include <algorithm>
+
+#include "mongo/db/server_options.h"
+
+namespace mongo {
+extern thread_local int16_t localThreadId;
+
+CatalogEpoch::CatalogEpoch(size_t slots)
+    : _slotCount(std::max<size_t>(slots, 1)), _slots(std::make_unique<Slot[]>(_slotCount)) {}
+
+CatalogEpoch& CatalogEpoch::get() {
+    // Retired objects may still be freed by threads running during shutdown.
+    static CatalogEpoch* const epoch = new CatalogEpoch(serverGlobalParams.reservedThreadNum + 1);
+    return *epoch;
+}
+
+size_t CatalogEpoch::_slotIndex() const {
+    const auto slot = static_cast<size_t>(localThreadId + 1);
+    return slot < _slotCount ? slot : 0;
+}
+
+CatalogEpoch::Pin::Pin(CatalogEpoch& epoch) : _epoch(&epoch), _slot(epoch._slotIndex()) {
+    auto& pins = epoch._slots[_slot].pins;
+    // A pin must count in an epoch which was still current after the pin was added, otherwise
+    // a flip which happened in between could miss it.
+    for (;;) {
+        _pinnedEpoch = epoch._epoch.load();
+        pins[_pinnedEpoch & 1].fetch_add(1);
+        if (epoch._epoch.load() == _pinnedEpoch) {
+            break;
+        }
+        pins[_pinnedEpoch & 1].fetch_sub(1);
+    }
+}
+
+CatalogEpoch::Pin::~Pin() {
+    auto& pins = _epoch->_slots[_slot].pins[_pinnedEpoch & 1];
+    if (pins.fetch_sub(1) == 1 && _epoch->_gracePeriodPending.load()) {
+        _epoch->reclaim();
+    }
+}
+
+void CatalogEpoch::retire(stdx::function<void()> deleter) {
+    std::vector<stdx::function<void()>> toFree;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _retired.emplace_back(_epoch.load(), std::move(deleter));
+        _collect_inlock(&toFree);
+    }
+    for (auto& free : toFree) {
+        free();
+    }
+}
+
+void CatalogEpoch::reclaim() {
+    std::vector<stdx::function<void()>> toFree;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _collect_inlock(&toFree);
+    }
+    for (auto& free : toFree) {
+        free();
+    }
+}
+
+size_t CatalogEpoch::retiredCount() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _retired.size();
+}
+
+void CatalogEpoch::_collect_inlock(std::vector<stdx::function<void()>>* toFree) {
+    for (;;) {
+        if (_gracePeriodPending.load()) {
+            // The epoch only moves on once the previous one has no pins left, so only the one
+            // before the current can still have some.
+            const uint64_t previous = _epoch.load() - 1;
+            for (size_t i = 0; i < _slotCount; ++i) {
+                if (_slots[i].pins[previous & 1].load() != 0) {
+                    return;
+                }
+            }
+            _gracePeriodPending.store(false);
+
+            while (!_retired.empty() && _retired.front().first <= previous) {
+                toFree->push_back(std::move(_retired.front().second));
+                _retired.pop_front();
+            }
+        }
+
+        if (_retired.empty()) {
+            return;
+        }
+
+        // Whatever is left was retired in the current epoch. New pins count in the next one from
+        // now on.
+        _epoch.fetch_add(1);
+        _gracePeriodPending.store(true);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Epoch based reclamation for the catalog shared by every coroutine thread group.
+ *
+ * Readers look shared catalog objects up without taking locks, so an object a writer unlinks may
+ * still be in use. Writers retire such objects instead of freeing them. An object retired in epoch
+ * E is freed once the epoch has moved past E and every reader pinned in E has unpinned.
+ *
+ * Readers pin for one catalog access at a time: CatalogSnapshot::get() for as long as its result
+ * is used, and the catalog RAII types, such as AutoGetDb, for as long as the handles they return
+ * may be used. A long operation therefore holds back reclamation only while it is inside such a
+ * scope. Pins are counted per thread group, so pinning touches no cache line written by other
+ * thread groups.
+ */
+class CatalogEpoch {
+    CatalogEpoch(const CatalogEpoch&) = delete;
+    CatalogEpoch& operator=(const CatalogEpoch&) = delete;
+
+public:
+    explicit CatalogEpoch(size_t slots);
+
+    /**
+     * The instance shared by the whole process, with a slot per thread group and one more for
+     * every other thread.
+     */
+    static CatalogEpoch& get();
+
+    class Pin {
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+    public:
+        Pin() : Pin(CatalogEpoch::get()) {}
+        explicit Pin(CatalogEpoch& epoch);
+        ~Pin();
+
+    private:
+        CatalogEpoch* const _epoch;
+        const size_t _slot;
+        uint64_t _pinnedEpoch;
+    };
+
+    uint64_t current() const {
+        return _epoch.load();
+    }
+
+    /**
+     * Runs 'deleter' once no reader which might have found the retired object is pinned anymore.
+     * The object must already be unreachable for readers which pin from now on.
+     */
+    void retire(stdx::function<void()> deleter);
+
+    /**
+     * Frees the retired objects whose readers have all unpinned. retire() and the last unpin of
+     * an epoch call it, so other callers rarely need to.
+     */
+    void reclaim();
+
+    size_t retiredCount() const;
+
+private:
+    struct alignas(64) Slot {
+        // Pins taken in even and odd epochs.
+        std::atomic<int64_t> pins[2]{};
+    };
+
+    size_t _slotIndex() const;
+
+    void _collect_inlock(std::vector<stdx::function<void()>>* toFree);
+
+    const size_t _slotCount;
+    std::unique_ptr<Slot[]> _slots;
+
+    std::atomic<uint64_t> _epoch{0};
+    // Set while the pins of the epoch before the current one are being waited for. Lets unpinning
+    // skip the mutex otherwise.
+    std::atomic<bool> _gracePeriodPending{false};
+
+    mutable stdx::mutex _mutex;
+    // Ordered by the epoch they were retired in.
+    std::deque<std::pair<uint64_t, stdx::function<void()>>> _retired;
+};
+
+/**
+ * A value readers get without locks. Writers change a copy and publish it, and the copy it
+ * replaced is retired through CatalogEpoch. Writers are serialized.
+ */
+template <typename T>
+class CatalogSnapshot {
+    CatalogSnapshot(const CatalogSnapshot&) = delete;
+    CatalogSnapshot& operator=(const CatalogSnapshot&) = delete;
+
+public:
+    /**
+     * The value as of one read. It stays valid, and keeps the epoch pinned, for as long as this
+     * object lives.
+     */
+    class Reader {
+    public:
+        const T& operator*() const {
+            return *_value;
+        }
+
+        const T* operator->() const {
+            return _value;
+        }
+
+    private:
+        friend class CatalogSnapshot;
+
+        explicit Reader(const CatalogSnapshot& snapshot)
+            : _value(snapshot._current.load(std::memory_order_acquire)) {}
+
+        // Taken before the value is read.
+        const CatalogEpoch::Pin _pin;
+        const T* const _value;
+    };
+
+    CatalogSnapshot() : _current(new T()) {}
+
+    ~CatalogSnapshot() {
+        delete _current.load();
+    }
+
+    Reader get() const {
+        return Reader(*this);
+    }
+
+    /**
+     * Number of values published so far.
+     */
+    uint64_t version() const {
+        return _version.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Calls 'change' on a copy of the value, which is published if 'change' returns true and
+     * dropped otherwise. Returns what 'change' returned.
+     */
+    template <typename Change>
+    bool update(Change&& change) {
+        stdx::lock_guard<stdx::mutex> lk(_writeMutex);
+        const T* old = _current.load(std::memory_order_relaxed);
+        auto next = std::make_unique<T>(*old);
+        if (!change(*next)) {
+            return false;
+        }
+        _current.store(next.release(), std::memory_order_release);
+        _version.fetch_add(1, std::memory_order_release);
+        CatalogEpoch::get().retire([old] { delete old; });
+        return true;
+    }
+
+    /**
+     * Replaces the value with an empty one and frees the old one right away. Only for when no
+     * reader can be left, such as during clean shutdown.
+     */
+    void resetUnsafe() {
+        stdx::lock_guard<stdx::mutex> lk(_writeMutex);
+        delete _current.exchange(new T());
+        _version.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    stdx::mutex _writeMutex;
+    std::atomic<const T*> _current;
+    std::atomic<uint64_t> _version{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,97 @@
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/db/catalog/catalog_epoch.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(CatalogEpochTest, RetireWithoutPinsFreesImmediately) {
+    CatalogEpoch epoch(4);
+    bool freed = false;
+    epoch.retire([&freed] { freed = true; });
+    ASSERT_TRUE(freed);
+    ASSERT_EQ(epoch.retiredCount(), 0U);
+}
+
+TEST(CatalogEpochTest, RetireWaitsForEarlierPins) {
+    CatalogEpoch epoch(4);
+    bool freed = false;
+    {
+        CatalogEpoch::Pin pin(epoch);
+        epoch.retire([&freed] { freed = true; });
+        ASSERT_FALSE(freed);
+        ASSERT_EQ(epoch.retiredCount(), 1U);
+    }
+    ASSERT_TRUE(freed);
+    ASSERT_EQ(epoch.retiredCount(), 0U);
+}
+
+TEST(CatalogEpochTest, LaterPinsDoNotDelayReclamation) {
+    CatalogEpoch epoch(4);
+    bool freed = false;
+    auto earlier = std::make_unique<CatalogEpoch::Pin>(epoch);
+    epoch.retire([&freed] { freed = true; });
+
+    CatalogEpoch::Pin later(epoch);
+    earlier.reset();
+    ASSERT_TRUE(freed);
+}
+
+TEST(CatalogEpochTest, ObjectsRetiredDuringGracePeriodWaitForTheirOwnReaders) {
+    CatalogEpoch epoch(4);
+    bool firstFreed = false;
+    bool secondFreed = false;
+
+    auto first = std::make_unique<CatalogEpoch::Pin>(epoch);
+    epoch.retire([&firstFreed] { firstFreed = true; });
+
+    auto second = std::make_unique<CatalogEpoch::Pin>(epoch);
+    epoch.retire([&secondFreed] { secondFreed = true; });
+
+    first.reset();
+    ASSERT_TRUE(firstFreed);
+    ASSERT_FALSE(secondFreed);
+
+    second.reset();
+    ASSERT_TRUE(secondFreed);
+}
+
+TEST(CatalogSnapshotTest, UpdatePublishesCopy) {
+    CatalogSnapshot<std::map<int, int>> snapshot;
+
+    auto before = snapshot.get();
+    ASSERT_TRUE(snapshot.update([](std::map<int, int>& value) {
+        value.emplace(1, 1);
+        return true;
+    }));
+
+    // The reader keeps seeing the value it got.
+    ASSERT_TRUE(before->empty());
+    ASSERT_EQ(snapshot.get()->size(), 1U);
+    ASSERT_EQ(snapshot.version(), 1U);
+
+    ASSERT_FALSE(snapshot.update([](std::map<int, int>& value) { return false; }));
+    ASSERT_EQ(snapshot.version(), 1U);
+}
+
+// A reader pins the value it got for as long as it lives, and no longer.
+TEST(CatalogSnapshotTest, ReaderPinsItsValue) {
+    CatalogSnapshot<std::map<int, int>> snapshot;
+    auto& epoch = CatalogEpoch::get();
+    {
+        auto before = snapshot.get();
+        ASSERT_TRUE(snapshot.update([](std::map<int, int>& value) {
+            value.emplace(1, 1);
+            return true;
+        }));
+        ASSERT_EQ(epoch.retiredCount(), 1U);
+        ASSERT_TRUE(before->empty());
+    }
+    ASSERT_EQ(epoch.retiredCount(), 0U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,193 @@
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/db/catalog/catalog_warmup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace mongo::catalog {
+namespace {
+// Load the catalog of every collection at startup, before connections are accepted.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(catalogWarmUp, bool, false);
+
+// Threads fetching collection metadata in parallel during the catalog warm-up.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(catalogWarmUpThreads, int, 8);
+
+// Seconds between two progress messages of the catalog warm-up.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(catalogWarmUpProgressIntervalSecs, int, 10);
+
+struct DatabaseNamespaces {
+    std::string name;
+    std::vector<NamespaceString> collections;
+};
+
+Milliseconds elapsed(const Timer& timer) {
+    return Milliseconds(timer.millis());
+}
+
+/**
+ * Builds the Database and Collection handles of the current thread group and returns the number
+ * of collections whose handle was built.
+ */
+size_t buildHandles(OperationContext* opCtx, const std::vector<DatabaseNamespaces>& databases) {
+    auto& dbHolder = DatabaseHolder::getDatabaseHolder();
+    size_t handles = 0;
+    for (const auto& database : databases) {
+        try {
+            Lock::DBLock dbLock(opCtx, database.name, MODE_X);
+            Database* db = dbHolder.openDb(opCtx, database.name);
+            for (const auto& nss : database.collections) {
+                if (db->getCollection(opCtx, nss)) {
+                    ++handles;
+                }
+            }
+        } catch (const DBException& ex) {
+            warning() << "Catalog warm-up could not open database " << database.name
+                      << causedBy(ex);
+        }
+    }
+    return handles;
+}
+}  // namespace
+
+CatalogWarmUpStats warmUpCatalog(OperationContext* opCtx,
+                                 const ThreadGroupRunner& runOnEachThreadGroup) {
+    CatalogWarmUpStats stats;
+    if (!catalogWarmUp) {
+        return stats;
+    }
+
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+
+    Timer timer;
+    std::vector<std::string> dbNames;
+    storageEngine->listDatabases(&dbNames);
+    std::vector<DatabaseNamespaces> databases;
+    std::vector<const NamespaceString*> namespaces;
+    databases.reserve(dbNames.size());
+    for (auto& dbName : dbNames) {
+        std::vector<std::string> collectionNames;
+        storageEngine->listCollections(dbName, &collectionNames);
+        auto& database = databases.emplace_back();
+        database.name = std::move(dbName);
+        database.collections.reserve(collectionNames.size());
+        for (auto& collectionName : collectionNames) {
+            database.collections.emplace_back(std::move(collectionName));
+        }
+    }
+    for (const auto& database : databases) {
+        for (const auto& nss : database.collections) {
+            namespaces.push_back(&nss);
+        }
+    }
+    stats.databases = databases.size();
+    stats.collections = namespaces.size();
+    stats.listTime = elapsed(timer);
+    log() << "Catalog warm-up: listed " << stats.collections << " collections in "
+          << stats.databases << " databases in " << stats.listTime;
+
+    // Fetch the metadata and build the shared catalog entries in parallel. They are shared by
+    // every thread group, so any thread can build them.
+    timer.reset();
+    const size_t threadCount = std::min<size_t>(std::max(catalogWarmUpThreads.load(), 1),
+                                                std::max<size_t>(stats.collections, 1));
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> fetched{0};
+    std::atomic<size_t> failed{0};
+    stdx::mutex mutex;
+    stdx::condition_variable finishedCV;
+    size_t finishedThreads = 0;
+
+    std::vector<stdx::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t id = 0; id < threadCount; ++id) {
+        threads.emplace_back([&, id] {
+            const std::string threadName = str::stream() << "catalogWarmUp-" << id;
+            Client::initThread(threadName);
+            auto fetchOpCtx = cc().makeOperationContext();
+            for (size_t i = next.fetch_add(1); i < namespaces.size(); i = next.fetch_add(1)) {
+                const NamespaceString& nss = *namespaces[i];
+                try {
+                    auto dbEntry =
+                        storageEngine->getDatabaseCatalogEntry(fetchOpCtx.get(), nss.db());
+                    if (!dbEntry->getCollectionCatalogEntry(fetchOpCtx.get(), nss.ns())) {
+                        failed.fetch_add(1);
+                    }
+                } catch (const DBException& ex) {
+                    warning() << "Catalog warm-up could not load " << nss << causedBy(ex);
+                    failed.fetch_add(1);
+                }
+                fetched.fetch_add(1);
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            ++finishedThreads;
+            finishedCV.notify_one();
+        });
+    }
+
+    {
+        const auto interval =
+            Seconds(std::max(catalogWarmUpProgressIntervalSecs.load(), 1)).toSystemDuration();
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        auto finished = [&] { return finishedThreads == threadCount; };
+        while (!finishedCV.wait_for(lk, interval, finished)) {
+            log() << "Catalog warm-up: fetched " << fetched.load() << " of " << stats.collections
+                  << " collections in " << elapsed(timer);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stats.failed = failed.load();
+    stats.fetchTime = elapsed(timer);
+    log() << "Catalog warm-up: fetched " << stats.collections << " collections with "
+          << threadCount << " threads in " << stats.fetchTime << ", " << stats.failed
+          << " failed";
+
+    // Build the handles of every thread group on top of the shared entries. Each group builds its
+    // own on its thread, since handles are looked up by the thread group running the request.
+    timer.reset();
+    std::atomic<size_t> threadGroups{0};
+    std::atomic<size_t> handles{0};
+    auto buildThreadGroupHandles = [&] {
+        auto client = opCtx->getServiceContext()->makeClient("catalogWarmUp-threadGroup");
+        AlternativeClientRegion acr(client);
+        auto groupOpCtx = cc().makeOperationContext();
+        handles.fetch_add(buildHandles(groupOpCtx.get(), databases));
+        threadGroups.fetch_add(1);
+    };
+    if (!runOnEachThreadGroup || !runOnEachThreadGroup(buildThreadGroupHandles)) {
+        handles.fetch_add(buildHandles(opCtx, databases));
+        threadGroups.fetch_add(1);
+    }
+    stats.threadGroups = threadGroups.load();
+    stats.handles = handles.load();
+    stats.handleTime = elapsed(timer);
+    log() << "Catalog warm-up: built " << stats.handles << " collection handles on "
+          << stats.threadGroups << " thread groups in " << stats.handleTime;
+
+    return stats;
+}
+
+}  // namespace mongo::catalog
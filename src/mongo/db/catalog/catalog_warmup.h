@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+class OperationContext;
+
+namespace catalog {
+
+struct CatalogWarmUpStats {
+    size_t databases = 0;
+    size_t collections = 0;
+    // Collections whose catalog entry could not be built.
+    size_t failed = 0;
+    // Thread groups whose Database and Collection handles were built. The calling thread counts
+    // as the only one when the server runs no thread groups.
+    size_t threadGroups = 0;
+    // Collection handles built, summed over the thread groups.
+    size_t handles = 0;
+    Milliseconds listTime{0};
+    Milliseconds fetchTime{0};
+    Milliseconds handleTime{0};
+};
+
+/**
+ * Runs the given function once on every thread group of the server and returns once every run
+ * has finished. Returns false, without running it, if the server has no thread groups.
+ */
+using ThreadGroupRunner = stdx::function<bool(const stdx::function<void()>&)>;
+
+/**
+ * Loads the catalog of every collection the storage engine lists before the node accepts traffic,
+ * so that the first requests after a restart do not pay for the metadata fetches.
+ *
+ * The catalog entries and record stores shared by all thread groups are built by
+ * catalogWarmUpThreads threads in parallel. Database, Collection and IndexCatalog handles are
+ * never shared, so each thread group then builds its own on top of the shared entries, through
+ * runOnEachThreadGroup. Without thread groups, the handles of the calling thread are built.
+ *
+ * Does nothing unless the catalogWarmUp server parameter is set. Progress is logged every
+ * catalogWarmUpProgressIntervalSecs seconds.
+ */
+CatalogWarmUpStats warmUpCatalog(OperationContext* opCtx,
+                                 const ThreadGroupRunner& runOnEachThreadGroup);
+
+}  // namespace catalog
+}  // namespace mongo
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
 
 #include "mongo/base/status.h"
@@ -105,6 +106,13 @@ public:
         MONGO_UNREACHABLE;
         return nullptr;
     };
+    // Like getCollectionCatalogEntry(), but the entry stays alive while the returned pointer is
+    // held, even if another thread group drops the collection meanwhile. Catalogs which are not
+    // shared between thread groups return an unowned pointer.
+    virtual std::shared_ptr<CollectionCatalogEntry> pinCollectionCatalogEntry(
+        OperationContext* opCtx, StringData ns) {
+        return {std::shared_ptr<void>(), getCollectionCatalogEntry(opCtx, ns)};
+    };
 
     // The DatabaseCatalogEntry owns this, do not delete
     virtual RecordStore* getRecordStore(StringData ns) const = 0;
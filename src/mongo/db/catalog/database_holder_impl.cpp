@@ -95,15 +95,68 @@ StringData _todb(StringData ns) {
 
 }  // namespace
 
+DatabaseHolderImpl::ThreadGroupDatabases& DatabaseHolderImpl::_threadGroupDatabases() {
+    auto id = static_cast<int16_t>(localThreadId + 1);
+    return _dbMapVector[id];
+}
+
+bool DatabaseHolderImpl::_isClosedElsewhere(StringData dbName, const OpenDatabase& openDb) const {
+    // Read before _closedAllAt, which is raised before the entries it covers are dropped.
+    auto closedAt = _closedAt.get();
+    if (openDb.openedAt < _closedAllAt.load()) {
+        return true;
+    }
+    auto iter = closedAt->find(dbName);
+    return iter != closedAt->end() && openDb.openedAt < iter->second;
+}
+
+void DatabaseHolderImpl::_closedAllAtGeneration(unsigned long long generation) {
+    _closedAllAt.store(generation);
+    _closedAt.update([](StringMap<unsigned long long>& closed) {
+        if (closed.empty()) {
+            return false;
+        }
+        closed.clear();
+        return true;
+    });
+}
+
+Database* DatabaseHolderImpl::_getOpenHandle(OperationContext* opCtx,
+                                             ThreadGroupDatabases& threadGroup,
+                                             StringData dbName) {
+    auto iter = threadGroup.dbs.find(dbName);
+    if (iter == threadGroup.dbs.end()) {
+        return nullptr;
+    }
+    if (_isClosedElsewhere(dbName, iter->second)) {
+        MONGO_LOG(1) << "Database " << dbName << " was closed by another thread group";
+        auto db = std::move(iter->second.db);
+        threadGroup.dbs.erase(iter);
+        _retireStaleHandle(opCtx, std::move(db));
+        return nullptr;
+    }
+    return iter->second.db.get();
+}
+
+void DatabaseHolderImpl::_retireStaleHandle(OperationContext* opCtx,
+                                            std::unique_ptr<Database> db) {
+    // Kills the cursors of this thread group on the database.
+    repl::oplogCheckCloseDatabase(opCtx, db.get());
+    db->close(opCtx, "database closed by another thread group");
+    _retire(std::move(db));
+}
+
+void DatabaseHolderImpl::_retire(std::unique_ptr<Database> db) {
+    // Other coroutines of the thread group may still hold the handle while they are pinned.
+    CatalogEpoch::get().retire([db = db.release()] { delete db; });
+}
+
 Database* DatabaseHolderImpl::get(OperationContext* opCtx, StringData ns) {
     const StringData db = _todb(ns);
     invariant(opCtx->lockState()->isDbLockedForMode(db, MODE_IS));
 
-    auto id = static_cast<int16_t>(localThreadId + 1);
-    // std::scoped_lock<std::mutex> lock{_dbMapMutexVector[id]};
-    const auto& dbMap = _dbMapVector[id];
-    if (auto iter = dbMap.find(db); iter != dbMap.end()) {
-        return iter->second.get();
+    if (auto openDb = _getOpenHandle(opCtx, _threadGroupDatabases(), db)) {
+        return openDb;
     }
 
     // https://www.mongodb.com/docs/manual/core/databases-and-collections/#create-a-database
@@ -126,9 +179,10 @@ std::set<std::string> DatabaseHolderImpl::_getNamesWithConflictingCasing_inlock(
     std::set<std::string> duplicates;
     auto id = static_cast<int16_t>(localThreadId + 1);
 
-    for (const auto& [dbName, dbPtr] : _dbMapVector[id]) {
+    for (const auto& [dbName, openDb] : _dbMapVector[id].dbs) {
         // A name that's equal with case-insensitive match must be identical, or it's a duplicate.
-        if (name.equalCaseInsensitive(dbName) && name != dbName) {
+        if (name.equalCaseInsensitive(dbName) && name != dbName &&
+            !_isClosedElsewhere(dbName, openDb)) {
             duplicates.insert(dbName);
         }
     }
@@ -149,16 +203,15 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
         *justCreated = false;  // Until proven otherwise.
     }
 
-    auto id = static_cast<int16_t>(localThreadId + 1);
-    auto& dbMap = _dbMapVector[id];
+    auto& threadGroup = _threadGroupDatabases();
 
     // std::scoped_lock<std::mutex> lock(_dbMapMutexVector[id]);
     // The following will insert a nullptr for dbname, which will treated the same as a non-
     // existant database by the get method, yet still counts in getNamesWithConflictingCasing.
-    if (auto iter = dbMap.find(dbName); iter != dbMap.end()) {
+    if (auto openDb = _getOpenHandle(opCtx, threadGroup, dbName)) {
         MONGO_LOG(1) << "DatabaseHolderImpl::openDb"
                      << ". ns: " << ns << " exists";
-        return iter->second.get();
+        return openDb;
     }
 
     // Check casing in lock to avoid transient duplicates.
@@ -185,6 +238,8 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
     MONGO_LOG(1) << "DatabaseHolderImpl::openDb"
                  << ". ns: " << ns << " create start";
 
+    // Read before the catalog entry, so that a close racing with the open makes the handle stale.
+    const auto openedAt = _generation.load();
     StorageEngine* storageEngine = getGlobalServiceContext()->getStorageEngine();
     DatabaseCatalogEntry* entry = storageEngine->getDatabaseCatalogEntry(opCtx, dbName);
 
@@ -195,10 +250,11 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
     // yield here
     auto newDb = std::make_unique<Database>(opCtx, dbName, entry);
 
-    auto [iter, success] = dbMap.try_emplace(dbName.toString(), std::move(newDb));
+    auto [iter, success] =
+        threadGroup.dbs.try_emplace(dbName.toString(), OpenDatabase{std::move(newDb), openedAt});
     if (!success) {
         MONGO_LOG(1) << "Another coroutine created Database handler on this thread";
-        return iter->second.get();
+        return iter->second.db.get();
     }
 
     if (justCreated) {
@@ -206,7 +262,7 @@ Database* DatabaseHolderImpl::openDb(OperationContext* opCtx, StringData ns, boo
     }
     MONGO_LOG(1) << "DatabaseHolderImpl::openDb"
                  << ". ns: " << ns << " done.";
-    return iter->second.get();
+    return iter->second.db.get();
 }
 
 namespace {
@@ -223,23 +279,32 @@ void DatabaseHolderImpl::close(OperationContext* opCtx, StringData ns, const std
 
     const StringData dbName = _todb(ns);
 
-    auto id = static_cast<int16_t>(localThreadId + 1);
+    auto& threadGroup = _threadGroupDatabases();
     {
         // std::scoped_lock<std::mutex> lock{_dbMapMutexVector[id]};
-        auto& dbMap = _dbMapVector[id];
-
-        auto it = dbMap.find(dbName);
-        if (it != dbMap.end()) {
-            auto db = it->second.get();
+        if (auto db = _getOpenHandle(opCtx, threadGroup, dbName)) {
             repl::oplogCheckCloseDatabase(opCtx, db);
             evictDatabaseFromUUIDCatalog(opCtx, db);
 
             // only close once
             db->close(opCtx, reason);
-            dbMap.erase(it);
+            auto iter = threadGroup.dbs.find(dbName);
+            _retire(std::move(iter->second.db));
+            threadGroup.dbs.erase(iter);
         }
     }
 
+    // The other thread groups find out the next time they look the database up.
+    const auto closedAt = _generation.addAndFetch(1);
+    if (_closedAt.get()->size() >= kMaxClosedDatabases) {
+        _closedAllAtGeneration(closedAt);
+    } else {
+        _closedAt.update([&](StringMap<unsigned long long>& closed) {
+            closed[dbName] = closedAt;
+            return true;
+        });
+    }
+
     getGlobalServiceContext()
         ->getStorageEngine()
         ->closeDatabase(opCtx, dbName)
@@ -249,22 +314,28 @@ void DatabaseHolderImpl::close(OperationContext* opCtx, StringData ns, const std
 void DatabaseHolderImpl::closeAll(OperationContext* opCtx, const std::string& reason) {
     invariant(opCtx->lockState()->isW());
 
-    auto id = static_cast<int16_t>(localThreadId + 1);
+    auto& threadGroup = _threadGroupDatabases();
 
-    auto& dbMap = _dbMapVector[id];
     // std::scoped_lock<std::mutex> lock{_dbMapMutexVector[i]};
-    for (auto& [dbName, dbPtr] : dbMap) {
+    for (auto& [dbName, openDb] : threadGroup.dbs) {
         BackgroundOperation::assertNoBgOpInProgForDb(dbName);
         LOG(0) << "DatabaseHolder::closeAll name:" << dbName;
-        repl::oplogCheckCloseDatabase(opCtx, dbPtr.get());
-        evictDatabaseFromUUIDCatalog(opCtx, dbPtr.get());
-        dbPtr->close(opCtx, reason);
+        auto db = openDb.db.get();
+        repl::oplogCheckCloseDatabase(opCtx, db);
+        if (!_isClosedElsewhere(dbName, openDb)) {
+            evictDatabaseFromUUIDCatalog(opCtx, db);
+        }
+        db->close(opCtx, reason);
+        _retire(std::move(openDb.db));
 
         getGlobalServiceContext()
             ->getStorageEngine()
             ->closeDatabase(opCtx, dbName)
             .transitional_ignore();
     }
-    dbMap.clear();
+    threadGroup.dbs.clear();
+
+    // Handles the other thread groups opened so far are stale from now on.
+    _closedAllAtGeneration(_generation.addAndFetch(1));
 }
 }  // namespace mongo
@@ -33,8 +33,10 @@
 #include <vector>
 
 #include "mongo/base/string_data.h"
+#include "mongo/db/catalog/catalog_epoch.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/string_map.h"
 
 namespace mongo {
@@ -84,12 +86,63 @@ public:
     std::set<std::string> getNamesWithConflictingCasing(StringData name) override;
 
 private:
+    struct OpenDatabase {
+        std::unique_ptr<Database> db;
+        // Value of _generation when the handle was opened.
+        unsigned long long openedAt;
+    };
+
+    using DBMap = std::map<std::string, OpenDatabase, std::less<void>>;
+
+    struct ThreadGroupDatabases {
+        DBMap dbs;
+    };
+
     std::set<std::string> _getNamesWithConflictingCasing_inlock(StringData name) const;
-    using DBMap = std::map<std::string, std::unique_ptr<Database>, std::less<void>>;
 
-    // mutable std::vector<std::mutex> _dbMapMutexVector{serverGlobalParams.reservedThreadNum + 1};
-    std::vector<DBMap> _dbMapVector{
+    /**
+     * Whether another thread group closed the database after 'openDb' was opened.
+     */
+    bool _isClosedElsewhere(StringData dbName, const OpenDatabase& openDb) const;
+
+    /**
+     * Makes every handle opened before 'generation' stale, and drops the closed databases this
+     * covers.
+     */
+    void _closedAllAtGeneration(unsigned long long generation);
+
+    /**
+     * Retires the handle of 'dbName' if another thread group closed the database. Returns the
+     * handle if it is still valid.
+     */
+    Database* _getOpenHandle(OperationContext* opCtx,
+                             ThreadGroupDatabases& threadGroup,
+                             StringData dbName);
+
+    /**
+     * Closes and retires the handle of a database another thread group closed.
+     */
+    void _retireStaleHandle(OperationContext* opCtx, std::unique_ptr<Database> db);
+
+    /**
+     * Frees a closed handle once no reader which might still use it is pinned.
+     */
+    static void _retire(std::unique_ptr<Database> db);
+
+    ThreadGroupDatabases& _threadGroupDatabases();
+
+    // Database handles, and the Collection handles they own, keep per thread group state and are
+    // never shared. The catalog entries behind them are shared through the storage engine.
+    std::vector<ThreadGroupDatabases> _dbMapVector{
         serverGlobalParams.reservedThreadNum +
         1};  // the first is used for other threads while the rest is used for thread group
+
+    // Closing a database must reach the handles of every thread group. A handle is stale once the
+    // database it refers to was closed after it was opened. Past this many closed databases, the
+    // handles of all of them are made stale at once instead.
+    static constexpr size_t kMaxClosedDatabases = 1024;
+    AtomicWord<unsigned long long> _generation{0};
+    AtomicWord<unsigned long long> _closedAllAt{0};
+    CatalogSnapshot<StringMap<unsigned long long>> _closedAt;
 };
 }  // namespace mongo
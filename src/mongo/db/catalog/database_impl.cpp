@@ -160,6 +160,7 @@ void uassertNamespaceNotIndex(StringData ns, StringData caller) {
 
 DatabaseImpl::~DatabaseImpl() {
     _collections.clear();
+    _collectionsView.clear();
     // for (CollectionMap::const_iterator i = _collections.begin(); i != _collections.end(); ++i)
     //     delete i->second;
 }
@@ -173,6 +174,17 @@ void DatabaseImpl::close(OperationContext* opCtx, const std::string& reason) {
     for (const auto& [name, coll] : _collections) {
         // auto coll = pair.second;
         coll->getCursorManager()->invalidateAll(opCtx, true, reason);
+        _deregisterUUID(opCtx, coll.get());
+    }
+}
+
+void DatabaseImpl::_deregisterUUID(OperationContext* opCtx, Collection* coll) {
+    // Collections are registered by whichever thread group built a handle first, so the handle
+    // going away may not be the registered one.
+    auto uuid = coll->uuid();
+    auto& uuidCatalog = UUIDCatalog::get(opCtx);
+    if (uuid && uuidCatalog.lookupCollectionByUUID(uuid.get()) == coll) {
+        uuidCatalog.removeUUIDCatalogEntry(uuid.get());
     }
 }
 
@@ -261,11 +273,12 @@ Collection* DatabaseImpl::_createCollectionHandler(OperationContext* opCtx,
             return iter->second.get();
         }
     }
-    auto cce = _dbEntry->getCollectionCatalogEntry(opCtx, nss.toStringData());
-    if (!cce) {
+    auto pinnedCce = _dbEntry->pinCollectionCatalogEntry(opCtx, nss.toStringData());
+    if (!pinnedCce) {
         // The collection not exists in the Monograph
         return nullptr;
     }
+    auto cce = pinnedCce.get();
     CollectionCatalogEntry::MetaData metadata = cce->getMetaData(opCtx);
     auto uuid = metadata.options.uuid;
     auto rs = cce->getRecordStore();
@@ -273,6 +286,7 @@ Collection* DatabaseImpl::_createCollectionHandler(OperationContext* opCtx,
         std::make_unique<Collection>(opCtx, nss.toStringData(), uuid, cce, rs, _dbEntry);
 
     if (forView) {
+        _collectionsViewEntries.push_back(std::move(pinnedCce));
         _collectionsView.try_emplace(nss.toString(), std::move(collection));
         return nullptr;
     }
@@ -339,6 +353,7 @@ Collection* DatabaseImpl::_createCollectionHandler(OperationContext* opCtx,
         // createSystemIndexes(opCtx, collection.get());
     }
 
+    _collectionEntries[nss.ns()] = std::move(pinnedCce);
     auto [iter, _] = _collections.try_emplace(nss.toString(), std::move(collection));
 
 
@@ -775,7 +790,9 @@ void DatabaseImpl::_clearCollectionCache(OperationContext* opCtx,
     // opCtx->recoveryUnit()->registerChange(new RemoveCollectionChange(this, it->second));
 
     it->second->getCursorManager()->invalidateAll(opCtx, collectionGoingAway, reason);
+    _deregisterUUID(opCtx, it->second.get());
     _collections.erase(it);
+    _collectionEntries.erase(fullns);
 }
 
 Collection* DatabaseImpl::getCollection(OperationContext* opCtx, StringData ns) {
@@ -799,6 +816,16 @@ Collection* DatabaseImpl::getCollection(OperationContext* opCtx, const Namespace
 
     if (auto it = _collections.find(nss.ns()); it != _collections.end() && it->second) {
         auto found = it->second.get();
+        if (found->getCatalogEntry() !=
+            _dbEntry->getCollectionCatalogEntry(opCtx, nss.toStringData())) {
+            // Another thread group dropped or recreated the collection since this handle was
+            // built.
+            _clearCollectionCache(opCtx,
+                                  nss.toStringData(),
+                                  "collection changed by another thread group",
+                                  /*collectionGoingAway*/ true);
+            return _createCollectionHandler(opCtx, nss, false);
+        }
         NamespaceUUIDCache& cache = NamespaceUUIDCache::get(opCtx);
         if (auto uuid = found->uuid()) {
             cache.ensureNamespaceInCache(nss, uuid.get());
@@ -1498,6 +1525,7 @@ DatabaseImpl::CollectionMapView& DatabaseImpl::collections(OperationContext* opC
     _dbEntry->getCollectionNamespaces(collectionInStorageEngine);
 
     _collectionsView.clear();
+    _collectionsViewEntries.clear();
 
     for (auto& collectionName : collectionInStorageEngine) {
         NamespaceString nss{std::move(collectionName)};
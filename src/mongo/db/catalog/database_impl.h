@@ -47,6 +47,7 @@
 namespace mongo {
 
 class Collection;
+class CollectionCatalogEntry;
 class DatabaseCatalogEntry;
 class IndexCatalog;
 class NamespaceDetails;
@@ -290,6 +291,11 @@ private:
                                  const NamespaceString& fullns,
                                  Collection* collection);
 
+    /**
+     * Removes 'coll' from the UUIDCatalog if it is the Collection registered for its UUID.
+     */
+    void _deregisterUUID(OperationContext* opCtx, Collection* coll);
+
     class AddCollectionChange;
     class RemoveCollectionChange;
 
@@ -314,6 +320,13 @@ private:
     // This variable may only be read/written while the database is locked in MODE_X.
     std::unique_ptr<PseudoRandom> _uniqueCollectionNamespacePseudoRandom;
 
+    // The catalog entries are shared by every thread group, while the Collection handles built
+    // on them belong to this one. A handle pins its entry, and is rebuilt once the shared catalog
+    // no longer publishes that entry, as after another thread group dropped the collection.
+    // Declared before the handles so that they are destroyed after them.
+    StringMap<std::shared_ptr<CollectionCatalogEntry>> _collectionEntries;
+    std::vector<std::shared_ptr<CollectionCatalogEntry>> _collectionsViewEntries;
+
     CollectionMap _collections;  // owner
     CollectionMapView _collectionsView;
     // mutable std::mutex _collectionsMutex;
@@ -1362,18 +1362,26 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
     InsertDeleteOptions options;
     prepareInsertDeleteOptions(opCtx, index->descriptor(), &options);
 
-    for (auto bsonRecord : bsonRecords) {
-        int64_t inserted;
-        invariant(bsonRecord.id != RecordId());
+    // The keys of consecutive records sharing a timestamp go to the storage engine in one call.
+    std::vector<BsonRecord> batch;
+    batch.reserve(bsonRecords.size());
+    auto it = bsonRecords.begin();
+    while (it != bsonRecords.end()) {
+        const Timestamp ts = it->ts;
+        batch.clear();
+        for (; it != bsonRecords.end() && it->ts == ts; ++it) {
+            invariant(it->id != RecordId());
+            batch.push_back(*it);
+        }
 
-        if (!bsonRecord.ts.isNull()) {
-            Status status = opCtx->recoveryUnit()->setTimestamp(bsonRecord.ts);
+        if (!ts.isNull()) {
+            Status status = opCtx->recoveryUnit()->setTimestamp(ts);
             if (!status.isOK())
                 return status;
         }
 
-        Status status = index->accessMethod()->insert(
-            opCtx, *bsonRecord.docPtr, bsonRecord.id, options, &inserted);
+        int64_t inserted;
+        Status status = index->accessMethod()->insertRecords(opCtx, batch, options, &inserted);
         if (!status.isOK())
             return status;
 
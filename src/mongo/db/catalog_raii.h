@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/db/catalog/catalog_epoch.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/concurrency/d_concurrency.h"
@@ -66,6 +67,8 @@ public:
     }
 
 private:
+    // Keeps the handles found through this object from being freed while it lives.
+    const CatalogEpoch::Pin _catalogPin;
     const Lock::DBLock _dbLock;
     Database* const _db;
 };
@@ -0,0 +1,99 @@
+/**
+*    Copyright (C) 2018 MongoDB Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/object_pool.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/log.h"
+#include "mongo/util/shared_buffer_pool.h"
+
+namespace mongo {
+namespace {
+
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedObjectPoolThreadCacheBytes =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+        ServerParameterSet::getGlobal(),
+        "objectPoolThreadCacheBytes",
+        &objectPoolThreadCacheBytes));
+
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedObjectPoolSharedCacheBytes =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+        ServerParameterSet::getGlobal(),
+        "objectPoolSharedCacheBytes",
+        &objectPoolSharedCacheBytes));
+
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedSharedBufferPoolThreadCacheBytes =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+        ServerParameterSet::getGlobal(),
+        "sharedBufferPoolThreadCacheBytes",
+        &sharedBufferPoolThreadCacheBytes));
+
+class ObjectPools : public ServerStatusSection {
+public:
+    ObjectPools() : ServerStatusSection("objectPools") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder bob;
+        ObjectPoolRegistry::get().appendStats(&bob);
+        {
+            BSONObjBuilder sharedBuffers(bob.subobjStart("sharedBuffers"));
+            SharedBufferPool::appendStats(&sharedBuffers);
+        }
+        return bob.obj();
+    }
+} objectPools;
+
+/**
+ * Returns objects which stayed cached since the previous run back to the allocator, so memory
+ * taken by a burst of connections or operations recedes once the burst is over. This includes
+ * the caches of threads which stay idle.
+ */
+class ObjectPoolTrimmer : public PeriodicTask {
+public:
+    std::string taskName() const override {
+        return "ObjectPoolTrimmer";
+    }
+
+    void taskDoWork() override {
+        LOG(2) << "trimming object pools";
+        ObjectPoolRegistry::get().trim();
+    }
+} objectPoolTrimmer;
+
+}  // namespace
+}  // namespace mongo
@@ -85,6 +85,9 @@ public:
         auto executor = opCtx->getServiceContext()->getServiceExecutor();
         if (executor)
             executor->appendStats(&b);
+        auto serviceEntryPoint = opCtx->getServiceContext()->getServiceEntryPoint();
+        if (serviceEntryPoint)
+            serviceEntryPoint->appendStats(&b);
 
         return b.obj();
     }
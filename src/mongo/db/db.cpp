@@ -50,6 +50,7 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/sasl_options.h"
+#include "mongo/db/catalog/catalog_warmup.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/create_collection.h"
 #include "mongo/db/catalog/database.h"
@@ -633,10 +634,6 @@ ExitCode _initAndListen(int listenPort) {
     auto sessionCache = makeLogicalSessionCacheD(kind);
     LogicalSessionCache::set(serviceContext, std::move(sessionCache));
 
-    // MessageServer::run will return when exit code closes its socket and we don't need the
-    // operation context anymore
-    startupOpCtx.reset();
-
     auto start = serviceContext->getServiceExecutor()->start();
     if (!start.isOK()) {
         error() << "Failed to start the service executor: " << start;
@@ -644,15 +641,28 @@ ExitCode _initAndListen(int listenPort) {
     }
 
     if (!storageGlobalParams.repair) {
-        start = serviceContext->getTransportLayer()->start();
+        start = serviceContext->getServiceEntryPoint()->start();
         if (!start.isOK()) {
-            error() << "Failed to start the listener: " << start.toString();
+            error() << "Failed to start the service entry point: " << start;
             return EXIT_NET_ERROR;
         }
 
-        start = serviceContext->getServiceEntryPoint()->start();
+        // Load the catalog of every thread group before accepting connections, so that the first
+        // requests after a restart do not fetch it from the storage engine.
+        auto sep = serviceContext->getServiceEntryPoint();
+        catalog::warmUpCatalog(startupOpCtx.get(), [sep](const stdx::function<void()>& task) {
+            return sep->runOnEachThreadGroup(task);
+        });
+    }
+
+    // MessageServer::run will return when exit code closes its socket and we don't need the
+    // operation context anymore
+    startupOpCtx.reset();
+
+    if (!storageGlobalParams.repair) {
+        start = serviceContext->getTransportLayer()->start();
         if (!start.isOK()) {
-            error() << "Failed to start the service entry point: " << start;
+            error() << "Failed to start the listener: " << start.toString();
             return EXIT_NET_ERROR;
         }
     }
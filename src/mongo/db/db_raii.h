@@ -201,6 +201,8 @@ private:
 
     OperationContext* const _opCtx;
 
+    // Keeps _db from being freed while this object lives.
+    const CatalogEpoch::Pin _catalogPin;
     Database* _db;
     bool _justCreated;
 };
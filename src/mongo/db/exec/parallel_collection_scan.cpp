@@ -0,0 +1,532 @@
+#include "mongo/db/exec/parallel_collection_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/record_fetcher.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+namespace {
+// Threads reading the key ranges of parallel collection scans, shared by all of them.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(parallelCollectionScanThreads, int, 16);
+
+// A worker hands its documents over once it has this many, or this many bytes of them.
+constexpr size_t kBatchDocuments = 1000;
+constexpr size_t kBatchBytes = 1024 * 1024;
+
+ThreadPool& workerPool() {
+    // Workers may still be running while the process shuts down.
+    static ThreadPool* const pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "ParallelCollectionScan";
+        options.threadNamePrefix = "parallelCollectionScan-";
+        options.minThreads = 0;
+        options.maxThreads =
+            static_cast<size_t>(std::max(parallelCollectionScanThreads.load(), 1));
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName);
+        };
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return *pool;
+}
+
+bool isThreadSafe(const MatchExpression* filter) {
+    return !filter ||
+        (!QueryPlannerCommon::hasNode(filter, MatchExpression::WHERE) &&
+         !QueryPlannerCommon::hasNode(filter, MatchExpression::EXPRESSION));
+}
+
+/**
+ * Passed up with NEED_YIELD while no batch is ready. Once the plan has yielded its locks, it gives
+ * the thread group up to the other operations queued on it, rather than blocking it.
+ */
+class YieldForBatch final : public RecordFetcher {
+public:
+    void setup(OperationContext* opCtx) final {
+        _opCtx = opCtx;
+    }
+
+    void fetch() final {
+        const auto [yield, resume] = _opCtx->getCoroutineFunctors();
+        if (yield && resume) {
+            // Requeue before suspending. Only this thread group runs the resume task.
+            (*resume)();
+            (*yield)();
+        } else {
+            stdx::this_thread::yield();
+        }
+    }
+
+private:
+    OperationContext* _opCtx = nullptr;
+};
+}  // namespace
+
+/**
+ * State shared by the stage and the tasks reading its key ranges on the worker pool.
+ */
+class ParallelCollectionScan::Scan : public std::enable_shared_from_this<Scan> {
+    Scan(const Scan&) = delete;
+    Scan& operator=(const Scan&) = delete;
+
+public:
+    enum class Next { kBatch, kWait, kEOF, kFailed };
+
+    Scan(const RecordStore* recordStore,
+         const std::vector<RecordId>& bounds,
+         const MatchExpression* filter)
+        : _recordStore(recordStore), _filter(filter), _maxReadyBatches(2 * (bounds.size() + 1)) {
+        RecordId start;
+        for (const auto& end : bounds) {
+            _partitions.push_back({start, end, nullptr});
+            start = end;
+        }
+        _partitions.push_back({start, RecordId(), nullptr});
+    }
+
+    size_t partitionCount() const {
+        return _partitions.size();
+    }
+
+    size_t docsTested() const {
+        return _docsTested.load();
+    }
+
+    /**
+     * Schedules the first batch of every key range.
+     */
+    void start() {
+        std::vector<size_t> partitions(_partitions.size());
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            partitions[i] = i;
+        }
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _running = partitions.size();
+        }
+        _schedule(partitions);
+    }
+
+    /**
+     * Moves the oldest ready batch into 'batch'. Returns kWait if none is ready yet, kEOF once
+     * every key range has been read, and kFailed with the error in 'status' if a worker failed.
+     */
+    Next next(Batch* batch, Status* status) {
+        std::vector<size_t> resumed;
+        Next result = Next::kWait;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_status.isOK()) {
+                *status = _status;
+                return Next::kFailed;
+            }
+            if (!_ready.empty()) {
+                *batch = std::move(_ready.front());
+                _ready.pop_front();
+                result = Next::kBatch;
+            } else if (_finished == _partitions.size()) {
+                return Next::kEOF;
+            }
+
+            // A consumed batch makes room for one range which found the buffer full. Without a
+            // running range, one is resumed regardless, so that the scan cannot stall.
+            if (!_paused.load() && (result == Next::kBatch || _running == 0)) {
+                resumed = _takeWaitingInlock(1);
+            }
+        }
+        _schedule(resumed);
+        return result;
+    }
+
+    /**
+     * Makes the workers stop after their current record, handing over what they read so far,
+     * and waits for them to. The ranges they were reading are resumed by resume(). Idempotent.
+     */
+    void pause() {
+        _paused.store(true);
+        _waitForTasks();
+    }
+
+    /**
+     * Lets the workers read 'recordStore' again after pause().
+     */
+    void resume(const RecordStore* recordStore) {
+        std::vector<size_t> resumed;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_paused.load()) {
+                return;
+            }
+            _recordStore = recordStore;
+            _paused.store(false);
+            // Only as many ranges as the buffer has room for, the others follow as it drains.
+            const size_t room =
+                _ready.size() < _maxReadyBatches ? _maxReadyBatches - _ready.size() : 0;
+            resumed = _takeWaitingInlock(room);
+        }
+        _schedule(resumed);
+    }
+
+    /**
+     * Stops the workers and waits for the tasks already scheduled to return. Idempotent.
+     */
+    void cancel() {
+        _cancelled.store(true);
+        _waitForTasks();
+    }
+
+private:
+    struct Partition {
+        RecordId start;
+        RecordId end;
+        // Saved and detached from any OperationContext between two batches.
+        std::unique_ptr<RecordCursor> cursor;
+    };
+
+    void _waitForTasks() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _running == 0; });
+    }
+
+    /**
+     * Returns up to 'count' of the ranges put aside by their workers, counted as running again.
+     */
+    std::vector<size_t> _takeWaitingInlock(size_t count) {
+        count = std::min(count, _waiting.size());
+        std::vector<size_t> taken(_waiting.begin(), _waiting.begin() + count);
+        _waiting.erase(_waiting.begin(), _waiting.begin() + count);
+        _running += taken.size();
+        return taken;
+    }
+
+    void _schedule(const std::vector<size_t>& partitions) {
+        for (size_t partition : partitions) {
+            auto status = workerPool().schedule(
+                [self = shared_from_this(), partition] { self->_scanBatch(partition); });
+            if (!status.isOK()) {
+                _taskDone(partition, {}, false, status);
+            }
+        }
+    }
+
+    /**
+     * Runs on the worker pool. Reads the next batch of a key range.
+     */
+    void _scanBatch(size_t partitionIndex) {
+        auto& partition = _partitions[partitionIndex];
+        Batch batch;
+        bool eof = false;
+        Status status = Status::OK();
+
+        if (!_cancelled.load()) {
+            auto opCtx = cc().makeOperationContext();
+            try {
+                // Record stores expect their cursors to be used under at least an intent lock.
+                Lock::GlobalLock globalLock(opCtx.get(), MODE_IS);
+                if (!partition.cursor) {
+                    partition.cursor =
+                        _recordStore->getRangeCursor(opCtx.get(), partition.start, partition.end);
+                } else {
+                    partition.cursor->reattachToOperationContext(opCtx.get());
+                    uassert(ErrorCodes::OperationFailed,
+                            "ParallelCollectionScan could not restore its position",
+                            partition.cursor->restore());
+                }
+
+                size_t bytes = 0;
+                while (batch.size() < kBatchDocuments && bytes < kBatchBytes &&
+                       !_cancelled.load() && !_paused.load()) {
+                    boost::optional<Record> record;
+                    try {
+                        record = partition.cursor->next();
+                    } catch (const WriteConflictException&) {
+                        // Hand over what was read so far. The next batch retries.
+                        break;
+                    }
+                    if (!record) {
+                        eof = true;
+                        break;
+                    }
+
+                    _docsTested.fetch_add(1, std::memory_order_relaxed);
+                    BSONObj obj = record->data.releaseToBson().getOwned();
+                    if (_filter && !_filter->matchesBSON(obj)) {
+                        continue;
+                    }
+                    bytes += obj.objsize();
+                    batch.push_back({record->id, std::move(obj)});
+                }
+
+                if (eof) {
+                    partition.cursor.reset();
+                } else {
+                    partition.cursor->save();
+                    partition.cursor->detachFromOperationContext();
+                }
+            } catch (const DBException& ex) {
+                partition.cursor.reset();
+                status = ex.toStatus();
+            }
+        }
+
+        _taskDone(partitionIndex, std::move(batch), eof, status);
+    }
+
+    void _taskDone(size_t partition, Batch batch, bool eof, const Status& status) {
+        std::vector<size_t> next;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            --_running;
+            if (!status.isOK()) {
+                if (_status.isOK()) {
+                    _status = status;
+                }
+                _cancelled.store(true);
+                ++_finished;
+            } else {
+                if (!batch.empty()) {
+                    _ready.push_back(std::move(batch));
+                }
+                if (eof) {
+                    ++_finished;
+                } else if (_cancelled.load()) {
+                    // The stage is going away or another range failed.
+                } else if (!_paused.load() && _ready.size() < _maxReadyBatches) {
+                    ++_running;
+                    next.push_back(partition);
+                } else {
+                    _waiting.push_back(partition);
+                }
+            }
+            _cv.notify_all();
+        }
+
+        _schedule(next);
+    }
+
+    // Only changed while paused.
+    const RecordStore* _recordStore;
+    // Only set if the filter is applied by the workers.
+    const MatchExpression* const _filter;
+    const size_t _maxReadyBatches;
+
+    // Each partition is only touched by the task reading it, and there is at most one at a time.
+    std::vector<Partition> _partitions;
+
+    std::atomic<bool> _cancelled{false};
+    // Set while the plan is saved. The record store may then go away.
+    std::atomic<bool> _paused{false};
+    std::atomic<size_t> _docsTested{0};
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::deque<Batch> _ready;
+    // Key ranges whose worker found '_ready' full or the scan paused.
+    std::vector<size_t> _waiting;
+    // Tasks scheduled and not returned yet.
+    size_t _running = 0;
+    // Key ranges read to the end, or which failed.
+    size_t _finished = 0;
+    Status _status = Status::OK();
+};
+
+// static
+const char* ParallelCollectionScan::kStageType = "PARALLEL_COLLSCAN";
+
+ParallelCollectionScan::ParallelCollectionScan(OperationContext* opCtx,
+                                               const Collection* collection,
+                                               std::vector<RecordId> partitionBounds,
+                                               WorkingSet* workingSet,
+                                               const MatchExpression* filter)
+    : PlanStage(kStageType, opCtx),
+      _nss(collection->ns()),
+      _uuid(collection->uuid()),
+      _workingSet(workingSet),
+      _filter(filter),
+      _filterInWorkers(isThreadSafe(filter)),
+      _wsidForFetch(_workingSet->allocate()),
+      _scan(std::make_shared<Scan>(collection->getRecordStore(),
+                                   partitionBounds,
+                                   _filterInWorkers ? filter : nullptr)) {
+    _specificStats.partitions = _scan->partitionCount();
+}
+
+ParallelCollectionScan::~ParallelCollectionScan() {
+    // Normally done by dispose() already.
+    _scan->cancel();
+}
+
+// static
+std::vector<RecordId> ParallelCollectionScan::getPartitionBounds(OperationContext* opCtx,
+                                                                 const Collection* collection) {
+    const int maxPartitions = internalQueryExecParallelCollectionScanMaxPartitions.load();
+    if (!collection || maxPartitions < 2 || collection->isCapped()) {
+        return {};
+    }
+    // Every batch is read in its own snapshot of the latest data, whatever the read concern of
+    // the operation asks for.
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    const auto level = readConcernArgs.getLevel();
+    if ((level != repl::ReadConcernLevel::kLocalReadConcern &&
+         level != repl::ReadConcernLevel::kAvailableReadConcern) ||
+        readConcernArgs.getArgsOpTime() || readConcernArgs.getArgsAfterClusterTime() ||
+        readConcernArgs.getArgsAtClusterTime()) {
+        return {};
+    }
+    if (collection->numRecords(opCtx) < internalQueryExecParallelCollectionScanMinRecords.load()) {
+        return {};
+    }
+    return collection->getRecordStore()->getPartitionBounds(opCtx,
+                                                            static_cast<size_t>(maxPartitions));
+}
+
+PlanStage::StageState ParallelCollectionScan::doWork(WorkingSetID* out) {
+    if (_isDead) {
+        Status status(ErrorCodes::QueryPlanKilled,
+                      str::stream() << "ParallelCollectionScan died because collection "
+                                    << _nss.ns()
+                                    << " was dropped or renamed");
+        *out = WorkingSetCommon::allocateStatusMember(_workingSet, status);
+        return PlanStage::DEAD;
+    }
+
+    if (_commonStats.isEOF) {
+        return PlanStage::IS_EOF;
+    }
+
+    if (!_started) {
+        _started = true;
+        _scan->start();
+    }
+
+    if (_batchPosition == _batch.size()) {
+        _batch.clear();
+        _batchPosition = 0;
+
+        Status status = Status::OK();
+        const auto next = _scan->next(&_batch, &status);
+        _specificStats.docsTested = _scan->docsTested();
+        switch (next) {
+            case Scan::Next::kBatch:
+                break;
+            case Scan::Next::kWait: {
+                // Ask for a yield rather than waiting with the locks held. Saving the plan makes
+                // the workers hand over what they read so far.
+                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                member->setFetcher(new YieldForBatch());
+                *out = _wsidForFetch;
+                return PlanStage::NEED_YIELD;
+            }
+            case Scan::Next::kEOF:
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            case Scan::Next::kFailed:
+                *out = WorkingSetCommon::allocateStatusMember(_workingSet, status);
+                return PlanStage::FAILURE;
+        }
+    }
+
+    auto& document = _batch[_batchPosition++];
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = std::move(document.id);
+    // The document was read in a snapshot of a worker, not in the one of this operation.
+    member->obj = {SnapshotId(), std::move(document.obj)};
+    _workingSet->transitionToRecordIdAndObj(id);
+
+    if (!_filterInWorkers && !Filter::passes(member, _filter)) {
+        _workingSet->free(id);
+        return PlanStage::NEED_TIME;
+    }
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+bool ParallelCollectionScan::isEOF() {
+    return _commonStats.isEOF || _isDead;
+}
+
+void ParallelCollectionScan::doSaveState() {
+    _scan->pause();
+}
+
+void ParallelCollectionScan::doRestoreState() {
+    // The workers read without locks, so they may only go on if the collection is still the one
+    // the plan was made for.
+    const Collection* collection = nullptr;
+    if (auto db = DatabaseHolder::getDatabaseHolder().get(getOpCtx(), _nss.ns())) {
+        collection = db->getCollection(getOpCtx(), _nss);
+    }
+    if (!collection || collection->uuid() != _uuid) {
+        _isDead = true;
+        return;
+    }
+    _scan->resume(collection->getRecordStore());
+}
+
+void ParallelCollectionScan::doDetachFromOperationContext() {
+    // Saving the plan paused the workers already.
+    _scan->pause();
+}
+
+void ParallelCollectionScan::doReattachToOperationContext() {
+    // The workers have their own OperationContexts, and are resumed by doRestoreState().
+}
+
+void ParallelCollectionScan::doDispose() {
+    _scan->cancel();
+}
+
+unique_ptr<PlanStageStats> ParallelCollectionScan::getStats() {
+    // Add a BSON representation of the filter to the stats tree, if there is one.
+    if (NULL != _filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        _commonStats.filter = bob.obj();
+    }
+
+    _specificStats.docsTested = _scan->docsTested();
+    unique_ptr<PlanStageStats> ret =
+        make_unique<PlanStageStats>(_commonStats, STAGE_PARALLEL_COLLSCAN);
+    ret->specific = make_unique<ParallelCollectionScanStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* ParallelCollectionScan::getSpecificStats() const {
+    return &_specificStats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+class Collection;
+class MatchExpression;
+class OperationContext;
+class WorkingSet;
+
+/**
+ * Scans a collection split into the key ranges returned by RecordStore::getPartitionBounds().
+ * The ranges are read concurrently by a pool of worker threads and the documents they find are
+ * returned in no particular order.
+ *
+ * Workers read a batch of documents at a time, each batch through its own OperationContext and
+ * thus in its own snapshot, like the batches of a getMore. They apply the filter themselves unless
+ * it evaluates $where or $expr, whose state is not thread safe. At most two batches per range are
+ * buffered; a range whose worker finds the buffer full waits, and one waiting range is resumed
+ * each time this stage consumes a batch.
+ *
+ * While no batch is ready, the stage does not block: it returns NEED_YIELD, so that the plan
+ * releases its locks and gives the coroutine thread group up to other operations before trying
+ * again. Plans which cannot yield just try again. Saving the plan pauses the workers, which hand
+ * over what they read so far, and restoring it resumes them unless the collection was dropped or
+ * renamed meanwhile, which kills the plan.
+ */
+class ParallelCollectionScan final : public PlanStage {
+public:
+    ParallelCollectionScan(OperationContext* opCtx,
+                           const Collection* collection,
+                           std::vector<RecordId> partitionBounds,
+                           WorkingSet* workingSet,
+                           const MatchExpression* filter);
+
+    ~ParallelCollectionScan();
+
+    /**
+     * Returns the bounds of the key ranges a collection scan of 'collection' should be split
+     * into, or an empty vector if the scan should not run in parallel.
+     */
+    static std::vector<RecordId> getPartitionBounds(OperationContext* opCtx,
+                                                    const Collection* collection);
+
+    StageState doWork(WorkingSetID* out) final;
+    bool isEOF() final;
+
+    void doSaveState() final;
+    void doRestoreState() final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
+
+    void doDispose() final;
+
+    StageType stageType() const final {
+        return STAGE_PARALLEL_COLLSCAN;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+
+    const SpecificStats* getSpecificStats() const final;
+
+    static const char* kStageType;
+
+private:
+    struct Document {
+        RecordId id;
+        BSONObj obj;
+    };
+    using Batch = std::vector<Document>;
+
+    class Scan;
+
+    // The collection is looked up again when the plan is restored.
+    const NamespaceString _nss;
+    const OptionalCollectionUUID _uuid;
+
+    // WorkingSet is not owned by us.
+    WorkingSet* _workingSet;
+
+    // The filter is not owned by us.
+    const MatchExpression* _filter;
+
+    // Whether the workers apply '_filter'. Otherwise it is applied by doWork().
+    const bool _filterInWorkers;
+
+    // Allocated on construction and only used to pass a RecordFetcher up with NEED_YIELD while no
+    // batch is ready. Remains in the INVALID state.
+    const WorkingSetID _wsidForFetch;
+
+    // Shared with the worker tasks, which may outlive this stage by a little.
+    std::shared_ptr<Scan> _scan;
+    bool _started = false;
+    // Set if the collection was dropped or renamed while the plan was saved.
+    bool _isDead = false;
+
+    // Batch being returned and the position of its next document.
+    Batch _batch;
+    size_t _batchPosition = 0;
+
+    // Stats
+    ParallelCollectionScanStats _specificStats;
+};
+
+}  // namespace mongo
@@ -181,6 +181,70 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
     return ret;
 }
 
+Status IndexAccessMethod::insertRecords(OperationContext* opCtx,
+                                        const std::vector<BsonRecord>& records,
+                                        const InsertDeleteOptions& options,
+                                        int64_t* numInserted) {
+    invariant(numInserted);
+    *numInserted = 0;
+
+    std::vector<IndexKeyEntry> entries;
+    entries.reserve(records.size());
+    bool multikey = false;
+    MultikeyPaths multikeyPaths;
+    for (const auto& record : records) {
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        MultikeyPaths recordMultikeyPaths;
+        // Delegate to the subclass.
+        getKeys(*record.docPtr, options.getKeysMode, &keys, &recordMultikeyPaths);
+
+        if (keys.size() > 1 || isMultikeyFromPaths(recordMultikeyPaths)) {
+            multikey = true;
+            if (multikeyPaths.empty()) {
+                multikeyPaths = std::move(recordMultikeyPaths);
+            } else {
+                for (size_t i = 0; i < recordMultikeyPaths.size(); ++i) {
+                    multikeyPaths[i].insert(recordMultikeyPaths[i].begin(),
+                                            recordMultikeyPaths[i].end());
+                }
+            }
+        }
+        for (const auto& key : keys) {
+            entries.emplace_back(key, record.id);
+        }
+    }
+
+    while (!entries.empty()) {
+        size_t failedAt = entries.size();
+        Status status = _newInterface->insertBatch(opCtx, entries, options.dupsAllowed, &failedAt);
+        if (status.isOK()) {
+            *numInserted += entries.size();
+            break;
+        }
+        invariant(failedAt < entries.size());
+        *numInserted += failedAt;
+
+        // Same tolerated errors as insert(): the batch goes on after the failed key.
+        if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(opCtx)) {
+            entries.erase(entries.begin(), entries.begin() + failedAt + 1);
+            continue;
+        }
+        if (status.code() == ErrorCodes::DuplicateKeyValue && !_btreeState->isReady(opCtx)) {
+            LOG(3) << "key " << entries[failedAt].key
+                   << " already in index during background indexing (ok)";
+            entries.erase(entries.begin(), entries.begin() + failedAt + 1);
+            continue;
+        }
+        return status;
+    }
+
+    if (multikey) {
+        _btreeState->setMultikey(opCtx, multikeyPaths);
+    }
+
+    return Status::OK();
+}
+
 void IndexAccessMethod::removeOneKey(OperationContext* opCtx,
                                      const BSONObj& key,
                                      const RecordId& loc,
@@ -47,6 +47,7 @@ extern AtomicBool failIndexKeyTooLong;
 class BSONObjBuilder;
 class MatchExpression;
 class UpdateTicket;
+struct BsonRecord;
 struct InsertDeleteOptions;
 
 /**
@@ -84,6 +85,19 @@ public:
                   const InsertDeleteOptions& options,
                   int64_t* numInserted);
 
+    /**
+     * Like insert(), for every record of 'records', but hands the keys of all the records to the
+     * storage engine in one call. 'numInserted' will be set to the number of keys added to the
+     * index.
+     *
+     * Keys inserted before an error are not removed, so the caller must abort its unit of work
+     * when an error is returned.
+     */
+    Status insertRecords(OperationContext* opCtx,
+                         const std::vector<BsonRecord>& records,
+                         const InsertDeleteOptions& options,
+                         int64_t* numInserted);
+
     /**
      * Analogous to above, but remove the records instead of inserting them.
      * 'numDeleted' will be set to the number of keys removed from the index for the document.
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -49,7 +50,11 @@ class TreeMatchExpression;
 
 typedef StatusWith<std::unique_ptr<MatchExpression>> StatusWithMatchExpression;
 
-class MatchExpression {
+/**
+ * Match expression trees opt into the operation arena. Trees parsed inside an
+ * OperationArena::Scope live in the operation's arena.
+ */
+class MatchExpression : public OperationArenaAllocated {
     MONGO_DISALLOW_COPYING(MatchExpression);
 
 public:
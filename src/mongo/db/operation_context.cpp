@@ -115,6 +115,23 @@ void OperationContext::reset(Client* client, unsigned int opId) {
     _writesAreReplicated = true;
     _coroYield = nullptr;
     _coroResume = nullptr;
+    _coroSliceStartMicros = 0;
+}
+
+bool OperationContext::yieldCoroutineIfTimeSliceExpired(Microseconds timeSlice) {
+    if (!_coroYield || !_coroResume || timeSlice <= Microseconds(0)) {
+        return false;
+    }
+    if (_elapsedTime.micros() - _coroSliceStartMicros < durationCount<Microseconds>(timeSlice)) {
+        return false;
+    }
+
+    // Requeue before suspending. The resume task is only run by this coroutine's own thread
+    // group, which cannot pick it up before the yield has switched back to its scheduler.
+    (*_coroResume)();
+    (*_coroYield)();
+    _coroSliceStartMicros = _elapsedTime.micros();
+    return true;
 }
 
 void OperationContext::setDeadlineAndMaxTime(Date_t when,
@@ -45,6 +45,7 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/decorable.h"
+#include "mongo/util/operation_arena.h"
 #include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 #include <utility>
@@ -57,10 +58,23 @@ class ProgressMeter;
 class ServiceContext;
 class StringData;
 
+class OperationContext;
+
 namespace repl {
 class UnreplicatedWritesBlock;
 }  // namespace repl
 
+/**
+ * Most operations touch a handful of the decorations declared by the whole server, so they are
+ * constructed on first access, and only the ones used since the previous reset are reset when a
+ * pooled OperationContext is reused.
+ */
+template <>
+struct DecorationTraits<OperationContext> {
+    static constexpr bool kLazy = true;
+    static constexpr bool kResettable = true;
+};
+
 /**
  * This class encompasses the state required by an operation and lives from the time a network
  * operation is dispatched until its execution is finished. Note that each "getmore" on a cursor
@@ -257,6 +271,14 @@ public:
         return _client;
     }
 
+    /**
+     * Returns the arena for allocations which do not outlive this operation. It is reset when the
+     * OperationContext is recycled.
+     */
+    OperationArena& arena() {
+        return _arena;
+    }
+
     /**
      * Returns the operation ID associated with this operation.
      */
@@ -438,6 +460,7 @@ public:
                               const std::function<void()>* resume) {
         _coroYield = yield;
         _coroResume = resume;
+        _coroSliceStartMicros = _elapsedTime.micros();
     }
 
     std::pair<const std::function<void()>*, const std::function<void()>*> getCoroutineFunctors()
@@ -445,6 +468,17 @@ public:
         return {_coroYield, _coroResume};
     }
 
+    /**
+     * Cooperative time slicing for operations running inside a coroutine. If the coroutine has
+     * run for at least 'timeSlice' since the operation started or last gave up its thread group
+     * here, requeues the coroutine and suspends it so that other sessions on the same thread
+     * group get to run. Returns true if the coroutine was suspended and has been resumed.
+     *
+     * Must only be called at a point where the operation holds no locks which could block other
+     * operations on the same thread.
+     */
+    bool yieldCoroutineIfTimeSliceExpired(Microseconds timeSlice);
+
 private:
     /**
      * Returns true if this operation has a deadline and it has passed according to the fast clock
@@ -535,10 +569,15 @@ private:
     // Timer counting the elapsed time since the construction of this OperationContext.
     Timer _elapsedTime;
 
+    OperationArena _arena;
+
     bool _writesAreReplicated = true;
 
     const std::function<void()>* _coroYield{nullptr};
     const std::function<void()>* _coroResume{nullptr};
+
+    // Value of _elapsedTime when the current coroutine time slice started.
+    long long _coroSliceStartMicros{0};
 };
 
 namespace repl {
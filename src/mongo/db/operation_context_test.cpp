@@ -139,6 +139,111 @@ DEATH_TEST(OperationContextTest, SettingTransactionNumberWithoutSessionIdShouldC
     opCtx->setTxnNumber(5);
 }
 
+TEST(OperationContextTest, CoroutineYieldsOnlyOnceTimeSliceExpires) {
+    auto serviceCtx = ServiceContext::make();
+    auto client = serviceCtx->makeClient("OperationContextTest");
+    auto opCtx = client->makeOperationContext();
+
+    // Not running in a coroutine.
+    ASSERT_FALSE(opCtx->yieldCoroutineIfTimeSliceExpired(Microseconds(0)));
+
+    std::vector<std::string> calls;
+    const std::function<void()> yield = [&] { calls.push_back("yield"); };
+    const std::function<void()> resume = [&] { calls.push_back("resume"); };
+    opCtx->setCoroutineFunctors(&yield, &resume);
+
+    ASSERT_FALSE(opCtx->yieldCoroutineIfTimeSliceExpired(Microseconds(0)));
+    ASSERT_FALSE(opCtx->yieldCoroutineIfTimeSliceExpired(Hours(1)));
+    ASSERT(calls.empty());
+
+    sleepmillis(2);
+    ASSERT_TRUE(opCtx->yieldCoroutineIfTimeSliceExpired(Milliseconds(1)));
+    ASSERT_EQ(2U, calls.size());
+    ASSERT_EQ("resume", calls[0]);
+    ASSERT_EQ("yield", calls[1]);
+
+    // A new time slice starts once the coroutine is resumed.
+    ASSERT_FALSE(opCtx->yieldCoroutineIfTimeSliceExpired(Hours(1)));
+    ASSERT_EQ(2U, calls.size());
+}
+
+struct LazyDecoration {
+    LazyDecoration() {
+        ++constructed;
+    }
+
+    void reset() {
+        ++resets;
+        value = 0;
+    }
+
+    static int constructed;
+    static int resets;
+    int value{0};
+};
+
+int LazyDecoration::constructed = 0;
+int LazyDecoration::resets = 0;
+
+const auto getLazyDecoration = OperationContext::declareDecoration<LazyDecoration>();
+
+TEST(OperationContextTest, DecorationsAreConstructedOnFirstUseAndResetOnlyIfTouched) {
+    auto serviceCtx = ServiceContext::make();
+    auto client = serviceCtx->makeClient("OperationContextTest");
+    auto opCtx = client->makeOperationContext();
+
+    const int constructedBefore = LazyDecoration::constructed;
+    const int resetsBefore = LazyDecoration::resets;
+
+    // Untouched decorations are neither reset nor constructed when the context is reused.
+    opCtx->reset(client.get(), opCtx->getOpID());
+    ASSERT_EQ(constructedBefore, LazyDecoration::constructed);
+    ASSERT_EQ(resetsBefore, LazyDecoration::resets);
+
+    getLazyDecoration(opCtx.get()).value = 42;
+    getLazyDecoration(opCtx.get()).value++;
+    ASSERT_EQ(constructedBefore + 1, LazyDecoration::constructed);
+
+    opCtx->reset(client.get(), opCtx->getOpID());
+    ASSERT_EQ(resetsBefore + 1, LazyDecoration::resets);
+
+    // Not touched since the previous reset.
+    opCtx->reset(client.get(), opCtx->getOpID());
+    ASSERT_EQ(resetsBefore + 1, LazyDecoration::resets);
+
+    ASSERT_EQ(0, getLazyDecoration(opCtx.get()).value);
+    ASSERT_EQ(constructedBefore + 1, LazyDecoration::constructed);
+}
+
+struct EagerDecoration {
+    EagerDecoration() {
+        ++constructed;
+    }
+
+    void reset() {}
+
+    static int constructed;
+};
+
+int EagerDecoration::constructed = 0;
+
+const auto getEagerDecoration = OperationContext::declareEagerDecoration<EagerDecoration>();
+
+TEST(OperationContextTest, EagerDecorationsAreConstructedWithTheContext) {
+    auto serviceCtx = ServiceContext::make();
+    auto client = serviceCtx->makeClient("OperationContextTest");
+
+    const int constructedBefore = EagerDecoration::constructed;
+    auto opCtx = client->makeOperationContext();
+    ASSERT_LTE(constructedBefore + 1, EagerDecoration::constructed);
+
+    // Reusing the context resets the decoration in place.
+    const int constructedAfter = EagerDecoration::constructed;
+    opCtx->reset(client.get(), opCtx->getOpID());
+    getEagerDecoration(opCtx.get());
+    ASSERT_EQ(constructedAfter, EagerDecoration::constructed);
+}
+
 TEST(OperationContextTest, OpCtxGroup) {
     OperationContextGroup group1;
     ASSERT_TRUE(group1.isEmpty());
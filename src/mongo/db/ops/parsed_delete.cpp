@@ -92,6 +92,9 @@ Status ParsedDelete::parseQueryToCQ() {
         qr->setLimit(1);
     }
 
+    // The query, and the executor built from it, never outlive the delete operation, so the
+    // match expression tree can live in the operation's arena.
+    OperationArena::Scope arenaScope(&_opCtx->arena());
     const boost::intrusive_ptr<ExpressionContext> expCtx;
     auto statusWithCQ =
         CanonicalQuery::canonicalize(_opCtx,
@@ -125,6 +125,9 @@ Status ParsedUpdate::parseQueryToCQ() {
         allowedMatcherFeatures &= ~MatchExpressionParser::AllowedFeatures::kExpr;
     }
 
+    // The query, and the executor built from it, never outlive the update operation, so the
+    // match expression tree can live in the operation's arena.
+    OperationArena::Scope arenaScope(&_opCtx->arena());
     boost::intrusive_ptr<ExpressionContext> expCtx;
     auto statusWithCQ = CanonicalQuery::canonicalize(
         _opCtx, std::move(qr), std::move(expCtx), extensionsCallback, allowedMatcherFeatures);
@@ -391,6 +391,12 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         plannerOpts |= QueryPlannerParams::TRACK_LATEST_OPLOG_TS;
     }
 
+    // A $sort is either answered by an index or left in the pipeline, so nothing depends on the
+    // order of a collection scan and its key ranges may be read concurrently.
+    if (expCtx->tailableMode == TailableModeEnum::kNormal) {
+        plannerOpts |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    }
+
     const BSONObj emptyProjection;
     const BSONObj metaSortProjection = BSON("$meta"
                                             << "sortKey");
@@ -1375,7 +1375,8 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorCount(
             opCtx, std::move(ws), std::move(root), request.getNs(), yieldPolicy);
     }
 
-    size_t plannerOptions = QueryPlannerParams::IS_COUNT;
+    // The count does not depend on the order the documents are found in.
+    size_t plannerOptions = QueryPlannerParams::IS_COUNT | QueryPlannerParams::PARALLEL_COLLSCAN;
     if (ShardingState::get(opCtx)->needCollectionMetadata(opCtx, request.getNs().ns())) {
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
@@ -792,4 +792,16 @@ void PlanExecutor::Deleter::operator()(PlanExecutor* execPtr) {
     }
 }
 
+template <>
+void deinit(PlanExecutor* ptr) {
+    // Release what the executor owns instead of keeping it alive in the pool until the executor is
+    // reused. The objects may live in the arena of the operation which is about to end. The plan
+    // stages refer to the other members, so they go first.
+    ptr->_root.reset();
+    ptr->_qs.reset();
+    ptr->_cq.reset();
+    ptr->_workingSet.reset();
+    ptr->_stash = {};
+}
+
 }  // namespace mongo
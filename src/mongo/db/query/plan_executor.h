@@ -34,6 +34,7 @@
 #include <memory>
 #include <queue>
 
+#include "mongo/base/object_pool.h"
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/util/partitioned.h"
 #include "mongo/db/invalidation_type.h"
@@ -603,6 +604,12 @@ private:
         _registrationToken;
 
     bool _everDetachedFromOperationContext = false;
+
+    template <typename T>
+    friend void deinit(T* ptr);
 };
 
+template <>
+void deinit(PlanExecutor* ptr);
+
 }  // namespace mongo
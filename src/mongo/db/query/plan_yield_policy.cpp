@@ -121,7 +121,13 @@ Status PlanYieldPolicy::yieldOrInterrupt(stdx::function<void()> beforeYieldingFn
                 "setInterruptOnlyPlansCheckForInterruptHang");
         }
 
-        return opCtx->checkForInterruptNoAssert();
+        auto interruptStatus = opCtx->checkForInterruptNoAssert();
+        if (interruptStatus.isOK() && !opCtx->lockState()->isLocked()) {
+            // Locks are never released for these plans, but one that holds none can still give
+            // up its coroutine thread group.
+            QueryYield::yieldCoroutineTimeSlice(opCtx);
+        }
+        return interruptStatus;
     }
 
     return yield(beforeYieldingFn, whileYieldingFn);
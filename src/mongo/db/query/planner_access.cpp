@@ -157,11 +157,13 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         params.options & QueryPlannerParams::OPLOG_SCAN_WAIT_FOR_VISIBLE;
 
     // If the hint is {$natural: +-1} this changes the direction of the collection scan.
+    bool naturalOrder = false;
     if (!query.getQueryRequest().getHint().isEmpty()) {
         BSONElement natural =
             dps::extractElementAtPath(query.getQueryRequest().getHint(), "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            naturalOrder = true;
         }
     }
 
@@ -172,9 +174,16 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         BSONElement natural = dps::extractElementAtPath(sortObj, "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            naturalOrder = true;
         }
     }
 
+    // A parallel scan returns the documents in no particular order, so it is only used when the
+    // caller allows it and nothing depends on the order of the scan.
+    csn->parallel = (params.options & QueryPlannerParams::PARALLEL_COLLSCAN) && !tailable &&
+        !naturalOrder && !csn->maxScan && !csn->shouldTrackLatestOplogTimestamp &&
+        !csn->shouldWaitForOplogVisibility;
+
     return std::move(csn);
 }
 
@@ -66,6 +66,13 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecCoroutineTimeSliceMicros, int, 2000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelCollectionScanMaxPartitions, int, 8);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelCollectionScanMinRecords,
+                              long long,
+                              100 * 1000);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
@@ -110,6 +110,17 @@ extern AtomicInt32 internalQueryExecYieldIterations;
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// When running inside a coroutine, give up the thread group at a yield point once the operation
+// has run for at least this many microseconds. 0 disables time slicing.
+extern AtomicInt32 internalQueryExecCoroutineTimeSliceMicros;
+
+// Split the collection scans of aggregations and counts into at most this many key ranges, read
+// concurrently. 1 or less disables parallel collection scans.
+extern AtomicInt32 internalQueryExecParallelCollectionScanMaxPartitions;
+
+// Collections with fewer records are always scanned by a single cursor.
+extern AtomicInt64 internalQueryExecParallelCollectionScanMinRecords;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
@@ -99,6 +99,10 @@ struct QueryPlannerParams {
 
         // Set this so that collection scans on the oplog wait for visibility before reading.
         OPLOG_SCAN_WAIT_FOR_VISIBLE = 1 << 13,
+
+        // Set this to let a collection scan read key ranges of the collection concurrently. The
+        // documents are then returned in no particular order.
+        PARALLEL_COLLSCAN = 1 << 14,
     };
 
     // See Options enum above.
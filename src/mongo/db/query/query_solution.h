@@ -308,6 +308,10 @@ struct CollectionScanNode : public QuerySolutionNode {
 
     // Whether or not to wait for oplog visibility on oplog collection scans.
     bool shouldWaitForOplogVisibility = false;
+
+    // Whether the scan may read key ranges of the collection concurrently, returning the
+    // documents in no particular order.
+    bool parallel = false;
 };
 
 struct AndHashNode : public QuerySolutionNode {
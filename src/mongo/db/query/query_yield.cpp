@@ -29,9 +29,12 @@
 
 #include "mongo/db/query/query_yield.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/time_support.h"
@@ -41,6 +44,10 @@ namespace mongo {
 namespace {
 MONGO_FAIL_POINT_DEFINE(setYieldAllLocksHang);
 MONGO_FAIL_POINT_DEFINE(setYieldAllLocksWait);
+
+Counter64 coroutineTimeSliceYields;
+ServerStatusMetricField<Counter64> displayCoroutineTimeSliceYields(
+    "query.coroutineTimeSliceYields", &coroutineTimeSliceYields);
 }  // namespace
 
 // static
@@ -57,8 +64,12 @@ void QueryYield::yieldAllLocks(OperationContext* opCtx,
 
     Locker::LockSnapshot snapshot;
 
-    // Nothing was unlocked, just return, yielding is pointless.
+    // Nothing was unlocked, just return, yielding is pointless. An operation which holds no locks
+    // at all can still give up its coroutine thread group.
     if (!locker->saveLockStateAndUnlock(&snapshot)) {
+        if (!locker->isLocked()) {
+            yieldCoroutineTimeSlice(opCtx);
+        }
         return;
     }
 
@@ -83,8 +94,20 @@ void QueryYield::yieldAllLocks(OperationContext* opCtx,
         whileYieldingFn();
     }
 
+    yieldCoroutineTimeSlice(opCtx);
+
     UninterruptibleLockGuard noInterrupt(locker);
     locker->restoreLockState(opCtx, snapshot);
 }
 
+// static
+bool QueryYield::yieldCoroutineTimeSlice(OperationContext* opCtx) {
+    auto timeSlice = Microseconds(internalQueryExecCoroutineTimeSliceMicros.load());
+    if (!opCtx->yieldCoroutineIfTimeSliceExpired(timeSlice)) {
+        return false;
+    }
+    coroutineTimeSliceYields.increment();
+    return true;
+}
+
 }  // namespace mongo
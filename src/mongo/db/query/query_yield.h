@@ -54,6 +54,14 @@ public:
     static void yieldAllLocks(OperationContext* opCtx,
                               stdx::function<void()> whileYieldingFn,
                               const NamespaceString& planExecNS);
+
+    /**
+     * If running inside a coroutine which has used up its time slice, requeues the coroutine on
+     * its thread group and suspends it. Returns true if the coroutine was suspended.
+     *
+     * The caller must not hold any locks.
+     */
+    static bool yieldCoroutineTimeSlice(OperationContext* opCtx);
 };
 
 }  // namespace mongo
@@ -49,6 +49,7 @@
 #include "mongo/db/exec/limit.h"
 #include "mongo/db/exec/merge_sort.h"
 #include "mongo/db/exec/or.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/skip.h"
@@ -75,6 +76,14 @@ PlanStage* buildStages(OperationContext* opCtx,
     switch (root->getType()) {
         case STAGE_COLLSCAN: {
             const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(root);
+            if (csn->parallel) {
+                auto bounds = ParallelCollectionScan::getPartitionBounds(opCtx, collection);
+                if (!bounds.empty()) {
+                    return new ParallelCollectionScan(
+                        opCtx, collection, std::move(bounds), ws, csn->filter.get());
+                }
+            }
+
             CollectionScanParams params;
             params.collection = collection;
             params.tailable = csn->tailable;
@@ -366,6 +375,7 @@ PlanStage* buildStages(OperationContext* opCtx,
         case STAGE_MULTI_ITERATOR:
         case STAGE_MULTI_PLAN:
         case STAGE_OPLOG_START:
+        case STAGE_PARALLEL_COLLSCAN:
         case STAGE_PIPELINE_PROXY:
         case STAGE_QUEUED_DATA:
         case STAGE_SUBPLAN:
@@ -73,7 +73,7 @@ struct ServerGlobalParams {
     bool noUnixSocket = false;    // --nounixsocket
     bool doFork = false;          // --fork
     std::string socket = "/tmp";  // UNIX domain socket directory
-    std::string transportLayer;   // --transportLayer (must be either "asio" or "legacy")
+    std::string transportLayer;   // --transportLayer (must be either "asio" or "uring")
 
     // --serviceExecutor ("adaptive", "synchronous")
     std::string serviceExecutor;
@@ -82,6 +82,9 @@ struct ServerGlobalParams {
     bool enableCoroutine{true};
     size_t reservedThreadNum = 1;
     size_t adaptiveThreadNum = 1;
+    // Each coroutine thread group polls its own ingress reactor, and sessions stay on the group
+    // whose reactor owns their socket.
+    bool runToCompletion{false};
 
     int unixSocketPermissions = DEFAULT_UNIX_PERMS;  // permissions for the UNIX domain socket
 
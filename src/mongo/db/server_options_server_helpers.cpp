@@ -140,6 +140,11 @@ Status addGeneralServerOptions(moe::OptionSection* options) {
                                "adaptiveThreadNum",
                                moe::Unsigned,
                                "set the thread num for adaptive service executor mode");
+    options->addOptionChaining("net.runToCompletion",
+                               "runToCompletion",
+                               moe::Bool,
+                               "whether coroutine thread groups poll the ingress network "
+                               "themselves, running each request on a single thread");
 
 #if MONGO_ENTERPRISE_VERSION
     options->addOptionChaining("security.redactClientLogData",
@@ -547,9 +552,21 @@ Status storeServerOptions(const moe::Environment& params) {
 
     if (params.count("net.transportLayer")) {
         serverGlobalParams.transportLayer = params["net.transportLayer"].as<std::string>();
+#ifdef MONGO_CONFIG_IO_URING
+        if (serverGlobalParams.transportLayer != "asio" &&
+            serverGlobalParams.transportLayer != "uring") {
+            return {ErrorCodes::BadValue,
+                    "Unsupported value for transportLayer. Must be \"asio\" or \"uring\""};
+        }
+#else
+        if (serverGlobalParams.transportLayer == "uring") {
+            return {ErrorCodes::BadValue,
+                    "transportLayer \"uring\" is not available, this build lacks io_uring support"};
+        }
         if (serverGlobalParams.transportLayer != "asio") {
             return {ErrorCodes::BadValue, "Unsupported value for transportLayer. Must be \"asio\""};
         }
+#endif
     }
 
     if (params.count("net.serviceExecutor")) {
@@ -585,6 +602,13 @@ Status storeServerOptions(const moe::Environment& params) {
         }
     }
 
+    if (params.count("net.runToCompletion")) {
+        serverGlobalParams.runToCompletion = params["net.runToCompletion"].as<bool>();
+        if (serverGlobalParams.runToCompletion && !serverGlobalParams.enableCoroutine) {
+            return Status(ErrorCodes::BadValue, "runToCompletion requires coroutine mode");
+        }
+    }
+
     if (params.count("security.transitionToAuth")) {
         serverGlobalParams.transitionToAuth = params["security.transitionToAuth"].as<bool>();
     }
@@ -292,6 +292,8 @@ void ServiceContext::OperationContextDeleter::operator()(OperationContext* opCtx
         client->resetOperationContext();
     }
     onDestroy(opCtx, service->_clientObservers);
+    // Everything the operation placed in its arena is gone by now.
+    opCtx->arena().reset();
     // delete opCtx;
     ObjectPool<OperationContext>::recycleObject(opCtx);
 }
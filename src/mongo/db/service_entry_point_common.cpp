@@ -78,6 +78,7 @@
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/rpc/message.h"
 #include "mongo/rpc/metadata.h"
+#include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/rpc/metadata/config_server_metadata.h"
 #include "mongo/rpc/metadata/logical_time_metadata.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
@@ -89,12 +90,15 @@
 #include "mongo/s/cannot_implicitly_create_collection_info.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/stale_exception.h"
+#include "mongo/transport/admission_controller.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
+extern thread_local int16_t localThreadId;
+
 MONGO_FAIL_POINT_DEFINE(failCommand);
 MONGO_FAIL_POINT_DEFINE(rsStopGetMore);
 MONGO_FAIL_POINT_DEFINE(respondWithNotPrimaryInCommandDispatch);
@@ -230,6 +234,7 @@ BSONObj getErrorLabels(const boost::optional<OperationSessionInfoFromClient>& se
     bool isRetryable = ErrorCodes::isNotMasterError(code) || ErrorCodes::isShutdownError(code);
     bool isTransientTransactionError = code == ErrorCodes::WriteConflict  //
         || code == ErrorCodes::SnapshotUnavailable                        //
+        || ErrorCodes::isAdmissionControlError(code)                      //
         || code == ErrorCodes::NoSuchTransaction                          //
         || code == ErrorCodes::LockTimeout                                //
         // Clients can retry a single commitTransaction command, but cannot retry the whole
@@ -620,6 +625,44 @@ void evaluateFailCommandFailPoint(OperationContext* opCtx, StringData commandNam
     }
 }
 
+/**
+ * Refuses the request if the thread group running it is overloaded, and charges it to its tenant's
+ * rate limit. Internal clients, direct clients and commands which need no authentication, such as
+ * isMaster, are never refused.
+ */
+void admitRequest(OperationContext* opCtx, Command* command) {
+    auto& admission = transport::AdmissionController::get();
+    auto client = opCtx->getClient();
+    if (client->isInDirectClient() || !command->requiresAuth()) {
+        return;
+    }
+    auto session = client->session();
+    if (!session || (session->getTags() & transport::Session::kInternalClient)) {
+        return;
+    }
+
+    if (localThreadId >= 0) {
+        uassertStatusOK(admission.admitRequestOnThreadGroup(localThreadId));
+    }
+    if (!admission.rateLimitEnabled()) {
+        return;
+    }
+
+    std::string tenant;
+    if (admission.rateLimitByUser()) {
+        auto users = AuthorizationSession::get(client)->getAuthenticatedUserNames();
+        if (users.more()) {
+            tenant = users.get().getFullName();
+        }
+    } else {
+        const auto& clientMetadata = ClientMetadataIsMasterState::get(client).getClientMetadata();
+        if (clientMetadata) {
+            tenant = clientMetadata.get().getApplicationName().toString();
+        }
+    }
+    uassertStatusOK(admission.admitRequest(tenant));
+}
+
 /**
  * Executes a command after stripping metadata, performing authorization checks,
  * handling audit impersonation, and (potentially) setting maintenance mode. This method
@@ -750,6 +793,7 @@ void execCommandDatabase(OperationContext* opCtx,
 
         ImpersonationSessionGuard guard(opCtx);
         invocation->checkAuthorization(opCtx, request);
+        admitRequest(opCtx, command);
 
         const bool iAmPrimary = replCoord->canAcceptWritesForDatabase_UNSAFE(opCtx, dbname);
 
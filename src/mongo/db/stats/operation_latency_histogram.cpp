@@ -174,4 +174,55 @@ void OperationLatencyHistogram::increment(uint64_t latency, Command::ReadWriteTy
     }
 }
 
+namespace {
+void add(std::atomic<uint64_t>& counter, uint64_t value, bool exclusiveWriter) {
+    if (exclusiveWriter) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    } else {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+}
+}  // namespace
+
+void ConcurrentOperationLatencyHistogram::increment(uint64_t latency,
+                                                    Command::ReadWriteType type,
+                                                    bool exclusiveWriter) {
+    HistogramData* data;
+    switch (type) {
+        case Command::ReadWriteType::kRead:
+            data = &_reads;
+            break;
+        case Command::ReadWriteType::kWrite:
+            data = &_writes;
+            break;
+        case Command::ReadWriteType::kCommand:
+            data = &_commands;
+            break;
+        case Command::ReadWriteType::kTransaction:
+            data = &_transactions;
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+    add(data->buckets[OperationLatencyHistogram::_getBucket(latency)], 1, exclusiveWriter);
+    add(data->entryCount, 1, exclusiveWriter);
+    add(data->sum, latency, exclusiveWriter);
+}
+
+void ConcurrentOperationLatencyHistogram::HistogramData::snapshot(
+    OperationLatencyHistogram::HistogramData* data) const {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        data->buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+    data->entryCount += entryCount.load(std::memory_order_relaxed);
+    data->sum += sum.load(std::memory_order_relaxed);
+}
+
+void ConcurrentOperationLatencyHistogram::snapshot(OperationLatencyHistogram* histogram) const {
+    _reads.snapshot(&histogram->_reads);
+    _writes.snapshot(&histogram->_writes);
+    _commands.snapshot(&histogram->_commands);
+    _transactions.snapshot(&histogram->_transactions);
+}
+
 }  // namespace mongo
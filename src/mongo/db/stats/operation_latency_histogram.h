@@ -28,6 +28,8 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstdint>
 
 #include "mongo/db/commands.h"
 
@@ -76,7 +78,7 @@ private:
                 buckets[i] += other.buckets[i];
             }
             entryCount += other.entryCount;
-            sum += other.entryCount;
+            sum += other.sum;
         }
     };
 
@@ -92,5 +94,35 @@ private:
     void _incrementData(uint64_t latency, int bucket, HistogramData* data);
 
     HistogramData _reads, _writes, _commands, _transactions;
+
+    friend class ConcurrentOperationLatencyHistogram;
+};
+
+/**
+ * An OperationLatencyHistogram which can be read while it is incremented, without locks.
+ *
+ * Increments are plain loads and stores unless 'exclusiveWriter' is false, so a histogram
+ * incremented by a single thread costs no atomic read-modify-write. Readers may see an increment
+ * partially applied, which only matters for the few moments it is in flight.
+ */
+class ConcurrentOperationLatencyHistogram {
+public:
+    void increment(uint64_t latency, Command::ReadWriteType type, bool exclusiveWriter);
+
+    /**
+     * Adds the current counts to 'histogram'.
+     */
+    void snapshot(OperationLatencyHistogram* histogram) const;
+
+private:
+    struct HistogramData {
+        std::array<std::atomic<uint64_t>, OperationLatencyHistogram::kMaxBuckets> buckets{};
+        std::atomic<uint64_t> entryCount{0};
+        std::atomic<uint64_t> sum{0};
+
+        void snapshot(OperationLatencyHistogram::HistogramData* data) const;
+    };
+
+    HistogramData _reads, _writes, _commands, _transactions;
 };
 }  // namespace mongo
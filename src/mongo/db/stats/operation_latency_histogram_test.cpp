@@ -91,4 +91,45 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
         ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
     }
 }
+
+TEST(OperationLatencyHistogram, MergeAddsLatencies) {
+    OperationLatencyHistogram hist;
+    hist.increment(100, Command::ReadWriteType::kWrite);
+    OperationLatencyHistogram other;
+    other.increment(20, Command::ReadWriteType::kWrite);
+    other.increment(3, Command::ReadWriteType::kWrite);
+    hist += other;
+
+    BSONObjBuilder outBuilder;
+    hist.append(false, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["writes"]["ops"].Long(), 3);
+    ASSERT_EQUALS(out["writes"]["latency"].Long(), 123);
+}
+
+TEST(ConcurrentOperationLatencyHistogram, SnapshotMatchesPlainHistogram) {
+    OperationLatencyHistogram expected;
+    ConcurrentOperationLatencyHistogram exclusive;
+    ConcurrentOperationLatencyHistogram shared;
+    for (int i = 0; i < kMaxBuckets; i++) {
+        for (auto type : {Command::ReadWriteType::kRead,
+                          Command::ReadWriteType::kWrite,
+                          Command::ReadWriteType::kCommand,
+                          Command::ReadWriteType::kTransaction}) {
+            expected.increment(kLowerBounds[i] + i, type);
+            exclusive.increment(kLowerBounds[i] + i, type, true);
+            shared.increment(kLowerBounds[i] + i, type, false);
+        }
+    }
+
+    BSONObjBuilder expectedBuilder;
+    expected.append(true, &expectedBuilder);
+    for (auto* hist : {&exclusive, &shared}) {
+        OperationLatencyHistogram snapshot;
+        hist->snapshot(&snapshot);
+        BSONObjBuilder snapshotBuilder;
+        snapshot.append(true, &snapshotBuilder);
+        ASSERT_BSONOBJ_EQ(snapshotBuilder.obj(), expectedBuilder.asTempObj());
+    }
+}
 }  // namespace mongo
@@ -28,9 +28,14 @@
  */
 
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
 
 #include "mongo/platform/basic.h"
@@ -73,11 +78,117 @@ Top::CollectionData::CollectionData(const CollectionData& older, const Collectio
       remove(older.remove, newer.remove),
       commands(older.commands, newer.commands) {}
 
+namespace {
+void add(std::atomic<long long>& counter, long long value) {
+    // Every slot has a single writer at a time.
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+}  // namespace
+
+Top::Top()
+    : _histogramSlots(std::make_unique<HistogramSlot[]>(_slotCount)),
+      _slotCaches(std::make_unique<SlotCache[]>(_slotCount)) {}
+
+Top::~Top() = default;
+
 // static
 Top& Top::get(ServiceContext* service) {
     return getTop(service);
 }
 
+Top::NamespaceUsage::NamespaceUsage(size_t slotCount)
+    : slotCount(slotCount), slots(std::make_unique<std::atomic<SlotUsage*>[]>(slotCount)) {
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Top::NamespaceUsage::~NamespaceUsage() {
+    for (size_t i = 0; i < slotCount; ++i) {
+        delete slots[i].load(std::memory_order_relaxed);
+    }
+}
+
+Top::SlotUsage* Top::NamespaceUsage::getSlot(size_t slot) {
+    auto usage = slots[slot].load(std::memory_order_relaxed);
+    if (!usage) {
+        usage = new SlotUsage();
+        // Readers may see the slot as soon as it is stored.
+        slots[slot].store(usage, std::memory_order_release);
+    }
+    return usage;
+}
+
+void Top::NamespaceUsage::snapshot(CollectionData* data) const {
+    UsageData* const fields[kUsageFieldCount] = {&data->total,
+                                                 &data->readLock,
+                                                 &data->writeLock,
+                                                 &data->queries,
+                                                 &data->getmore,
+                                                 &data->insert,
+                                                 &data->update,
+                                                 &data->remove,
+                                                 &data->commands};
+    for (size_t i = 0; i < slotCount; ++i) {
+        auto usage = slots[i].load(std::memory_order_acquire);
+        if (!usage) {
+            continue;
+        }
+        for (size_t field = 0; field < kUsageFieldCount; ++field) {
+            fields[field]->time += usage->time[field].load(std::memory_order_relaxed);
+            fields[field]->count += usage->count[field].load(std::memory_order_relaxed);
+        }
+        usage->opLatencyHistogram.snapshot(&data->opLatencyHistogram);
+    }
+}
+
+size_t Top::_slot() const {
+    const auto slot = static_cast<size_t>(localThreadId + 1);
+    return slot < _slotCount ? slot : 0;
+}
+
+Top::SlotUsage* Top::_resolve(StringData ns, size_t slot) {
+    auto& cache = _slotCaches[slot];
+    auto it = cache.namespaces.find(ns);
+    if (it != cache.namespaces.end() && !it->second->dropped.load(std::memory_order_acquire)) {
+        return it->second->getSlot(slot);
+    }
+
+    std::shared_ptr<NamespaceUsage> usage;
+    {
+        std::scoped_lock<std::mutex> lock(_namespacesMutex);
+        auto& registered = _namespaces[ns];
+        if (!registered) {
+            registered = std::make_shared<NamespaceUsage>(_slotCount);
+        }
+        usage = registered;
+    }
+
+    if (cache.namespaces.size() >= cache.purgeAt) {
+        // Namespaces dropped and never recorded again would otherwise stay forever.
+        std::vector<std::string> dropped;
+        for (const auto& [name, cached] : cache.namespaces) {
+            if (cached->dropped.load(std::memory_order_relaxed)) {
+                dropped.push_back(name);
+            }
+        }
+        for (const auto& name : dropped) {
+            cache.namespaces.erase(name);
+        }
+        cache.purgeAt = std::max<size_t>(64, 2 * cache.namespaces.size());
+    }
+
+    auto slotUsage = usage->getSlot(slot);
+    cache.namespaces[ns] = std::move(usage);
+    return slotUsage;
+}
+
+std::shared_ptr<Top::NamespaceUsage> Top::_findNamespace(StringData ns) const {
+    std::scoped_lock<std::mutex> lock(_namespacesMutex);
+    auto it = _namespaces.find(ns);
+    return it != _namespaces.end() ? it->second : nullptr;
+}
+
 void Top::record(OperationContext* opCtx,
                  StringData ns,
                  LogicalOp logicalOp,
@@ -89,61 +200,69 @@ void Top::record(OperationContext* opCtx,
         return;
     }
 
-    auto hashedNs = UsageMap::HashedKey(ns);
-
-
-    if ((command || logicalOp == LogicalOp::opQuery) && ns == _lastDropped) {
+    if ((command || logicalOp == LogicalOp::opQuery) &&
+        _hasLastDropped.load(std::memory_order_relaxed)) {
         std::scoped_lock<std::mutex> lock(_lastDroppedMutex);
-        _lastDropped = "";
-        return;
+        if (ns == _lastDropped) {
+            _lastDropped = "";
+            _hasLastDropped.store(false, std::memory_order_relaxed);
+            return;
+        }
     }
 
-    int16_t id = localThreadId + 1;
-
-    std::scoped_lock<std::mutex> lock(_usageMutexVector[id]);
-    CollectionData& coll = _usageVector[id][hashedNs];
-    _record(opCtx, coll, logicalOp, lockType, micros, readWriteType);
+    const size_t slot = _slot();
+    std::unique_lock<std::mutex> sharedSlotLock;
+    if (slot == 0) {
+        sharedSlotLock = std::unique_lock<std::mutex>(_sharedSlotMutex);
+    }
+    _record(opCtx, *_resolve(ns, slot), logicalOp, lockType, micros, readWriteType);
 }
 
 void Top::_record(OperationContext* opCtx,
-                  CollectionData& c,
+                  SlotUsage& c,
                   LogicalOp logicalOp,
                   LockType lockType,
                   uint64_t micros,
                   Command::ReadWriteType readWriteType) {
+    if (_shouldIncrementHistogram(opCtx)) {
+        c.opLatencyHistogram.increment(micros, readWriteType, true);
+    }
 
-    _incrementHistogram(opCtx, micros, &c.opLatencyHistogram, readWriteType);
+    auto inc = [&](UsageField field) {
+        add(c.count[field], 1);
+        add(c.time[field], micros);
+    };
 
-    c.total.inc(micros);
+    inc(kTotal);
 
     if (lockType == LockType::WriteLocked)
-        c.writeLock.inc(micros);
+        inc(kWriteLock);
     else if (lockType == LockType::ReadLocked)
-        c.readLock.inc(micros);
+        inc(kReadLock);
 
     switch (logicalOp) {
         case LogicalOp::opInvalid:
             // use 0 for unknown, non-specific
             break;
         case LogicalOp::opUpdate:
-            c.update.inc(micros);
+            inc(kUpdate);
             break;
         case LogicalOp::opInsert:
-            c.insert.inc(micros);
+            inc(kInsert);
             break;
         case LogicalOp::opQuery:
-            c.queries.inc(micros);
+            inc(kQueries);
             break;
         case LogicalOp::opGetMore:
-            c.getmore.inc(micros);
+            inc(kGetmore);
             break;
         case LogicalOp::opDelete:
-            c.remove.inc(micros);
+            inc(kRemove);
             break;
         case LogicalOp::opKillCursors:
             break;
         case LogicalOp::opCommand:
-            c.commands.inc(micros);
+            inc(kCommands);
             break;
         default:
             MONGO_UNREACHABLE;
@@ -151,9 +270,13 @@ void Top::_record(OperationContext* opCtx,
 }
 
 void Top::collectionDropped(StringData ns, bool databaseDropped) {
-    for (size_t i = 0; i < _usageVector.size(); ++i) {
-        std::scoped_lock<std::mutex> lock(_usageMutexVector[i]);
-        _usageVector[i].erase(ns);
+    {
+        std::scoped_lock<std::mutex> lock(_namespacesMutex);
+        auto it = _namespaces.find(ns);
+        if (it != _namespaces.end()) {
+            it->second->dropped.store(true, std::memory_order_release);
+            _namespaces.erase(it);
+        }
     }
 
     if (!databaseDropped) {
@@ -161,6 +284,7 @@ void Top::collectionDropped(StringData ns, bool databaseDropped) {
         // collection namespace which must be ignored. This does not apply to a database drop.
         std::scoped_lock<std::mutex> lock(_lastDroppedMutex);
         _lastDropped = ns.toString();
+        _hasLastDropped.store(true, std::memory_order_relaxed);
     }
 }
 
@@ -215,11 +339,12 @@ void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const Usag
 }
 
 void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder) {
-    auto hashedNs = UsageMap::HashedKey(ns);
-    // stdx::lock_guard<SimpleMutex> lk(_lock);
     BSONObjBuilder latencyStatsBuilder;
-    UsageMap all = _mergeUsageVector();
-    all[hashedNs].opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    CollectionData coll;
+    if (auto usage = _findNamespace(ns)) {
+        usage->snapshot(&coll);
+    }
+    coll.opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
     builder->append("ns", ns);
     builder->append("latencyStats", latencyStatsBuilder.obj());
 }
@@ -227,56 +352,48 @@ void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuild
 void Top::incrementGlobalLatencyStats(OperationContext* opCtx,
                                       uint64_t latency,
                                       Command::ReadWriteType readWriteType) {
-    // stdx::lock_guard<SimpleMutex> guard(_lock);
-    // MONGO_UNREACHABLE;
-    int16_t id = localThreadId + 1;
-    std::scoped_lock<std::mutex> lk(_histogramMutexVector[id]);
-    _incrementHistogram(opCtx, latency, &_histogramVector[id], readWriteType);
+    if (_shouldIncrementHistogram(opCtx)) {
+        const size_t slot = _slot();
+        _histogramSlots[slot].histogram.increment(latency, readWriteType, slot != 0);
+    }
 }
 
 void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder) {
     OperationLatencyHistogram globalHistogramStats;
-
-    for (size_t i = 0; i < _histogramVector.size(); ++i) {
-        std::scoped_lock<std::mutex> lock(_histogramMutexVector[i]);
-        globalHistogramStats += _histogramVector[i];
+    for (size_t i = 0; i < _slotCount; ++i) {
+        _histogramSlots[i].histogram.snapshot(&globalHistogramStats);
     }
 
     globalHistogramStats.append(includeHistograms, builder);
 }
 
 void Top::incrementGlobalTransactionLatencyStats(uint64_t latency) {
-    // stdx::lock_guard<SimpleMutex> guard(_lock);
-    // MONGO_UNREACHABLE;
-    int16_t id = localThreadId + 1;
-    std::scoped_lock<std::mutex> lk(_histogramMutexVector[id]);
-    _histogramVector[id].increment(latency, Command::ReadWriteType::kTransaction);
+    const size_t slot = _slot();
+    _histogramSlots[slot].histogram.increment(
+        latency, Command::ReadWriteType::kTransaction, slot != 0);
 }
 
-void Top::_incrementHistogram(OperationContext* opCtx,
-                              uint64_t latency,
-                              OperationLatencyHistogram* histogram,
-                              Command::ReadWriteType readWriteType) {
+bool Top::_shouldIncrementHistogram(OperationContext* opCtx) const {
     // Only update histogram if operation came from a user.
     Client* client = opCtx->getClient();
-    if (client->isFromUserConnection() && !client->isInDirectClient()) {
-        histogram->increment(latency, readWriteType);
-    }
+    return client->isFromUserConnection() && !client->isInDirectClient();
 }
 
-Top::UsageMap Top::_mergeUsageVector() {
-    UsageMap all;
-    for (size_t i = 0; i < _usageVector.size(); ++i) {
-        std::scoped_lock<std::mutex> lock(_usageMutexVector[i]);
-        for (const auto& [k, v] : _usageVector[i]) {
-            if (all.find(k) == all.end()) {
-                all[k] = v;
-            } else {
-                all[k] += v;
-            }
+Top::UsageMap Top::_mergeUsageVector() const {
+    std::vector<std::pair<std::string, std::shared_ptr<NamespaceUsage>>> namespaces;
+    {
+        std::scoped_lock<std::mutex> lock(_namespacesMutex);
+        namespaces.reserve(_namespaces.size());
+        for (const auto& [ns, usage] : _namespaces) {
+            namespaces.emplace_back(ns, usage);
         }
     }
 
+    // The writers keep counting while the slots are read.
+    UsageMap all;
+    for (const auto& [ns, usage] : namespaces) {
+        usage->snapshot(&all[ns]);
+    }
     return all;
 }
 }  // namespace mongo
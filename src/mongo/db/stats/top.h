@@ -29,7 +29,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "mongo/db/server_options.h"
@@ -46,12 +50,17 @@ class ServiceContext;
 
 /**
  * tracks usage by collection
+ *
+ * Every thread group counts into slots only it writes, so recording takes no lock and no atomic
+ * read-modify-write. Threads outside thread groups share the first slot, which is written under a
+ * mutex. Readers add the slots up without stopping the writers.
  */
 class Top {
 public:
     static Top& get(ServiceContext* service);
 
-    Top() = default;
+    Top();
+    ~Top();
 
     struct UsageData {
         UsageData() : time(0), count(0) {}
@@ -152,31 +161,92 @@ public:
     void appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder);
 
 private:
+    enum UsageField {
+        kTotal,
+        kReadLock,
+        kWriteLock,
+        kQueries,
+        kGetmore,
+        kInsert,
+        kUpdate,
+        kRemove,
+        kCommands,
+        kUsageFieldCount,
+    };
+
+    // The usage of one namespace counted by one slot.
+    struct alignas(64) SlotUsage {
+        std::array<std::atomic<long long>, kUsageFieldCount> time{};
+        std::array<std::atomic<long long>, kUsageFieldCount> count{};
+        ConcurrentOperationLatencyHistogram opLatencyHistogram;
+    };
+
+    struct NamespaceUsage {
+        explicit NamespaceUsage(size_t slotCount);
+        ~NamespaceUsage();
+
+        /**
+         * Called by the writer of 'slot' only.
+         */
+        SlotUsage* getSlot(size_t slot);
+
+        void snapshot(CollectionData* data) const;
+
+        const size_t slotCount;
+        // Allocated the first time a slot records the namespace.
+        std::unique_ptr<std::atomic<SlotUsage*>[]> slots;
+        // Set once the collection is dropped, so that slots resolve the namespace again.
+        std::atomic<bool> dropped{false};
+    };
+
+    // Namespaces a slot already resolved. Only touched by the writer of the slot.
+    struct alignas(64) SlotCache {
+        StringMap<std::shared_ptr<NamespaceUsage>> namespaces;
+        // Size at which the dropped namespaces are purged.
+        size_t purgeAt = 64;
+    };
+
+    struct alignas(64) HistogramSlot {
+        ConcurrentOperationLatencyHistogram histogram;
+    };
+
+    size_t _slot() const;
+
+    SlotUsage* _resolve(StringData ns, size_t slot);
+
+    std::shared_ptr<NamespaceUsage> _findNamespace(StringData ns) const;
+
     void _appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const;
 
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
 
     void _record(OperationContext* opCtx,
-                 CollectionData& c,
+                 SlotUsage& c,
                  LogicalOp logicalOp,
                  LockType lockType,
                  uint64_t micros,
                  Command::ReadWriteType readWriteType);
 
-    void _incrementHistogram(OperationContext* opCtx,
-                             uint64_t latency,
-                             OperationLatencyHistogram* histogram,
-                             Command::ReadWriteType readWriteType);
+    bool _shouldIncrementHistogram(OperationContext* opCtx) const;
+
+    UsageMap _mergeUsageVector() const;
+
+    // The first slot is shared by the threads outside thread groups, the others belong to a
+    // thread group each.
+    const size_t _slotCount = serverGlobalParams.reservedThreadNum + 1;
 
-    UsageMap _mergeUsageVector();
+    std::unique_ptr<HistogramSlot[]> _histogramSlots;
 
-    std::vector<std::mutex> _histogramMutexVector{serverGlobalParams.reservedThreadNum + 1};
-    std::vector<OperationLatencyHistogram> _histogramVector{serverGlobalParams.reservedThreadNum +
-                                                            1};
+    std::unique_ptr<SlotCache[]> _slotCaches;
+    // Serializes the threads sharing the first slot.
+    std::mutex _sharedSlotMutex;
 
-    std::vector<std::mutex> _usageMutexVector{serverGlobalParams.reservedThreadNum + 1};
-    std::vector<UsageMap> _usageVector{serverGlobalParams.reservedThreadNum + 1};
+    // Every namespace recorded since it was last dropped. Only touched when a slot resolves a
+    // namespace for the first time, on drops and by readers.
+    mutable std::mutex _namespacesMutex;
+    StringMap<std::shared_ptr<NamespaceUsage>> _namespaces;
 
+    std::atomic<bool> _hasLastDropped{false};
     std::mutex _lastDroppedMutex;
     std::string _lastDropped;
 };
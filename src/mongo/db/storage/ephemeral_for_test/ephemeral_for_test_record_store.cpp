@@ -33,6 +33,9 @@
 
 #include "mongo/db/storage/ephemeral_for_test/ephemeral_for_test_record_store.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
@@ -125,19 +128,22 @@ private:
 
 class EphemeralForTestRecordStore::Cursor final : public SeekableRecordCursor {
 public:
-    Cursor(OperationContext* opCtx, const EphemeralForTestRecordStore& rs)
-        : _records(rs._data->records), _isCapped(rs.isCapped()) {}
+    Cursor(OperationContext* opCtx,
+           const EphemeralForTestRecordStore& rs,
+           const RecordId& start = RecordId(),
+           const RecordId& end = RecordId())
+        : _records(rs._data->records), _isCapped(rs.isCapped()), _start(start), _end(end) {}
 
     boost::optional<Record> next() final {
         if (_needFirstSeek) {
             _needFirstSeek = false;
-            _it = _records.begin();
+            _it = _start.isNull() ? _records.begin() : _records.lower_bound(_start);
         } else if (!_lastMoveWasRestore && _it != _records.end()) {
             ++_it;
         }
         _lastMoveWasRestore = false;
 
-        if (_it == _records.end())
+        if (_it == _records.end() || !_inRange(_it->first))
             return {};
         return {{_it->first, _it->second.toRecordData()}};
     }
@@ -146,7 +152,7 @@ public:
         _lastMoveWasRestore = false;
         _needFirstSeek = false;
         _it = _records.find(id);
-        if (_it == _records.end())
+        if (_it == _records.end() || !_inRange(_it->first))
             return {};
         return {{_it->first, _it->second.toRecordData()}};
     }
@@ -177,6 +183,10 @@ public:
     void reattachToOperationContext(OperationContext* opCtx) final {}
 
 private:
+    bool _inRange(const RecordId& id) const {
+        return (_start.isNull() || id >= _start) && (_end.isNull() || id < _end);
+    }
+
     Records::const_iterator _it;
     bool _needFirstSeek = true;
     bool _lastMoveWasRestore = false;
@@ -184,6 +194,10 @@ private:
 
     const EphemeralForTestRecordStore::Records& _records;
     const bool _isCapped;
+
+    // Range of RecordIds the cursor is limited to. Null means unbounded.
+    const RecordId _start;
+    const RecordId _end;
 };
 
 class EphemeralForTestRecordStore::ReverseCursor final : public SeekableRecordCursor {
@@ -547,6 +561,32 @@ std::unique_ptr<SeekableRecordCursor> EphemeralForTestRecordStore::getCursor(
     return stdx::make_unique<ReverseCursor>(opCtx, *this);
 }
 
+std::vector<RecordId> EphemeralForTestRecordStore::getPartitionBounds(OperationContext* opCtx,
+                                                                      size_t maxPartitions) const {
+    std::vector<RecordId> bounds;
+    const size_t numRecords = _data->records.size();
+    if (_isCapped || maxPartitions < 2 || numRecords < 2) {
+        return bounds;
+    }
+
+    const size_t partitions = std::min(maxPartitions, numRecords);
+    bounds.reserve(partitions - 1);
+    auto it = _data->records.begin();
+    size_t position = 0;
+    for (size_t i = 1; i < partitions; ++i) {
+        const size_t boundPosition = i * numRecords / partitions;
+        std::advance(it, boundPosition - position);
+        position = boundPosition;
+        bounds.push_back(it->first);
+    }
+    return bounds;
+}
+
+std::unique_ptr<RecordCursor> EphemeralForTestRecordStore::getRangeCursor(
+    OperationContext* opCtx, const RecordId& start, const RecordId& end) const {
+    return stdx::make_unique<Cursor>(opCtx, *this, start, end);
+}
+
 Status EphemeralForTestRecordStore::truncate(OperationContext* opCtx) {
     // Unlike other changes, TruncateChange mutates _data on construction to perform the
     // truncate
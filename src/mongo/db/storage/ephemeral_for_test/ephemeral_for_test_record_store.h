@@ -93,6 +93,13 @@ public:
     std::unique_ptr<SeekableRecordCursor> getCursor(OperationContext* opCtx,
                                                     bool forward) const final;
 
+    std::vector<RecordId> getPartitionBounds(OperationContext* opCtx,
+                                             size_t maxPartitions) const final;
+
+    std::unique_ptr<RecordCursor> getRangeCursor(OperationContext* opCtx,
+                                                 const RecordId& start,
+                                                 const RecordId& end) const final;
+
     virtual Status truncate(OperationContext* opCtx);
 
     virtual void cappedTruncateAfter(OperationContext* opCtx, RecordId end, bool inclusive);
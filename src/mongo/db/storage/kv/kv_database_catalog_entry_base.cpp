@@ -79,11 +79,7 @@ public:
             _dce->_engine->getEngine()->dropIdent(_opCtx, _ident).transitional_ignore();
         }
 
-        const CollectionCatalogMap::iterator it = _dce->_collections.find(_collection);
-        if (it != _dce->_collections.end()) {
-            // delete it->second;
-            _dce->_collections.erase(it);
-        }
+        _dce->_unpublish(_collection);
     }
 
     OperationContext* const _opCtx;
@@ -137,7 +133,22 @@ KVDatabaseCatalogEntryBase::~KVDatabaseCatalogEntryBase() {
     // {
     //     delete it->second;
     // }
-    _collections.clear();
+}
+
+std::shared_ptr<KVCollectionCatalogEntry> KVDatabaseCatalogEntryBase::_publish(
+    StringData ns, std::shared_ptr<KVCollectionCatalogEntry> entry) {
+    std::shared_ptr<KVCollectionCatalogEntry> published;
+    _collections.update([&](CollectionCatalogMap& collections) {
+        auto [iter, inserted] = collections.try_emplace(ns.toString(), std::move(entry));
+        published = iter->second;
+        return inserted;
+    });
+    return published;
+}
+
+void KVDatabaseCatalogEntryBase::_unpublish(StringData ns) {
+    _collections.update(
+        [&](CollectionCatalogMap& collections) { return collections.erase(ns) > 0; });
 }
 
 bool KVDatabaseCatalogEntryBase::exists() const {
@@ -146,8 +157,7 @@ bool KVDatabaseCatalogEntryBase::exists() const {
 }
 
 bool KVDatabaseCatalogEntryBase::isEmpty() const {
-    // std::scoped_lock<std::mutex> lk{_collectionsMutex};
-    return _collections.empty();
+    return _collections.get()->empty();
 }
 
 bool KVDatabaseCatalogEntryBase::hasUserData() const {
@@ -158,8 +168,8 @@ bool KVDatabaseCatalogEntryBase::hasUserData() const {
 int64_t KVDatabaseCatalogEntryBase::sizeOnDisk(OperationContext* opCtx) const {
     int64_t size = 0;
 
-    // std::scoped_lock<std::mutex> lk{_collectionsMutex};
-    for (const auto& _collection : _collections) {
+    auto collections = _collections.get();
+    for (const auto& _collection : *collections) {
         auto& coll = _collection.second;
         // if (!coll) {
         //     continue;
@@ -197,15 +207,28 @@ void KVDatabaseCatalogEntryBase::getCollectionNamespaces(std::vector<std::string
 
 CollectionCatalogEntry* KVDatabaseCatalogEntryBase::getCollectionCatalogEntry(
     OperationContext* opCtx, StringData ns) {
-    if (auto iter = _collections.find(ns.toString()); iter != _collections.end()) {
+    auto collections = _collections.get();
+    if (auto iter = collections->find(ns); iter != collections->end()) {
         return iter->second.get();
     } else {
         return createKVCollectionCatalogEntry(opCtx, ns);
     }
 }
 
+std::shared_ptr<CollectionCatalogEntry> KVDatabaseCatalogEntryBase::pinCollectionCatalogEntry(
+    OperationContext* opCtx, StringData ns) {
+    if (!createKVCollectionCatalogEntry(opCtx, ns)) {
+        return nullptr;
+    }
+    auto collections = _collections.get();
+    auto iter = collections->find(ns);
+    // Another thread group may have dropped the collection in between.
+    return iter != collections->end() ? iter->second : nullptr;
+}
+
 RecordStore* KVDatabaseCatalogEntryBase::getRecordStore(StringData ns) const {
-    if (auto iter = _collections.find(ns.toString()); iter != _collections.end()) {
+    auto collections = _collections.get();
+    if (auto iter = collections->find(ns); iter != collections->end()) {
         return iter->second->getRecordStore();
     }
     return nullptr;
@@ -276,18 +299,18 @@ Status KVDatabaseCatalogEntryBase::createCollection(OperationContext* opCtx,
     if (status.isOK()) {
         // Transaction which has created successfully in Monograph
         // create KVCollectionCatalogEntry directly here.
-        if (auto iter = _collections.find(nss.toStringData()); iter == _collections.end()) {
+        auto collections = _collections.get();
+        if (auto iter = collections->find(nss.toStringData()); iter == collections->end()) {
             // Create corresponding KVCollectionCatalogEntry on this node
             KVPrefix prefix = KVPrefix::getNextPrefix(nss);
             auto rs = _engine->getEngine()->getGroupedRecordStore(
                 opCtx, nss.toStringData(), nss.toStringData(), options, prefix);
-            _collections.try_emplace(
-                nss.toString(),
-                std::make_unique<KVCollectionCatalogEntry>(_engine->getEngine(),
-                                                           _engine->getCatalog(),
-                                                           nss.toStringData(),
-                                                           nss.toStringData(),
-                                                           std::move(rs)));
+            _publish(nss.toStringData(),
+                     std::make_shared<KVCollectionCatalogEntry>(_engine->getEngine(),
+                                                                _engine->getCatalog(),
+                                                                nss.toStringData(),
+                                                                nss.toStringData(),
+                                                                std::move(rs)));
         }
         return Status::OK();
     }
@@ -297,7 +320,8 @@ Status KVDatabaseCatalogEntryBase::createCollection(OperationContext* opCtx,
 CollectionCatalogEntry* KVDatabaseCatalogEntryBase::createKVCollectionCatalogEntry(
     OperationContext* opCtx, StringData ns) {
     MONGO_LOG(1) << "KVDatabaseCatalogEntryBase::createKVCollectionCatalogEntry";
-    if (auto iter = _collections.find(ns); iter != _collections.end()) {
+    auto collections = _collections.get();
+    if (auto iter = collections->find(ns); iter != collections->end()) {
         return iter->second.get();
     }
 
@@ -321,12 +345,12 @@ CollectionCatalogEntry* KVDatabaseCatalogEntryBase::createKVCollectionCatalogEnt
     auto ident = obj["ident"].checkAndGetStringData();
     auto rs = _engine->getEngine()->getGroupedRecordStore(opCtx, ns, ident, md.options, md.prefix);
 
-    auto [iter, success] = _collections.try_emplace(
-        ns.toString(),
-        std::make_unique<KVCollectionCatalogEntry>(
-            _engine->getEngine(), _engine->getCatalog(), ns, ns, std::move(rs)));
-
-    return iter->second.get();
+    // Metadata is read once per node, and a thread group which loses the race uses the entry
+    // published first.
+    return _publish(ns,
+                    std::make_shared<KVCollectionCatalogEntry>(
+                        _engine->getEngine(), _engine->getCatalog(), ns, ns, std::move(rs)))
+        .get();
 }
 
 void KVDatabaseCatalogEntryBase::initCollection(OperationContext* opCtx,
@@ -341,22 +365,18 @@ void KVDatabaseCatalogEntryBase::initCollection(OperationContext* opCtx,
     auto rs = _engine->getEngine()->getGroupedRecordStore(opCtx, ns, ident, md.options, md.prefix);
     invariant(rs);
 
-    // std::scoped_lock<std::mutex> lk{_collectionsMutex};
-    invariant(!_collections.count(ns));
-    _collections.try_emplace(
-        ns,
-        std::make_unique<KVCollectionCatalogEntry>(
-            _engine->getEngine(), _engine->getCatalog(), ns, ident, std::move(rs)));
+    invariant(!_collections.get()->count(ns));
+    _publish(ns,
+             std::make_shared<KVCollectionCatalogEntry>(
+                 _engine->getEngine(), _engine->getCatalog(), ns, ident, std::move(rs)));
 }
 
 void KVDatabaseCatalogEntryBase::reinitCollectionAfterRepair(OperationContext* opCtx,
                                                              const std::string& ns) {
     MONGO_UNREACHABLE;
     // Get rid of the old entry.
-    CollectionCatalogMap::iterator it = _collections.find(ns);
-    invariant(it != _collections.end());
-    // delete it->second;
-    _collections.erase(it);
+    invariant(_collections.get()->count(ns));
+    _unpublish(ns);
 
     // Now reopen fully initialized.
     initCollection(opCtx, ns, false);
@@ -371,15 +391,16 @@ Status KVDatabaseCatalogEntryBase::renameCollection(OperationContext* opCtx,
 
     RecordStore* originalRS = NULL;
 
-    CollectionCatalogMap::const_iterator it = _collections.find(fromNS.toString());
-    if (it == _collections.end()) {
+    auto collections = _collections.get();
+    auto it = collections->find(fromNS);
+    if (it == collections->end()) {
         return Status(ErrorCodes::NamespaceNotFound, "rename cannot find collection");
     }
 
     originalRS = it->second->getRecordStore();
 
-    it = _collections.find(toNS.toString());
-    if (it != _collections.end()) {
+    it = collections->find(toNS);
+    if (it != collections->end()) {
         return Status(ErrorCodes::NamespaceExists, "for rename to already exists");
     }
 
@@ -410,16 +431,14 @@ Status KVDatabaseCatalogEntryBase::renameCollection(OperationContext* opCtx,
     // a database consists of a single collection and that collection gets renamed (see
     // SERVER-34531). There is no locking to prevent listDatabases from looking into
     // _collections as a rename is taking place.
-    _collections.try_emplace(
-        toNS.toString(),
-        std::make_unique<KVCollectionCatalogEntry>(
-            _engine->getEngine(), _engine->getCatalog(), toNS, identTo, std::move(rs)));
+    _publish(toNS,
+             std::make_shared<KVCollectionCatalogEntry>(
+                 _engine->getEngine(), _engine->getCatalog(), toNS, identTo, std::move(rs)));
 
-    const CollectionCatalogMap::iterator itFrom = _collections.find(fromNS.toString());
-    invariant(itFrom != _collections.end());
+    invariant(_collections.get()->count(fromNS));
     // opCtx->recoveryUnit()->registerChange(
     //     new RemoveCollectionChange(opCtx, this, fromNS, identFrom, itFrom->second, false));
-    _collections.erase(itFrom);
+    _unpublish(fromNS);
 
     return Status::OK();
 }
@@ -427,7 +446,8 @@ Status KVDatabaseCatalogEntryBase::renameCollection(OperationContext* opCtx,
 Status KVDatabaseCatalogEntryBase::dropCollection(OperationContext* opCtx, StringData ns) {
     invariant(opCtx->lockState()->isDbLockedForMode(name(), MODE_X));
 
-    _collections.erase(ns.toString());
+    // Thread groups which still hold a handle on the collection keep the entry alive.
+    _unpublish(ns);
 
     Status status = _engine->getCatalog()->dropCollection(opCtx, ns);
     // always Status::OK();
@@ -33,6 +33,7 @@
 #include <memory>
 #include <string>
 
+#include "mongo/db/catalog/catalog_epoch.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 
 namespace mongo {
@@ -68,6 +69,9 @@ public:
     CollectionCatalogEntry* getCollectionCatalogEntry(OperationContext* opCtx,
                                                       StringData ns) override;
 
+    std::shared_ptr<CollectionCatalogEntry> pinCollectionCatalogEntry(OperationContext* opCtx,
+                                                                      StringData ns) override;
+
     RecordStore* getRecordStore(StringData ns) const override;
 
     IndexAccessMethod* getIndex(OperationContext* opCtx,
@@ -107,11 +111,20 @@ protected:
     class AddCollectionChange;
     class RemoveCollectionChange;
 
+    /**
+     * Publishes 'entry' unless another thread group published one for the same collection first,
+     * and returns the published one.
+     */
+    std::shared_ptr<KVCollectionCatalogEntry> _publish(
+        StringData ns, std::shared_ptr<KVCollectionCatalogEntry> entry);
+
+    void _unpublish(StringData ns);
 
     KVStorageEngine* const _engine;  // not owned here
+    // Shared by every thread group. Collection handles pin the entries they use, so dropping a
+    // collection does not free an entry another thread group still refers to.
     using CollectionCatalogMap =
-        std::map<std::string, std::unique_ptr<KVCollectionCatalogEntry>, std::less<void>>;
-    CollectionCatalogMap _collections;
-    // mutable std::mutex _collectionsMutex;
+        std::map<std::string, std::shared_ptr<KVCollectionCatalogEntry>, std::less<void>>;
+    CatalogSnapshot<CollectionCatalogMap> _collections;
 };
 }  // namespace mongo
\ No newline at end of file
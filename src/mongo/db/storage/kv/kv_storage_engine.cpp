@@ -56,7 +56,6 @@ namespace mongo {
 
 // using std::string;
 // using std::vector;
-extern thread_local int16_t localThreadId;
 
 namespace {
 const std::string catalogInfo = "_mdb_catalog";
@@ -240,19 +239,7 @@ void KVStorageEngine::loadCatalog(OperationContext* opCtx) {
         }
 
         // No rollback since this is only for committed dbs.
-        for (auto& dbMap : _dbMapVector) {
-            if (auto iter = dbMap.find(dbName); iter == dbMap.end()) {
-                auto [newIter, _] =
-                    dbMap.try_emplace(dbName, _databaseCatalogEntryFactory(dbName, this));
-                newIter->second->initCollection(opCtx, coll, _options.forRepair);
-            } else {
-                iter->second->initCollection(opCtx, coll, _options.forRepair);
-            }
-        }
-        // KVDatabaseCatalogEntryBase*& db = _dbs[dbName];
-        // if (!db) {
-        //     db = _databaseCatalogEntryFactory(dbName, this).release();
-        // }
+        getDatabaseCatalogEntry(opCtx, dbName)->initCollection(opCtx, coll, _options.forRepair);
 
         auto maxPrefixForCollection = _catalog->getMetaData(opCtx, coll).getMaxPrefix();
         maxSeenPrefix = std::max(maxSeenPrefix, maxPrefixForCollection);
@@ -278,11 +265,11 @@ void KVStorageEngine::closeCatalog(OperationContext* opCtx) {
         _dumpCatalog(opCtx);
     }
 
-    // stdx::lock_guard<stdx::mutex> lock(_dbsLock);
-    // for (auto entry : _dbMapVector) {
-    //     delete entry.second;
-    // }
-    _dbMapVector.clear();
+    // Operations which already found an entry keep using it until they finish.
+    _dbMap.update([](DBMap& dbMap) {
+        dbMap.clear();
+        return true;
+    });
 
     _catalog.reset(nullptr);
     _catalogRecordStore.reset(nullptr);
@@ -472,10 +459,9 @@ KVStorageEngine::reconcileCatalogAndIdents(OperationContext* opCtx) {
 }
 
 void KVStorageEngine::cleanShutdown() {
-    // for (DBMap::const_iterator it = _dbMapVector.begin(); it != _dbMapVector.end(); ++it) {
-    //     delete it->second;
-    // }
-    _dbMapVector.clear();
+    // The record stores must go before the engine shuts down, and no operation is left to use
+    // them.
+    _dbMap.resetUnsafe();
 
     _catalog.reset(nullptr);
     _catalogRecordStore.reset(nullptr);
@@ -535,23 +521,21 @@ void KVStorageEngine::listCollections(std::string_view dbName, std::set<std::str
 
 KVDatabaseCatalogEntryBase* KVStorageEngine::getDatabaseCatalogEntry(OperationContext* opCtx,
                                                                      StringData dbName) {
-    // stdx::lock_guard<stdx::mutex> lk(_dbsLock);
-    auto id = static_cast<int16_t>(localThreadId + 1);
-    auto& dbMap = _dbMapVector[id];
-    if (auto iter = dbMap.find(dbName); iter == dbMap.end()) {
-        auto [newIter, _] =
-            dbMap.try_emplace(dbName.toString(), _databaseCatalogEntryFactory(dbName, this));
-        return newIter->second.get();
-    } else {
+    auto dbMap = _dbMap.get();
+    if (auto iter = dbMap->find(dbName); iter != dbMap->end()) {
         return iter->second.get();
     }
 
-    // KVDatabaseCatalogEntryBase*& db = _dbs[dbName.toString()];
-    // if (!db) {
-    //     // Not registering change since db creation is implicit and never rolled back.
-    //     db = _databaseCatalogEntryFactory(dbName, this).release();
-    // }
-    // return db;
+    // Not registering change since db creation is implicit and never rolled back. The entry is
+    // built outside of the update, and dropped if another thread group published one first.
+    std::shared_ptr<KVDatabaseCatalogEntryBase> entry = _databaseCatalogEntryFactory(dbName, this);
+    KVDatabaseCatalogEntryBase* published = nullptr;
+    _dbMap.update([&](DBMap& next) {
+        auto [iter, inserted] = next.try_emplace(dbName.toString(), std::move(entry));
+        published = iter->second.get();
+        return inserted;
+    });
+    return published;
 }
 
 Status KVStorageEngine::closeDatabase(OperationContext* opCtx, StringData db) {
@@ -569,14 +553,7 @@ Status KVStorageEngine::dropDatabase(OperationContext* opCtx, StringData db) {
     //     entry = it->second;
     // }
 
-    auto id = static_cast<int16_t>(localThreadId + 1);
-    auto& dbMap = _dbMapVector[id];
-    KVDatabaseCatalogEntryBase* entry{nullptr};
-    if (auto iter = dbMap.find(db); iter == dbMap.end()) {
-        entry = _databaseCatalogEntryFactory(db, this).release();
-    } else {
-        entry = iter->second.get();
-    }
+    KVDatabaseCatalogEntryBase* entry = getDatabaseCatalogEntry(opCtx, db);
 
     std::vector<std::string> toDrop;
     entry->getCollectionNamespaces(toDrop);
@@ -37,6 +37,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/timestamp.h"
+#include "mongo/db/catalog/catalog_epoch.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/kv/kv_catalog.h"
@@ -235,10 +236,11 @@ private:
     std::unique_ptr<RecordStore> _catalogRecordStore;
     std::unique_ptr<KVCatalog> _catalog;
 
+    // Shared by every thread group. Entries are only removed by closeCatalog() and cleanShutdown(),
+    // so a Database handle may keep the raw entry pointer while the catalog is open.
     using DBMap =
-        std::map<std::string, std::unique_ptr<KVDatabaseCatalogEntryBase>, std::less<void>>;
-    std::vector<DBMap> _dbMapVector{1 + serverGlobalParams.reservedThreadNum};
-    // mutable stdx::mutex _dbsLock;
+        std::map<std::string, std::shared_ptr<KVDatabaseCatalogEntryBase>, std::less<void>>;
+    CatalogSnapshot<DBMap> _dbMap;
 
     // Flag variable that states if the storage engine is in backup mode.
     bool _inBackupMode = false;
@@ -283,6 +283,9 @@ class RecordStore {
     MONGO_DISALLOW_COPYING(RecordStore);
 
 public:
+    // Number of partitions the default getManyCursors() asks getPartitionBounds() for.
+    static constexpr size_t kManyCursorsMaxPartitions = 16;
+
     RecordStore(StringData ns) : _ns(ns.toString()) {}
 
     virtual ~RecordStore() {}
@@ -502,14 +505,50 @@ public:
     /**
      * Returns many RecordCursors that partition the RecordStore into many disjoint sets.
      * Iterating all returned RecordCursors is equivalent to iterating the full store.
+     *
+     * The default implementation returns one range cursor per partition of getPartitionBounds(),
+     * or a single cursor over the whole store if it cannot be split.
      */
     virtual std::vector<std::unique_ptr<RecordCursor>> getManyCursors(
         OperationContext* opCtx) const {
-        std::vector<std::unique_ptr<RecordCursor>> out(1);
-        out[0] = getCursor(opCtx);
+        std::vector<std::unique_ptr<RecordCursor>> out;
+        RecordId start;
+        for (auto&& end : getPartitionBounds(opCtx, kManyCursorsMaxPartitions)) {
+            out.push_back(getRangeCursor(opCtx, start, end));
+            start = end;
+        }
+        out.push_back(getRangeCursor(opCtx, start, RecordId()));
         return out;
     }
 
+    /**
+     * Returns at most 'maxPartitions' - 1 RecordIds, in increasing order, which split the store
+     * into key ranges holding roughly the same number of records. The ranges are meant to be
+     * scanned concurrently with getRangeCursor(). The bounds may be approximate, but together the
+     * ranges must cover every RecordId.
+     *
+     * An empty result means that the store cannot be split, which is what the default
+     * implementation returns.
+     */
+    virtual std::vector<RecordId> getPartitionBounds(OperationContext* opCtx,
+                                                     size_t maxPartitions) const {
+        return {};
+    }
+
+    /**
+     * Returns a forward cursor over the records whose RecordId is at least 'start' and less than
+     * 'end'. A null 'start' or 'end' leaves that side of the range open.
+     *
+     * Stores which override getPartitionBounds() must override this too. The default
+     * implementation only supports the range covering the whole store.
+     */
+    virtual std::unique_ptr<RecordCursor> getRangeCursor(OperationContext* opCtx,
+                                                         const RecordId& start,
+                                                         const RecordId& end) const {
+        invariant(start.isNull() && end.isNull());
+        return getCursor(opCtx);
+    }
+
     // higher level
 
 
@@ -113,5 +113,52 @@ TEST(RecordStoreTestHarness, GetManyIteratorsNonEmpty) {
     }
 }
 
+// Scan a nonempty record store through range cursors over its partitions, and verify that every
+// record is returned by exactly one of them and falls within its range.
+TEST(RecordStoreTestHarness, PartitionRangeCursorsNonEmpty) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    RecordId locs[nToInsert];
+    for (int i = 0; i < nToInsert; i++) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            stringstream ss;
+            ss << "record " << i;
+            string data = ss.str();
+
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            locs[i] = res.getValue();
+            uow.commit();
+        }
+    }
+
+    set<RecordId> remain(locs, locs + nToInsert);
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        vector<RecordId> bounds = rs->getPartitionBounds(opCtx.get(), 4);
+        ASSERT_LESS_THAN(bounds.size(), size_t(4));
+        bounds.push_back(RecordId());
+
+        RecordId start;
+        for (auto&& end : bounds) {
+            auto cursor = rs->getRangeCursor(opCtx.get(), start, end);
+            while (auto record = cursor->next()) {
+                ASSERT(start.isNull() || record->id >= start);
+                ASSERT(end.isNull() || record->id < end);
+                ASSERT_EQ(remain.erase(record->id), size_t(1));
+            }
+
+            ASSERT(!cursor->next());
+            start = end;
+        }
+        ASSERT(remain.empty());
+    }
+}
+
 }  // namespace
 }  // namespace mongo
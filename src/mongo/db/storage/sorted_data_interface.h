@@ -30,6 +30,7 @@
 #include <boost/optional/optional.hpp>
 #include <boost/optional/optional_io.hpp>
 #include <memory>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -102,6 +103,30 @@ public:
                           const RecordId& loc,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Insert every entry of 'entries' into the index in a single call, so that the storage engine
+     * can apply them together.
+     *
+     * Entries are inserted in order. On error, 'failedAt' is set to the position of the entry
+     * which failed and the error is returned; the entries before it were inserted and the ones
+     * after it were not.
+     *
+     * The default implementation inserts the entries one at a time.
+     */
+    virtual Status insertBatch(OperationContext* opCtx,
+                               const std::vector<IndexKeyEntry>& entries,
+                               bool dupsAllowed,
+                               size_t* failedAt) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            Status status = insert(opCtx, entries[i].key, entries[i].loc, dupsAllowed);
+            if (!status.isOK()) {
+                *failedAt = i;
+                return status;
+            }
+        }
+        return Status::OK();
+    }
+
     /**
      * Remove the entry from the index with the specified key and RecordId.
      *
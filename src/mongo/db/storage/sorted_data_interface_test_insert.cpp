@@ -31,6 +31,7 @@
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/unittest/unittest.h"
@@ -365,5 +366,52 @@ TEST(SortedDataInterface, InsertMultipleCompoundKeys) {
     }
 }
 
+// Insert several keys in one batch and verify that they are all in the index.
+TEST(SortedDataInterface, InsertBatch) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(true));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            const std::vector<IndexKeyEntry> entries{{key1, loc1}, {key2, loc2}, {key3, loc3}};
+            size_t failedAt = entries.size();
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(sorted->insertBatch(opCtx.get(), entries, false, &failedAt));
+            ASSERT_EQUALS(entries.size(), failedAt);
+            uow.commit();
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(3, sorted->numEntries(opCtx.get()));
+    }
+}
+
+// Insert a batch holding a duplicate key into a unique index and verify that the position of the
+// duplicate is reported.
+TEST(SortedDataInterface, InsertBatchReportsDuplicate) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(true));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            const std::vector<IndexKeyEntry> entries{{key1, loc1}, {key2, loc2}, {key2, loc3}};
+            size_t failedAt = entries.size();
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_EQUALS(ErrorCodes::DuplicateKey,
+                          sorted->insertBatch(opCtx.get(), entries, false, &failedAt));
+            ASSERT_EQUALS(2U, failedAt);
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT(sorted->isEmpty(opCtx.get()));
+    }
+}
+
 }  // namespace
 }  // namespace mongo
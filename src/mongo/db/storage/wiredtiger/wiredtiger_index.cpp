@@ -331,6 +331,33 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     return _insert(opCtx, c, key, id, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertBatch(OperationContext* opCtx,
+                                    const std::vector<IndexKeyEntry>& entries,
+                                    bool dupsAllowed,
+                                    size_t* failedAt) {
+    dassert(opCtx->lockState()->isWriteLocked());
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& entry = entries[i];
+        invariant(entry.loc.isNormal());
+        dassert(!hasFieldNames(entry.key));
+
+        Status s = checkKeySize(entry.key);
+        if (s.isOK()) {
+            s = _insert(opCtx, c, entry.key, entry.loc, dupsAllowed);
+        }
+        if (!s.isOK()) {
+            *failedAt = i;
+            return s;
+        }
+    }
+    return Status::OK();
+}
+
 void WiredTigerIndex::unindex(OperationContext* opCtx,
                               const BSONObj& key,
                               const RecordId& id,
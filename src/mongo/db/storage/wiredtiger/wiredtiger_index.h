@@ -95,6 +95,14 @@ public:
                           const RecordId& id,
                           bool dupsAllowed);
 
+    /**
+     * Inserts the entries through a single cursor, rather than opening one per entry.
+     */
+    virtual Status insertBatch(OperationContext* opCtx,
+                               const std::vector<IndexKeyEntry>& entries,
+                               bool dupsAllowed,
+                               size_t* failedAt);
+
     virtual void unindex(OperationContext* opCtx,
                          const BSONObj& key,
                          const RecordId& id,
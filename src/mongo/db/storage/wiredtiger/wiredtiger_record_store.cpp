@@ -37,6 +37,8 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <algorithm>
+
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/util/builder.h"
@@ -1433,11 +1435,40 @@ std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
     return getRandomCursorWithOptions(opCtx, extraConfig);
 }
 
-std::vector<std::unique_ptr<RecordCursor>> WiredTigerRecordStore::getManyCursors(
-    OperationContext* opCtx) const {
-    std::vector<std::unique_ptr<RecordCursor>> cursors(1);
-    cursors[0] = getCursor(opCtx, /*forward=*/true);
-    return cursors;
+std::vector<RecordId> WiredTigerRecordStore::getPartitionBounds(OperationContext* opCtx,
+                                                                size_t maxPartitions) const {
+    std::vector<RecordId> bounds;
+    const long long records = numRecords(opCtx);
+    if (_isCapped || maxPartitions < 2 || records < 2) {
+        return bounds;
+    }
+
+    auto first = getCursor(opCtx, /*forward=*/true)->next();
+    auto last = getCursor(opCtx, /*forward=*/false)->next();
+    if (!first || !last || first->id >= last->id) {
+        return bounds;
+    }
+
+    // Every partition spans at least one possible RecordId.
+    const std::uint64_t span = static_cast<std::uint64_t>(last->id.repr() - first->id.repr()) + 1;
+    const std::uint64_t partitions =
+        std::min({static_cast<std::uint64_t>(maxPartitions),
+                  static_cast<std::uint64_t>(records),
+                  span});
+    const std::uint64_t step = span / partitions;
+    bounds.reserve(partitions - 1);
+    for (std::uint64_t i = 1; i < partitions; ++i) {
+        bounds.emplace_back(first->id.repr() + static_cast<std::int64_t>(step * i));
+    }
+    return bounds;
+}
+
+std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRangeCursor(OperationContext* opCtx,
+                                                                    const RecordId& start,
+                                                                    const RecordId& end) const {
+    auto cursor = getCursor(opCtx, /*forward=*/true);
+    checked_cast<WiredTigerRecordStoreCursorBase*>(cursor.get())->setRange(start, end);
+    return std::move(cursor);
 }
 
 Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
@@ -1858,7 +1889,25 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
     WT_CURSOR* c = _cursor->get();
 
     RecordId id;
-    if (!_skipNextAdvance) {
+    if (_forward && _lastReturnedId.isNull() && !_rangeStart.isNull()) {
+        // The first record of a range is found by a search rather than from the beginning.
+        setKey(c, _rangeStart);
+        int cmp;
+        int seekRet =
+            wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+        if (seekRet == 0 && cmp < 0) {
+            seekRet = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->next(c); });
+        }
+        if (seekRet == WT_NOTFOUND) {
+            _eof = true;
+            return {};
+        }
+        invariantWTOK(seekRet);
+        if (hasWrongPrefix(c, &id)) {
+            _eof = true;
+            return {};
+        }
+    } else if (!_skipNextAdvance) {
         // Nothing after the next line can throw WCEs.
         // Note that an unpositioned (or eof) WT_CURSOR returns the first/last entry in the
         // table when you call next/prev.
@@ -1880,6 +1929,11 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
         id = getKey(c);
     }
 
+    if (!_rangeEnd.isNull() && id >= _rangeEnd) {
+        _eof = true;
+        return {};
+    }
+
     if (_forward && _lastReturnedId >= id) {
         log() << "WTCursor::next -- c->next_key ( " << id
               << ") was not greater than _lastReturnedId (" << _lastReturnedId
@@ -1918,6 +1972,13 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
 }
 
 
+void WiredTigerRecordStoreCursorBase::setRange(const RecordId& start, const RecordId& end) {
+    invariant(_forward);
+    invariant(_lastReturnedId.isNull());
+    _rangeStart = start;
+    _rangeEnd = end;
+}
+
 void WiredTigerRecordStoreCursorBase::save() {
     try {
         if (_cursor)
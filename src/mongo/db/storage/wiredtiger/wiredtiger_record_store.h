@@ -178,7 +178,16 @@ public:
     virtual std::unique_ptr<RecordCursor> getRandomCursorWithOptions(
         OperationContext* opCtx, StringData extraConfig) const = 0;
 
-    std::vector<std::unique_ptr<RecordCursor>> getManyCursors(OperationContext* opCtx) const final;
+    /**
+     * Splits the range between the first and the last RecordId evenly. RecordIds are handed out
+     * in increasing order, so the ranges hold about as many records unless many were deleted.
+     */
+    std::vector<RecordId> getPartitionBounds(OperationContext* opCtx,
+                                             size_t maxPartitions) const final;
+
+    std::unique_ptr<RecordCursor> getRangeCursor(OperationContext* opCtx,
+                                                 const RecordId& start,
+                                                 const RecordId& end) const final;
 
     virtual Status truncate(OperationContext* opCtx);
 
@@ -430,6 +439,12 @@ public:
 
     void reattachToOperationContext(OperationContext* opCtx);
 
+    /**
+     * Restricts a forward cursor to the records whose RecordId is at least 'start' and less than
+     * 'end'. A null bound leaves that side open. Must be called before the first call to next().
+     */
+    void setRange(const RecordId& start, const RecordId& end);
+
 protected:
     virtual RecordId getKey(WT_CURSOR* cursor) const = 0;
 
@@ -456,6 +471,8 @@ protected:
     boost::optional<WiredTigerCursor> _cursor;
     bool _eof = false;
     RecordId _lastReturnedId;  // If null, need to seek to first/last record.
+    RecordId _rangeStart;      // If not null, the first record is found by a search.
+    RecordId _rangeEnd;        // If not null, the cursor is at EOF from this record on.
 
 private:
     bool isVisible(const RecordId& id);
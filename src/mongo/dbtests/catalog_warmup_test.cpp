@@ -0,0 +1,150 @@
+/**
+ * This file tests db/catalog/catalog_warmup.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/catalog/catalog_warmup.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/map_util.h"
+
+namespace mongo {
+extern thread_local int16_t localThreadId;
+}  // namespace mongo
+
+namespace CatalogWarmUpTests {
+
+using catalog::CatalogWarmUpStats;
+using catalog::warmUpCatalog;
+
+static const NamespaceString nss1{"unittests.CatalogWarmUp1"};
+static const NamespaceString nss2{"unittests.CatalogWarmUp2"};
+
+/**
+ * Runs each task on one thread per thread group, which looks up the handles of that group.
+ */
+bool runOnEachThreadGroup(const stdx::function<void()>& task) {
+    std::vector<stdx::thread> threads;
+    for (size_t id = 0; id < serverGlobalParams.reservedThreadNum; ++id) {
+        threads.emplace_back([&task, id] {
+            localThreadId = static_cast<int16_t>(id);
+            task();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return true;
+}
+
+class Base {
+public:
+    Base() : _client(&_opCtx) {
+        setCatalogWarmUp(true);
+        for (const auto& nss : {nss1, nss2}) {
+            OldClientWriteContext ctx(&_opCtx, nss.ns());
+            _client.insert(nss.ns(), BSON("_id" << 1));
+        }
+    }
+
+    virtual ~Base() {
+        setCatalogWarmUp(false);
+        for (const auto& nss : {nss1, nss2}) {
+            OldClientWriteContext ctx(&_opCtx, nss.ns());
+            _client.dropCollection(nss.ns());
+        }
+    }
+
+protected:
+    static void setCatalogWarmUp(bool enabled) {
+        auto parameter = mapFindWithDefault(ServerParameterSet::getGlobal()->getMap(),
+                                            std::string("catalogWarmUp"),
+                                            static_cast<ServerParameter*>(nullptr));
+        invariant(parameter);
+        ASSERT_OK(parameter->setFromString(enabled ? "true" : "false"));
+    }
+
+    static void assertListed(const CatalogWarmUpStats& stats) {
+        ASSERT_GREATER_THAN_OR_EQUALS(stats.databases, 1U);
+        ASSERT_GREATER_THAN_OR_EQUALS(stats.collections, 2U);
+        ASSERT_EQUALS(stats.failed, 0U);
+    }
+
+    const ServiceContext::UniqueOperationContext _opCtxPtr = cc().makeOperationContext();
+    OperationContext& _opCtx = *_opCtxPtr;
+    DBDirectClient _client;
+};
+
+class WarmUpDisabled : public Base {
+public:
+    void run() {
+        setCatalogWarmUp(false);
+        auto stats = warmUpCatalog(&_opCtx, runOnEachThreadGroup);
+        ASSERT_EQUALS(stats.databases, 0U);
+        ASSERT_EQUALS(stats.collections, 0U);
+        ASSERT_EQUALS(stats.threadGroups, 0U);
+        ASSERT_EQUALS(stats.handles, 0U);
+    }
+};
+
+class WarmUpWithoutThreadGroups : public Base {
+public:
+    void run() {
+        auto stats = warmUpCatalog(&_opCtx, [](const stdx::function<void()>&) { return false; });
+        assertListed(stats);
+        ASSERT_EQUALS(stats.threadGroups, 1U);
+        ASSERT_EQUALS(stats.handles, stats.collections);
+    }
+};
+
+class WarmUpEveryThreadGroup : public Base {
+public:
+    void run() {
+        auto stats = warmUpCatalog(&_opCtx, runOnEachThreadGroup);
+        assertListed(stats);
+        ASSERT_EQUALS(stats.threadGroups, serverGlobalParams.reservedThreadNum);
+        ASSERT_EQUALS(stats.handles, stats.threadGroups * stats.collections);
+
+        // Every thread group finds the handles it built, rather than creating them.
+        AtomicWord<unsigned> hits{0};
+        runOnEachThreadGroup([&hits] {
+            Client::initThread("catalogWarmUpTest");
+            auto opCtx = cc().makeOperationContext();
+            Lock::DBLock dbLock(opCtx.get(), nss1.db(), MODE_X);
+            bool justCreated = true;
+            Database* db =
+                DatabaseHolder::getDatabaseHolder().openDb(opCtx.get(), nss1.db(), &justCreated);
+            if (!justCreated && db->getCollection(opCtx.get(), nss1) &&
+                db->getCollection(opCtx.get(), nss2)) {
+                hits.fetchAndAdd(1);
+            }
+        });
+        ASSERT_EQUALS(hits.load(), serverGlobalParams.reservedThreadNum);
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("CatalogWarmUp") {}
+
+    void setupTests() {
+        add<WarmUpDisabled>();
+        add<WarmUpWithoutThreadGroups>();
+        add<WarmUpEveryThreadGroup>();
+    }
+};
+
+SuiteInstance<All> all;
+}  // namespace CatalogWarmUpTests
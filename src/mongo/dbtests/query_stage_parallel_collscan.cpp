@@ -0,0 +1,226 @@
+/**
+ * This file tests db/exec/parallel_collection_scan.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+
+namespace QueryStageParallelCollectionScan {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+static const NamespaceString nss{"unittests.QueryStageParallelCollectionScan"};
+
+class QueryStageParallelCollectionScanBase {
+public:
+    QueryStageParallelCollectionScanBase() : _client(&_opCtx) {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+
+        for (int i = 0; i < numObj(); ++i) {
+            BSONObjBuilder bob;
+            bob.append("foo", i);
+            _client.insert(nss.ns(), bob.obj());
+        }
+    }
+
+    virtual ~QueryStageParallelCollectionScanBase() {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        _client.dropCollection(nss.ns());
+    }
+
+    /**
+     * Scans the collection split into at most 'maxPartitions' key ranges and returns the values
+     * of "foo" of the documents matching 'filterObj'. Each value must only be returned once.
+     */
+    std::set<int> scan(size_t maxPartitions, const BSONObj& filterObj) {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        auto bounds = collection->getRecordStore()->getPartitionBounds(&_opCtx, maxPartitions);
+        ASSERT_FALSE(bounds.empty());
+        ASSERT_LESS_THAN(bounds.size(), maxPartitions);
+
+        const CollatorInterface* collator = nullptr;
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(filterObj, expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        unique_ptr<WorkingSet> ws = make_unique<WorkingSet>();
+        unique_ptr<PlanStage> ps = make_unique<ParallelCollectionScan>(
+            &_opCtx, collection, std::move(bounds), ws.get(), filterExpr.get());
+
+        auto statusWithPlanExecutor = PlanExecutor::make(
+            &_opCtx, std::move(ws), std::move(ps), collection, PlanExecutor::NO_YIELD);
+        ASSERT_OK(statusWithPlanExecutor.getStatus());
+        auto exec = std::move(statusWithPlanExecutor.getValue());
+
+        std::set<int> found;
+        PlanExecutor::ExecState state;
+        for (BSONObj obj; PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL));) {
+            ASSERT(found.insert(obj["foo"].numberInt()).second);
+        }
+        ASSERT_EQUALS(PlanExecutor::IS_EOF, state);
+        return found;
+    }
+
+    /**
+     * Works 'scan' until it returned 'count' more documents, or to the end if 'count' is 0, and
+     * adds their values of "foo" to 'found'. Returns the state of the last call to work().
+     */
+    static PlanStage::StageState work(PlanStage* scan,
+                                      WorkingSet* ws,
+                                      size_t count,
+                                      std::set<int>* found) {
+        const size_t target = found->size() + count;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (!scan->isEOF() && (count == 0 || found->size() < target)) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = scan->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ASSERT(found->insert(ws->get(id)->obj.value()["foo"].numberInt()).second);
+            }
+        }
+        return state;
+    }
+
+    static size_t docsTested(PlanStage* scan) {
+        auto stats = scan->getStats();
+        return static_cast<const ParallelCollectionScanStats*>(stats->specific.get())->docsTested;
+    }
+
+    static int numObj() {
+        return 5000;
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _txnPtr = cc().makeOperationContext();
+    OperationContext& _opCtx = *_txnPtr;
+
+    DBDirectClient _client;
+};
+
+// Scan every document of a collection split into several key ranges.
+class QueryStageParallelCollscanAll : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), scan(4, BSONObj()).size());
+    }
+};
+
+// The workers apply a filter which is thread safe.
+class QueryStageParallelCollscanWithMatch : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        auto found = scan(4, fromjson("{foo: {$lt: 100}}"));
+        ASSERT_EQUALS(100U, found.size());
+        ASSERT_EQUALS(0, *found.begin());
+        ASSERT_EQUALS(99, *found.rbegin());
+    }
+};
+
+// The stage applies a filter which is not thread safe itself.
+class QueryStageParallelCollscanWithExprMatch : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        auto found = scan(4, fromjson("{$expr: {$lt: ['$foo', 100]}}"));
+        ASSERT_EQUALS(100U, found.size());
+        ASSERT_EQUALS(0, *found.begin());
+        ASSERT_EQUALS(99, *found.rbegin());
+    }
+};
+
+// A scan with more key ranges than workers still returns every document once.
+class QueryStageParallelCollscanManyPartitions : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), scan(64, BSONObj()).size());
+    }
+};
+
+// Saving the stage pauses its workers, and the scan carries on where it was once restored.
+class QueryStageParallelCollscanYield : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        Collection* collection = ctx.getCollection();
+        WorkingSet ws;
+        auto bounds = collection->getRecordStore()->getPartitionBounds(&_opCtx, 4);
+        ASSERT_FALSE(bounds.empty());
+        ParallelCollectionScan scan(&_opCtx, collection, std::move(bounds), &ws, nullptr);
+
+        std::set<int> found;
+        work(&scan, &ws, 100, &found);
+
+        scan.saveState();
+        const size_t tested = docsTested(&scan);
+        stdx::this_thread::sleep_for(Milliseconds(50).toSystemDuration());
+        ASSERT_EQUALS(tested, docsTested(&scan));
+        scan.restoreState();
+
+        ASSERT_EQUALS(PlanStage::IS_EOF, work(&scan, &ws, 0, &found));
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), found.size());
+    }
+};
+
+// Dropping the collection while the stage is saved kills it.
+class QueryStageParallelCollscanDropCollection : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        Collection* collection = ctx.getCollection();
+        WorkingSet ws;
+        auto bounds = collection->getRecordStore()->getPartitionBounds(&_opCtx, 4);
+        ASSERT_FALSE(bounds.empty());
+        ParallelCollectionScan scan(&_opCtx, collection, std::move(bounds), &ws, nullptr);
+
+        std::set<int> found;
+        work(&scan, &ws, 100, &found);
+
+        scan.saveState();
+        _client.dropCollection(nss.ns());
+        scan.restoreState();
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::DEAD, scan.work(&id));
+        ASSERT_EQUALS(ErrorCodes::QueryPlanKilled,
+                      WorkingSetCommon::getMemberStatus(*ws.get(id)).code());
+        ASSERT_TRUE(scan.isEOF());
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("QueryStageParallelCollectionScan") {}
+
+    void setupTests() {
+        add<QueryStageParallelCollscanAll>();
+        add<QueryStageParallelCollscanWithMatch>();
+        add<QueryStageParallelCollscanWithExprMatch>();
+        add<QueryStageParallelCollscanManyPartitions>();
+        add<QueryStageParallelCollscanYield>();
+        add<QueryStageParallelCollscanDropCollection>();
+    }
+};
+
+SuiteInstance<All> all;
+}  // namespace QueryStageParallelCollectionScan
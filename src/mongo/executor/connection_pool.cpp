@@ -198,10 +198,17 @@ private:
 
     void updateStateInLock();
 
+    /**
+     * Publishes a change in the size of the ready pool to the parent's lock-free hint.
+     */
+    void updateReadyHint();
+
 private:
     ConnectionPool* const _parent;
 
     const HostAndPort _hostAndPort;
+    const size_t _readyHintSlot;
+    size_t _readyHinted = 0;
 
     LRUOwnershipPool _readyPool;
     OwnershipPool _processingPool;
@@ -384,6 +391,15 @@ void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
     }
 }
 
+size_t ConnectionPool::getReadyConnectionsHint(const HostAndPort& hostAndPort) const {
+    auto ready = _readyHints[readyHintSlot(hostAndPort)].load(std::memory_order_relaxed);
+    return ready > 0 ? static_cast<size_t>(ready) : 0;
+}
+
+size_t ConnectionPool::readyHintSlot(const HostAndPort& hostAndPort) {
+    return std::hash<HostAndPort>()(hostAndPort) % kReadyHintSlots;
+}
+
 size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort) const {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
     auto iter = _pools.find(hostAndPort);
@@ -410,6 +426,7 @@ void ConnectionPool::returnConnection(ConnectionInterface* conn) {
 ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort)
     : _parent(parent),
       _hostAndPort(hostAndPort),
+      _readyHintSlot(readyHintSlot(hostAndPort)),
       _readyPool(std::numeric_limits<size_t>::max()),
       _requestTimer(parent->_factory->makeTimer()),
       _activeClients(0),
@@ -422,6 +439,8 @@ ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAnd
 ConnectionPool::SpecificPool::~SpecificPool() {
     DESTRUCTOR_GUARD(_requestTimer->cancelTimeout();)
 
+    _parent->_readyHints[_readyHintSlot].fetch_sub(_readyHinted, std::memory_order_relaxed);
+
     invariant(_requests.empty());
     invariant(_checkedOutPool.empty());
 }
@@ -561,6 +580,7 @@ void ConnectionPool::SpecificPool::addToReady(stdx::unique_lock<stdx::mutex>& lk
 
     // This makes the connection the new most-recently-used connection.
     _readyPool.add(connPtr, std::move(conn));
+    updateReadyHint();
 
     // Our strategy for refreshing connections is to check them out and
     // immediately check them back in (which kicks off the refresh logic in
@@ -573,6 +593,7 @@ void ConnectionPool::SpecificPool::addToReady(stdx::unique_lock<stdx::mutex>& lk
                             // ourselves.
                             if (!conn)
                                 return;
+                            updateReadyHint();
 
                             // If we're in shutdown, we don't need to refresh connections
                             if (_state == State::kInShutdown)
@@ -609,6 +630,7 @@ void ConnectionPool::SpecificPool::processFailure(const Status& status,
     // all of the connections and thus timers of which we have ownership.
     // In short, clearing the ready pool helps the SpecificPool drain.
     _readyPool.clear();
+    updateReadyHint();
 
     // Log something helpful
     log() << "Dropping all pooled connections to " << _hostAndPort << " due to " << status;
@@ -662,6 +684,7 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
         // Grab the connection and cancel its timeout
         auto conn = std::move(iter->second);
         _readyPool.erase(iter);
+        updateReadyHint();
         conn->cancelTimeout();
 
         if (!conn->isHealthy()) {
@@ -799,6 +822,14 @@ ConnectionPool::SpecificPool::OwnedConnection ConnectionPool::SpecificPool::take
 }
 
 
+void ConnectionPool::SpecificPool::updateReadyHint() {
+    auto ready = _readyPool.size();
+    _parent->_readyHints[_readyHintSlot].fetch_add(static_cast<int64_t>(ready) -
+                                                       static_cast<int64_t>(_readyHinted),
+                                                   std::memory_order_relaxed);
+    _readyHinted = ready;
+}
+
 // Updates our state and manages the request timer
 void ConnectionPool::SpecificPool::updateStateInLock() {
     if (_state == State::kInShutdown) {
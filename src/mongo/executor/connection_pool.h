@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <queue>
 
@@ -129,6 +131,20 @@ public:
          * The manager will hold this pool for the lifetime of the pool.
          */
         EgressTagCloserManager* egressTagCloserManager = nullptr;
+
+        /**
+         * The number of independent pools, each with its own lock and reactor, a
+         * NetworkInterfaceTL spreads its connections over. The connection limits above apply to
+         * the sum of all shards.
+         */
+        size_t shards = 1;
+
+        /**
+         * The number of commands a NetworkInterfaceTL may have in flight on one connection at
+         * a time. Beyond one, commands are pipelined and a connection stays checked out of the
+         * pool while any command uses it.
+         */
+        size_t pipelinedRequestsPerConnection = 1;
     };
 
     explicit ConnectionPool(std::shared_ptr<DependentTypeFactoryInterface> impl,
@@ -154,7 +170,17 @@ public:
 
     size_t getNumConnectionsPerHost(const HostAndPort& hostAndPort) const;
 
+    /**
+     * Returns, without taking the pool lock, a hint of how many idle connections to the host
+     * are ready for checkout. Hosts may share a counter, so the hint can overestimate.
+     */
+    size_t getReadyConnectionsHint(const HostAndPort& hostAndPort) const;
+
 private:
+    static constexpr size_t kReadyHintSlots = 64;
+
+    static size_t readyHintSlot(const HostAndPort& hostAndPort);
+
     void returnConnection(ConnectionInterface* connection);
 
     std::string _name;
@@ -169,6 +195,9 @@ private:
     mutable stdx::mutex _mutex;
     stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> _pools;
 
+    // Ready connections of the hosts hashing to each slot, written under _mutex.
+    std::array<std::atomic<int64_t>, kReadyHintSlots> _readyHints{};
+
     EgressTagCloserManager* _manager;
 };
 
@@ -47,7 +47,7 @@ public:
 
     TLTypeFactory(transport::ReactorHandle reactor,
                   transport::TransportLayer* tl,
-                  std::unique_ptr<NetworkConnectionHook> onConnectHook)
+                  std::shared_ptr<NetworkConnectionHook> onConnectHook)
         : _reactor(std::move(reactor)), _tl(tl), _onConnectHook(std::move(onConnectHook)) {}
 
     std::shared_ptr<ConnectionPool::ConnectionInterface> makeConnection(
@@ -64,7 +64,8 @@ public:
 private:
     transport::ReactorHandle _reactor;
     transport::TransportLayer* _tl;
-    std::unique_ptr<NetworkConnectionHook> _onConnectHook;
+    // Shared by the factories of every pool shard of a NetworkInterfaceTL.
+    std::shared_ptr<NetworkConnectionHook> _onConnectHook;
 
     mutable stdx::mutex _mutex;
     AtomicBool _inShutdown{false};
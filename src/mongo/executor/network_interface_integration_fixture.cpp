@@ -46,8 +46,7 @@ namespace mongo {
 namespace executor {
 
 void NetworkInterfaceIntegrationFixture::startNet(
-    std::unique_ptr<NetworkConnectionHook> connectHook) {
-    ConnectionPool::Options options;
+    std::unique_ptr<NetworkConnectionHook> connectHook, ConnectionPool::Options options) {
 #ifdef _WIN32
     // Connections won't queue on widnows, so attempting to open too many connections
     // concurrently will result in refused connections and test failure.
@@ -32,11 +32,13 @@
 
 #include <algorithm>
 #include <exception>
+#include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/commands/test_commands_enabled.h"
 #include "mongo/db/wire_version.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface_integration_fixture.h"
 #include "mongo/executor/test_network_connection_hook.h"
@@ -72,6 +74,65 @@ TEST_F(NetworkInterfaceIntegrationFixture, Ping) {
     assertCommandOK("admin", BSON("ping" << 1));
 }
 
+TEST_F(NetworkInterfaceIntegrationFixture, PipelinedPings) {
+    ConnectionPool::Options options;
+    options.pipelinedRequestsPerConnection = 8;
+    startNet(nullptr, std::move(options));
+
+    // More commands than fit on one connection, all in flight at once.
+    std::vector<Future<RemoteCommandResponse>> responses;
+    for (int i = 0; i < 64; ++i) {
+        RemoteCommandRequest request{
+            fixture().getServers()[0], "admin", BSON("ping" << i), BSONObj(), nullptr, Minutes(5)};
+        responses.push_back(runCommand(makeCallbackHandle(), std::move(request)));
+    }
+
+    for (auto& response : responses) {
+        auto res = response.get();
+        uassertStatusOK(res.status);
+        ASSERT_EQ(res.data.getIntField("ok"), 1);
+    }
+
+    // Commands which found no room wait for the connections being opened instead of each opening
+    // its own.
+    ConnectionPoolStats stats;
+    net().appendConnectionStats(&stats);
+    ASSERT_LTE(stats.totalCreated, 64U / 8);
+}
+
+TEST_F(NetworkInterfaceIntegrationFixture, PipelinedConnectionFailsWhenStalled) {
+    ConnectionPool::Options options;
+    options.pipelinedRequestsPerConnection = 8;
+    startNet(nullptr, std::move(options));
+
+    RemoteCommandRequest sleep{fixture().getServers()[0],
+                               "admin",
+                               BSON("sleep" << 1 << "lock"
+                                            << "none"
+                                            << "secs"
+                                            << 10),
+                               BSONObj(),
+                               nullptr,
+                               Milliseconds(100)};
+    auto res = runCommandSync(sleep);
+    if (pingCommandMissing(res)) {
+        return;
+    }
+    ASSERT_EQ(ErrorCodes::NetworkInterfaceExceededTimeLimit, res.status);
+
+    // No reply arrived since the sleep was sent, so the ping does not queue up behind it on the
+    // same connection but gets a new one.
+    RemoteCommandRequest ping{
+        fixture().getServers()[0], "admin", BSON("ping" << 1), BSONObj(), nullptr, Seconds(5)};
+    res = runCommandSync(ping);
+    uassertStatusOK(res.status);
+    ASSERT_EQ(res.data.getIntField("ok"), 1);
+
+    ConnectionPoolStats stats;
+    net().appendConnectionStats(&stats);
+    ASSERT_EQ(stats.totalCreated, 2U);
+}
+
 // Hook that intentionally never finishes
 class HangingHook : public executor::NetworkConnectionHook {
     Status validateHost(const HostAndPort&,
@@ -30,18 +30,19 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <exception>
+#include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/client/connection_string.h"
-#include "mongo/executor/async_stream_factory.h"
-#include "mongo/executor/async_stream_interface.h"
-#include "mongo/executor/async_timer_asio.h"
-#include "mongo/executor/network_interface_asio.h"
-#include "mongo/executor/network_interface_asio_test_utils.h"
+#include "mongo/executor/connection_pool.h"
+#include "mongo/executor/network_interface_factory.h"
+#include "mongo/executor/network_interface_integration_fixture.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/integration_test.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
@@ -55,6 +56,7 @@ namespace executor {
 namespace {
 
 const std::size_t numOperations = 16384;
+const std::size_t numClientThreads = 32;
 
 
 int timeNetworkTestMillis(std::size_t operations, NetworkInterface* net) {
@@ -98,15 +100,63 @@ int timeNetworkTestMillis(std::size_t operations, NetworkInterface* net) {
     return t.millis();
 }
 
-TEST(NetworkInterfaceASIO, SerialPerf) {
-    NetworkInterfaceASIO::Options options{};
-    options.streamFactory = stdx::make_unique<AsyncStreamFactory>();
-    options.timerFactory = stdx::make_unique<AsyncTimerFactoryASIO>();
-    NetworkInterfaceASIO netAsio{std::move(options)};
+/**
+ * Runs 'operations' pings split over 'threads' client threads, each waiting for its previous ping
+ * before sending the next one. Every ping checks a connection out of the pool and returns it, so
+ * the threads contend on checkout rather than on the network.
+ */
+int timeConcurrentNetworkTestMillis(std::size_t operations,
+                                    std::size_t threads,
+                                    NetworkInterface* net) {
+    net->startup();
+    auto guard = MakeGuard([&] { net->shutdown(); });
+
+    auto fixture = unittest::getFixtureConnectionString();
+    auto server = fixture.getServers()[0];
+    const auto bsonObjPing = BSON("ping" << 1);
+
+    Timer t;
+    std::vector<stdx::thread> clients;
+    for (std::size_t i = 0; i < threads; ++i) {
+        clients.emplace_back([&] {
+            for (std::size_t op = 0; op < operations / threads; ++op) {
+                RemoteCommandRequest request{
+                    server, "admin", bsonObjPing, BSONObj(), nullptr, Milliseconds(-1)};
+                uassertStatusOK(net->startCommand(makeCallbackHandle(), request).get().status);
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
 
-    int duration = timeNetworkTestMillis(numOperations, &netAsio);
+    return t.millis();
+}
+
+std::unique_ptr<NetworkInterface> makePerfNetworkInterface(std::size_t shards) {
+    ConnectionPool::Options options;
+    options.maxConnections = 256u;
+    options.shards = shards;
+    return makeNetworkInterface("NetworkInterfacePerfTest", nullptr, nullptr, std::move(options));
+}
+
+TEST(NetworkInterfaceTL, SerialPerf) {
+    auto net = makePerfNetworkInterface(1);
+
+    int duration = timeNetworkTestMillis(numOperations, net.get());
     int result = numOperations * 1000 / duration;
-    log() << "THROUGHPUT asio ping ops/s: " << result;
+    log() << "THROUGHPUT tl ping ops/s: " << result;
+}
+
+TEST(NetworkInterfaceTL, CheckoutContentionPerf) {
+    for (std::size_t shards : {1, 4, 16}) {
+        auto net = makePerfNetworkInterface(shards);
+
+        int duration = timeConcurrentNetworkTestMillis(numOperations, numClientThreads, net.get());
+        int result = numOperations * 1000 / std::max(duration, 1);
+        log() << "THROUGHPUT tl ping ops/s with " << numClientThreads << " client threads and "
+              << shards << " pool shards: " << result;
+    }
 }
 
 }  // namespace
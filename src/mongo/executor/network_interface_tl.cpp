@@ -32,6 +32,10 @@
 
 #include "mongo/executor/network_interface_tl.h"
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+
 #include "mongo/db/commands/test_commands_enabled.h"
 #include "mongo/db/server_options.h"
 #include "mongo/executor/connection_pool_tl.h"
@@ -41,6 +45,9 @@
 #include "mongo/util/net/socket_utils.h"
 
 namespace mongo {
+
+extern thread_local int16_t localThreadId;
+
 namespace executor {
 
 NetworkInterfaceTL::NetworkInterfaceTL(std::string instanceName,
@@ -63,12 +70,17 @@ std::string NetworkInterfaceTL::getDiagnosticString() {
 }
 
 void NetworkInterfaceTL::appendConnectionStats(ConnectionPoolStats* stats) const {
-    auto pool = [&] {
+    auto pools = [&] {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
-        return _pool.get();
+        std::vector<ConnectionPool*> pools;
+        for (const auto& shard : _shards) {
+            pools.push_back(shard->pool.get());
+        }
+        return pools;
     }();
-    if (pool)
+    for (auto pool : pools) {
         pool->appendConnectionStats(stats);
+    }
 }
 
 NetworkInterface::Counters NetworkInterfaceTL::getCounters() const {
@@ -94,44 +106,106 @@ void NetworkInterfaceTL::startup() {
         _tl = _ownedTransportLayer.get();
     }
 
-    _reactor = _tl->getReactor(transport::TransportLayer::kNewReactor);
-    auto typeFactory = std::make_unique<connection_pool_tl::TLTypeFactory>(
-        _reactor, _tl, std::move(_onConnectHook));
-    _pool = std::make_unique<ConnectionPool>(
-        std::move(typeFactory), std::string("NetworkInterfaceTL-") + _instanceName, _connPoolOpts);
-    _ioThread = stdx::thread([this] {
-        setThreadName(_instanceName);
-        _run();
-    });
+    // The connection limits are split exactly: every shard gets limit / shardCount, and the first
+    // limit % shardCount shards one more. There are never more shards than the maximum number of
+    // connections, so that every shard can open at least one. Only maxConnecting is at least one
+    // per shard, since a shard which may not set up connections could never open any.
+    const size_t shardCount =
+        std::max<size_t>(std::min(_connPoolOpts.shards, _connPoolOpts.maxConnections), 1);
+    auto split = [shardCount](size_t limit, size_t shardIndex) {
+        if (limit == std::numeric_limits<size_t>::max()) {
+            return limit;
+        }
+        return limit / shardCount + (shardIndex < limit % shardCount ? 1 : 0);
+    };
+
+    std::shared_ptr<NetworkConnectionHook> onConnectHook = std::move(_onConnectHook);
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shardOpts = _connPoolOpts;
+        shardOpts.minConnections = split(_connPoolOpts.minConnections, i);
+        shardOpts.maxConnections = split(_connPoolOpts.maxConnections, i);
+        shardOpts.maxConnecting = std::max<size_t>(split(_connPoolOpts.maxConnecting, i), 1);
+
+        auto shard = std::make_unique<PoolShard>();
+        shard->reactor = _tl->getReactor(transport::TransportLayer::kNewReactor);
+        auto typeFactory = std::make_unique<connection_pool_tl::TLTypeFactory>(
+            shard->reactor, _tl, onConnectHook);
+        shard->pool = std::make_unique<ConnectionPool>(
+            std::move(typeFactory), std::string("NetworkInterfaceTL-") + _instanceName, shardOpts);
+        _shards.push_back(std::move(shard));
+    }
+    _reactor = _shards.front()->reactor;
+
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = _shards[i].get();
+        auto threadName = shardCount == 1 ? _instanceName : _instanceName + "-" + std::to_string(i);
+        shard->ioThread = stdx::thread([this, shard, threadName] {
+            setThreadName(threadName);
+            _run(shard);
+        });
+    }
 }
 
-void NetworkInterfaceTL::_run() {
+void NetworkInterfaceTL::_run(PoolShard* shard) {
     LOG(2) << "The NetworkInterfaceTL reactor thread is spinning up";
 
     // This returns when the reactor is stopped in shutdown()
-    _reactor->run();
+    shard->reactor->run();
 
     // Note that the pool will shutdown again when the ConnectionPool dtor runs
     // This prevents new timers from being set, calls all cancels via the factory registry, and
     // destructs all connections for all existing pools.
-    _pool->shutdown();
+    shard->pool->shutdown();
 
     // Close out all remaining tasks in the reactor now that they've all been canceled.
-    _reactor->drain();
+    shard->reactor->drain();
 
     LOG(2) << "NetworkInterfaceTL shutdown successfully";
 }
 
+NetworkInterfaceTL::PoolShard* NetworkInterfaceTL::_pickShard(const HostAndPort& target) {
+    const size_t shardCount = _shards.size();
+    if (shardCount == 1) {
+        return _shards.front().get();
+    }
+
+    // Threads of a coroutine thread group share a shard, other threads are spread by id.
+    size_t home = localThreadId >= 0
+        ? static_cast<size_t>(localThreadId)
+        : std::hash<stdx::thread::id>()(stdx::this_thread::get_id());
+    home %= shardCount;
+
+    auto shard = _shards[home].get();
+    if (shard->pool->getReadyConnectionsHint(target) > 0) {
+        return shard;
+    }
+
+    // Borrow an idle connection from another shard rather than open a new one.
+    for (size_t i = 1; i < shardCount; ++i) {
+        auto other = _shards[(home + i) % shardCount].get();
+        if (other->pool->getReadyConnectionsHint(target) > 0) {
+            LOG(3) << "Borrowing a connection to " << target << " from pool shard "
+                   << (home + i) % shardCount;
+            return other;
+        }
+    }
+    return shard;
+}
+
 void NetworkInterfaceTL::shutdown() {
     if (_inShutdown.swap(true))
         return;
 
     LOG(2) << "Shutting down network interface.";
 
-    // Stop the reactor/thread first so that nothing runs on a partially dtor'd pool.
-    _reactor->stop();
+    // Stop the reactors/threads first so that nothing runs on a partially dtor'd pool.
+    for (auto& shard : _shards) {
+        shard->reactor->stop();
+    }
 
-    _ioThread.join();
+    for (auto& shard : _shards) {
+        shard->ioThread.join();
+    }
 }
 
 bool NetworkInterfaceTL::inShutdown() const {
@@ -209,6 +283,11 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
         return Status::OK();
     }
 
+    if (_connPoolOpts.pipelinedRequestsPerConnection > 1) {
+        _startPipelinedCommand(state, std::move(pf.future), onFinish, baton);
+        return Status::OK();
+    }
+
     // Interacting with the connection pool can involve more work than just getting a connection
     // out.  In particular, we can end up having to spin up new connections, and fulfilling promises
     // for other requesters.  Returning connections has the same issue.
@@ -219,19 +298,20 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
     // return on the reactor thread.
     //
     // TODO: get rid of this cruft once we have a connection pool that's executor aware.
-    auto connFuture = _reactor->execute([this, state, request, baton] {
+    auto shard = _pickShard(request.target);
+    auto connFuture = shard->reactor->execute([shard, state, request, baton] {
         return makeReadyFutureWith(
-                   [this, request] { return _pool->get(request.target, request.timeout); })
+                   [shard, request] { return shard->pool->get(request.target, request.timeout); })
             .tapError([state](Status error) {
                 LOG(2) << "Failed to get connection from pool for request " << state->request.id
                        << ": " << error;
             })
-            .then([this, baton](ConnectionPool::ConnectionHandle conn) {
+            .then([shard, baton](ConnectionPool::ConnectionHandle conn) {
                 auto deleter = conn.get_deleter();
 
                 // TODO: drop out this shared_ptr once we have a unique_function capable future
                 return std::make_shared<CommandState::ConnHandle>(
-                    conn.release(), CommandState::Deleter{deleter, _reactor});
+                    conn.release(), CommandState::Deleter{deleter, shard->reactor});
             });
     });
 
@@ -324,7 +404,7 @@ Future<RemoteCommandResponse> NetworkInterfaceTL::_onAcquireConn(
                                     << state->request.timeout);
         }
 
-        state->timer = _reactor->makeTimer();
+        state->timer = state->conn.get_deleter().reactor->makeTimer();
         state->timer->waitUntil(state->deadline, baton)
             .getAsync([this, client, state, baton](Status status) {
                 if (status == ErrorCodes::CallbackCanceled) {
@@ -398,6 +478,262 @@ Future<RemoteCommandResponse> NetworkInterfaceTL::_onAcquireConn(
     return future;
 }
 
+void NetworkInterfaceTL::_startPipelinedCommand(std::shared_ptr<CommandState> state,
+                                                Future<RemoteCommandResponse> future,
+                                                const RemoteCommandCompletionFn& onFinish,
+                                                const transport::BatonHandle& baton) {
+    auto shard = _pickShard(state->request.target);
+    shard->reactor
+        ->execute([this, shard, state] {
+            return _acquirePipelinedConnection(shard, state->request);
+        })
+        .getAsync([this, shard, state](
+            StatusWith<std::shared_ptr<PipelinedConnection>> swConn) {
+            if (!swConn.isOK()) {
+                LOG(2) << "Failed to get connection from pool for request " << state->request.id
+                       << ": " << swConn.getStatus();
+                _eraseInUseConn(state->cbHandle);
+                if (!state->done.swap(true)) {
+                    state->promise.setError(swConn.getStatus());
+                }
+                return;
+            }
+            _runPipelinedCommand(shard, state, std::move(swConn.getValue()));
+        });
+
+    std::move(future)
+        .onError([](Status error) -> StatusWith<RemoteCommandResponse> {
+            // The TransportLayer has, for historical reasons returned SocketException for
+            // network errors, but sharding assumes HostUnreachable on network errors.
+            if (error == ErrorCodes::SocketException) {
+                error = Status(ErrorCodes::HostUnreachable, error.reason());
+            }
+            return error;
+        })
+        .getAsync([this, state, onFinish, baton](StatusWith<RemoteCommandResponse> response) {
+            auto finish = [this, state, onFinish, response = std::move(response)] {
+                auto duration = now() - state->start;
+                if (!response.isOK()) {
+                    onFinish(RemoteCommandResponse(response.getStatus(), duration));
+                } else {
+                    const auto& rs = response.getValue();
+                    LOG(2) << "Request " << state->request.id << " finished with response: "
+                           << redact(rs.isOK() ? rs.data.toString() : rs.status.toString());
+                    onFinish(rs);
+                }
+            };
+
+            if (baton) {
+                baton->schedule(std::move(finish));
+            } else {
+                finish();
+            }
+        });
+}
+
+Future<std::shared_ptr<NetworkInterfaceTL::PipelinedConnection>>
+NetworkInterfaceTL::_acquirePipelinedConnection(PoolShard* shard,
+                                                const RemoteCommandRequest& request) {
+    auto pending = std::make_shared<PendingPipelinedConnection>();
+    {
+        stdx::lock_guard<stdx::mutex> lk(shard->pipelineMutex);
+        auto& conns = shard->pipelined[request.target];
+        std::shared_ptr<PipelinedConnection> best;
+        for (const auto& pconn : conns) {
+            if (!pconn->failed &&
+                pconn->inFlight < _connPoolOpts.pipelinedRequestsPerConnection &&
+                (!best || pconn->inFlight < best->inFlight)) {
+                best = pconn;
+            }
+        }
+        if (best) {
+            ++best->inFlight;
+            return Future<std::shared_ptr<PipelinedConnection>>::makeReady(std::move(best));
+        }
+
+        // Concurrent misses share the connection already being checked out while it has room.
+        auto& accepting = shard->pendingPipelined[request.target];
+        if (accepting &&
+            accepting->waiters.size() + 1 < _connPoolOpts.pipelinedRequestsPerConnection) {
+            auto pf = makePromiseFuture<std::shared_ptr<PipelinedConnection>>();
+            accepting->waiters.push_back(std::move(pf.promise));
+            return std::move(pf.future);
+        }
+        accepting = pending;
+    }
+
+    return shard->pool->get(request.target, request.timeout)
+        .then([this, shard, pending, target = request.target](
+            ConnectionPool::ConnectionHandle conn) {
+            auto deleter = conn.get_deleter();
+            auto pconn = std::make_shared<PipelinedConnection>();
+            pconn->conn = CommandState::ConnHandle(conn.release(),
+                                                   CommandState::Deleter{deleter, shard->reactor});
+            pconn->lastReply = now();
+
+            std::vector<Promise<std::shared_ptr<PipelinedConnection>>> waiters;
+            {
+                stdx::lock_guard<stdx::mutex> lk(shard->pipelineMutex);
+                waiters = _takePipelinedWaitersInlock(shard, target, pending);
+                pconn->inFlight = 1 + waiters.size();
+                shard->pipelined[target].push_back(pconn);
+            }
+            for (auto& waiter : waiters) {
+                waiter.emplaceValue(pconn);
+            }
+            return pconn;
+        })
+        .onError([this, shard, pending, target = request.target](
+            Status status) -> StatusWith<std::shared_ptr<PipelinedConnection>> {
+            std::vector<Promise<std::shared_ptr<PipelinedConnection>>> waiters;
+            {
+                stdx::lock_guard<stdx::mutex> lk(shard->pipelineMutex);
+                waiters = _takePipelinedWaitersInlock(shard, target, pending);
+            }
+            for (auto& waiter : waiters) {
+                waiter.setError(status);
+            }
+            return status;
+        });
+}
+
+std::vector<Promise<std::shared_ptr<NetworkInterfaceTL::PipelinedConnection>>>
+NetworkInterfaceTL::_takePipelinedWaitersInlock(
+    PoolShard* shard,
+    const HostAndPort& target,
+    const std::shared_ptr<PendingPipelinedConnection>& pending) {
+    auto it = shard->pendingPipelined.find(target);
+    if (it != shard->pendingPipelined.end() && it->second == pending) {
+        shard->pendingPipelined.erase(it);
+    }
+    return std::move(pending->waiters);
+}
+
+void NetworkInterfaceTL::_runPipelinedCommand(PoolShard* shard,
+                                              std::shared_ptr<CommandState> state,
+                                              std::shared_ptr<PipelinedConnection> pconn) {
+    if (state->done.load()) {
+        _releasePipelinedConnection(shard, pconn, Status::OK());
+        return;
+    }
+
+    // Timing out or canceling a command only fails its promise. The connection is shared, so the
+    // reply is still read and then discarded. But if no reply at all arrived on the connection
+    // since the command was sent, the server or the network stalled: the connection takes no new
+    // commands, and its socket is canceled so that every command still waiting on it fails.
+    const auto sent = now();
+    if (state->deadline != RemoteCommandRequest::kNoExpirationDate) {
+        state->timer = shard->reactor->makeTimer();
+        state->timer->waitUntil(state->deadline).getAsync([this, shard, state, pconn, sent](
+            Status status) {
+            if (status == ErrorCodes::CallbackCanceled) {
+                return;
+            }
+
+            if (state->done.swap(true)) {
+                return;
+            }
+
+            if (getTestCommandsEnabled()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _counters.timedOut++;
+            }
+
+            LOG(2) << "Request " << state->request.id << " timed out"
+                   << ", deadline was " << state->deadline << ", op was "
+                   << redact(state->request.toString());
+            state->promise.setError(
+                Status(ErrorCodes::NetworkInterfaceExceededTimeLimit, "timed out"));
+
+            // The command is still in flight, so the connection has not been released yet.
+            AsyncDBClient::Handle stalledClient;
+            {
+                stdx::lock_guard<stdx::mutex> lk(shard->pipelineMutex);
+                if (!pconn->failed && pconn->lastReply <= sent) {
+                    pconn->failed = true;
+                    stalledClient =
+                        checked_cast<connection_pool_tl::TLConnection*>(pconn->conn.get())
+                            ->client()
+                            ->shared_from_this();
+                }
+            }
+            if (stalledClient) {
+                LOG(1) << "No reply arrived on the pipelined connection to "
+                       << state->request.target << " since request " << state->request.id
+                       << " was sent, canceling it";
+                stalledClient->cancel();
+            }
+        });
+    }
+
+    auto client = checked_cast<connection_pool_tl::TLConnection*>(pconn->conn.get())->client();
+    client->runPipelinedCommandRequest(state->request)
+        .getAsync([this, shard, state, pconn](StatusWith<RemoteCommandResponse> swr) {
+            _eraseInUseConn(state->cbHandle);
+            // Network errors come back as the status of the response. As in _onAcquireConn, they
+            // fail the connection, and the other commands sent on it are not given new ones.
+            // A command which ran and failed has its error in the reply data instead, and an
+            // error of the metadata hook is only the command's.
+            _releasePipelinedConnection(
+                shard, pconn, swr.isOK() ? swr.getValue().status : swr.getStatus());
+
+            if (swr.isOK() && _metadataHook && swr.getValue().status.isOK()) {
+                auto& response = swr.getValue();
+                response.status = _metadataHook->readReplyMetadata(
+                    nullptr, state->request.target.toString(), response.metadata);
+            }
+
+            if (state->done.swap(true))
+                return;
+
+            if (getTestCommandsEnabled()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (swr.isOK() && swr.getValue().status.isOK()) {
+                    _counters.succeeded++;
+                } else {
+                    _counters.failed++;
+                }
+            }
+
+            if (state->timer) {
+                state->timer->cancel();
+            }
+
+            state->promise.setFromStatusWith(std::move(swr));
+        });
+}
+
+void NetworkInterfaceTL::_releasePipelinedConnection(
+    PoolShard* shard, const std::shared_ptr<PipelinedConnection>& pconn, Status status) {
+    CommandState::ConnHandle conn;
+    {
+        stdx::lock_guard<stdx::mutex> lk(shard->pipelineMutex);
+        invariant(pconn->inFlight > 0);
+        --pconn->inFlight;
+        if (!status.isOK()) {
+            pconn->failed = true;
+        } else {
+            pconn->lastReply = now();
+        }
+        if (pconn->inFlight > 0) {
+            return;
+        }
+
+        auto& conns = shard->pipelined[pconn->conn->getHostAndPort()];
+        conns.erase(std::remove(conns.begin(), conns.end(), pconn), conns.end());
+        conn = std::move(pconn->conn);
+    }
+
+    if (pconn->failed) {
+        conn->indicateFailure(status.isOK() ? Status(ErrorCodes::HostUnreachable,
+                                                     "Pipelined connection failed")
+                                            : status);
+    } else {
+        conn->indicateUsed();
+        conn->indicateSuccess();
+    }
+}
+
 void NetworkInterfaceTL::_eraseInUseConn(const TaskExecutor::CallbackHandle& cbHandle) {
     stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
     _inProgress.erase(cbHandle);
@@ -493,11 +829,15 @@ Status NetworkInterfaceTL::setAlarm(Date_t when,
 }
 
 bool NetworkInterfaceTL::onNetworkThread() {
-    return _reactor->onReactorThread();
+    return std::any_of(_shards.begin(), _shards.end(), [](const auto& shard) {
+        return shard->reactor->onReactorThread();
+    });
 }
 
 void NetworkInterfaceTL::dropConnections(const HostAndPort& hostAndPort) {
-    _pool->dropConnections(hostAndPort);
+    for (auto& shard : _shards) {
+        shard->pool->dropConnections(hostAndPort);
+    }
 }
 
 }  // namespace executor
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <deque>
+#include <vector>
 
 #include "mongo/client/async_client.h"
 #include "mongo/db/service_context.h"
@@ -110,7 +111,77 @@ private:
         Promise<RemoteCommandResponse> promise;
     };
 
-    void _run();
+    /**
+     * A connection checked out for pipelined commands. It goes back to the pool once no command
+     * is in flight on it.
+     */
+    struct PipelinedConnection {
+        CommandState::ConnHandle conn;
+        size_t inFlight = 0;
+        // Set after a network error, or once a command timed out without any reply arriving on
+        // the connection since it was sent. The connection then takes no new commands.
+        bool failed = false;
+        // When the latest reply arrived, or when the connection was checked out.
+        Date_t lastReply;
+    };
+
+    /**
+     * A connection being checked out of the pool for pipelined commands. Commands which find no
+     * room on the existing connections meanwhile wait for it, up to the number it can take.
+     */
+    struct PendingPipelinedConnection {
+        std::vector<Promise<std::shared_ptr<PipelinedConnection>>> waiters;
+    };
+
+    /**
+     * A connection pool with the reactor and thread that run it. Connections to a host are only
+     * checked out of and returned to the shard that created them.
+     */
+    struct PoolShard {
+        transport::ReactorHandle reactor;
+        std::unique_ptr<ConnectionPool> pool;
+        stdx::thread ioThread;
+
+        stdx::mutex pipelineMutex;
+        stdx::unordered_map<HostAndPort, std::vector<std::shared_ptr<PipelinedConnection>>>
+            pipelined;
+        // The connection to each host which still takes waiters.
+        stdx::unordered_map<HostAndPort, std::shared_ptr<PendingPipelinedConnection>>
+            pendingPipelined;
+    };
+
+    /**
+     * Returns the shard a request to 'target' checks its connection out of: the calling thread's
+     * home shard, unless only another shard has an idle connection to the host.
+     */
+    PoolShard* _pickShard(const HostAndPort& target);
+
+    void _run(PoolShard* shard);
+
+    void _startPipelinedCommand(std::shared_ptr<CommandState> state,
+                                Future<RemoteCommandResponse> future,
+                                const RemoteCommandCompletionFn& onFinish,
+                                const transport::BatonHandle& baton);
+    /**
+     * Returns the least busy pipelined connection to the request's target with room for another
+     * command, or one being checked out of the pool, or checks a new one out.
+     */
+    Future<std::shared_ptr<PipelinedConnection>> _acquirePipelinedConnection(
+        PoolShard* shard, const RemoteCommandRequest& request);
+    /**
+     * Stops 'pending' from taking new waiters and returns the ones it has. Must be called with
+     * the shard's pipelineMutex held.
+     */
+    std::vector<Promise<std::shared_ptr<PipelinedConnection>>> _takePipelinedWaitersInlock(
+        PoolShard* shard,
+        const HostAndPort& target,
+        const std::shared_ptr<PendingPipelinedConnection>& pending);
+    void _runPipelinedCommand(PoolShard* shard,
+                              std::shared_ptr<CommandState> state,
+                              std::shared_ptr<PipelinedConnection> pconn);
+    void _releasePipelinedConnection(PoolShard* shard,
+                                     const std::shared_ptr<PipelinedConnection>& pconn,
+                                     Status status);
     void _eraseInUseConn(const TaskExecutor::CallbackHandle& handle);
     Future<RemoteCommandResponse> _onAcquireConn(std::shared_ptr<CommandState> state,
                                                  Future<RemoteCommandResponse> future,
@@ -122,17 +193,17 @@ private:
     transport::TransportLayer* _tl;
     // Will be created if ServiceContext is null, or if no TransportLayer was configured at startup
     std::unique_ptr<transport::TransportLayer> _ownedTransportLayer;
+    // The reactor of the first shard, which also runs alarms.
     transport::ReactorHandle _reactor;
 
     mutable stdx::mutex _mutex;
     ConnectionPool::Options _connPoolOpts;
     std::unique_ptr<NetworkConnectionHook> _onConnectHook;
-    std::unique_ptr<ConnectionPool> _pool;
+    std::vector<std::unique_ptr<PoolShard>> _shards;
     Counters _counters;
 
     std::unique_ptr<rpc::EgressMetadataHook> _metadataHook;
     AtomicBool _inShutdown;
-    stdx::thread _ioThread;
 
     stdx::mutex _inProgressMutex;
     stdx::unordered_map<TaskExecutor::CallbackHandle, std::shared_ptr<CommandState>> _inProgress;
@@ -32,6 +32,7 @@
 
 #include "mongo/s/sharding_initialization.h"
 
+#include <algorithm>
 #include <string>
 
 #include "mongo/base/status.h"
@@ -96,6 +97,14 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// Number of independent connection pools, each with its own lock and network thread, which every
+// task executor of the pool spreads its connections over. Zero means one per coroutine thread
+// group.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolShards, int, 1);
+
+// Number of commands pipelined on one connection to a shard. One disables pipelining.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolPipelinedRequests, int, 1);
+
 namespace {
 
 using executor::NetworkInterface;
@@ -191,6 +200,11 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.shards = ShardingTaskExecutorPoolShards > 0
+        ? ShardingTaskExecutorPoolShards
+        : std::max<size_t>(serverGlobalParams.reservedThreadNum, 1);
+    connPoolOptions.pipelinedRequestsPerConnection =
+        std::max(ShardingTaskExecutorPoolPipelinedRequests, 1);
 
     if (connPoolOptions.refreshRequirement <= connPoolOptions.refreshTimeout) {
         auto newRefreshTimeout = connPoolOptions.refreshRequirement - Milliseconds(1);
@@ -0,0 +1,241 @@
+#include "mongo/transport/admission_controller.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/base/error_codes.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_executor_coroutine.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo::transport {
+namespace {
+// New sessions are not placed on a thread group whose recent load exceeds this many queued tasks.
+// Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(admissionControlMaxThreadGroupLoad, int, 0);
+
+// New sessions are not placed on a thread group whose recent request latency exceeds this many
+// milliseconds. Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(admissionControlTargetLatencyMillis, int, 0);
+
+// Requests each tenant may run per second on average. Zero disables rate limiting.
+MONGO_EXPORT_SERVER_PARAMETER(tenantRateLimitRequestsPerSecond, int, 0);
+
+// Requests a tenant may run in a burst after being idle. Zero means one second worth of requests.
+MONGO_EXPORT_SERVER_PARAMETER(tenantRateLimitBurst, int, 0);
+
+// What tells tenants apart, "appName" or "user". Only read at startup.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(tenantRateLimitKey, std::string, "appName")
+    ->withValidator([](const std::string& potentialNewValue) {
+        if (potentialNewValue != "appName" && potentialNewValue != "user") {
+            return Status(ErrorCodes::BadValue,
+                          "tenantRateLimitKey must be either 'appName' or 'user'");
+        }
+        return Status::OK();
+    });
+
+// A new sample moves the latency average by this fraction of its difference to the average.
+constexpr int64_t kLatencyAverageDivisor = 8;
+
+// A thread group which completed no request for this long is judged by its load alone, so that
+// one slow burst does not keep it closed forever.
+constexpr auto kLatencySampleTtl = std::chrono::seconds(1);
+
+// Number of tenants per shard above which idle buckets are dropped.
+constexpr size_t kMaxBucketsPerShard = 4096;
+
+constexpr auto kSessionsAdmitted = "sessionsAdmitted"_sd;
+constexpr auto kSessionsRedirected = "sessionsRedirected"_sd;
+constexpr auto kSessionsRejected = "sessionsRejected"_sd;
+constexpr auto kRequestsAdmitted = "requestsAdmitted"_sd;
+constexpr auto kRequestsRejected = "requestsRejected"_sd;
+constexpr auto kRequestsShed = "requestsShed"_sd;
+constexpr auto kTenants = "tenants"_sd;
+constexpr auto kLatencyMicros = "threadGroupLatencyMicros"_sd;
+}  // namespace
+
+AdmissionController& AdmissionController::get() {
+    static AdmissionController controller;
+    return controller;
+}
+
+void AdmissionController::setThreadGroupCount(size_t count) {
+    stdx::lock_guard<stdx::mutex> lk(_threadGroupsMutex);
+    if (count <= _threadGroupCount.load(std::memory_order_relaxed)) {
+        return;
+    }
+    _threadGroupArrays.push_back(std::make_unique<ThreadGroupState[]>(count));
+    _threadGroups.store(_threadGroupArrays.back().get(), std::memory_order_release);
+    _threadGroupCount.store(count, std::memory_order_release);
+}
+
+AdmissionController::ThreadGroupState* AdmissionController::_threadGroup(
+    size_t threadGroupId) const {
+    if (threadGroupId >= _threadGroupCount.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return &_threadGroups.load(std::memory_order_acquire)[threadGroupId];
+}
+
+int64_t AdmissionController::_latencyMicros(size_t threadGroupId, Clock::time_point now) const {
+    auto state = _threadGroup(threadGroupId);
+    if (!state) {
+        return 0;
+    }
+    const auto& latency = *state;
+    auto lastSample = Clock::time_point(
+        Clock::duration(latency.lastSample.load(std::memory_order_relaxed)));
+    if (now - lastSample > kLatencySampleTtl) {
+        return 0;
+    }
+    return latency.averageMicros.load(std::memory_order_relaxed);
+}
+
+bool AdmissionController::isOverloaded(size_t threadGroupId, uint32_t load) const {
+    auto maxLoad = admissionControlMaxThreadGroupLoad.load();
+    if (maxLoad > 0 &&
+        load > static_cast<uint32_t>(maxLoad) * ServiceExecutorCoroutine::kLoadScale) {
+        return true;
+    }
+
+    auto targetLatency = admissionControlTargetLatencyMillis.load();
+    return targetLatency > 0 &&
+        _latencyMicros(threadGroupId, Clock::now()) > int64_t{targetLatency} * 1000;
+}
+
+void AdmissionController::sessionRedirected() {
+    _sessionsRedirected.fetch_add(1, std::memory_order_relaxed);
+}
+
+Status AdmissionController::admitSession(size_t threadGroupId, uint32_t load) {
+    if (isOverloaded(threadGroupId, load)) {
+        _sessionsRejected.fetch_add(1, std::memory_order_relaxed);
+        return {ErrorCodes::ThreadGroupOverloaded,
+                str::stream() << "thread group " << threadGroupId << " is overloaded"};
+    }
+    _sessionsAdmitted.fetch_add(1, std::memory_order_relaxed);
+    return Status::OK();
+}
+
+void AdmissionController::recordRequestStart(size_t threadGroupId, uint32_t load) {
+    if (auto state = _threadGroup(threadGroupId)) {
+        state->load.store(load, std::memory_order_relaxed);
+    }
+}
+
+Status AdmissionController::admitRequestOnThreadGroup(size_t threadGroupId) {
+    auto state = _threadGroup(threadGroupId);
+    if (state && isOverloaded(threadGroupId, state->load.load(std::memory_order_relaxed))) {
+        _requestsShed.fetch_add(1, std::memory_order_relaxed);
+        return {ErrorCodes::ThreadGroupOverloaded,
+                str::stream() << "thread group " << threadGroupId
+                              << " is overloaded, the request was not started"};
+    }
+    return Status::OK();
+}
+
+void AdmissionController::recordRequestLatency(size_t threadGroupId, Microseconds latency) {
+    auto statePtr = _threadGroup(threadGroupId);
+    if (!statePtr) {
+        return;
+    }
+
+    // Only the owning thread group writes its average, so a plain load and store is enough.
+    auto& state = *statePtr;
+    auto sample = durationCount<Microseconds>(latency);
+    auto average = state.averageMicros.load(std::memory_order_relaxed);
+    average += (sample - average) / kLatencyAverageDivisor;
+    state.averageMicros.store(average, std::memory_order_relaxed);
+    state.lastSample.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool AdmissionController::rateLimitEnabled() const {
+    return tenantRateLimitRequestsPerSecond.load() > 0;
+}
+
+bool AdmissionController::rateLimitByUser() const {
+    return tenantRateLimitKey == "user";
+}
+
+Status AdmissionController::admitRequest(StringData tenant) {
+    auto rate = tenantRateLimitRequestsPerSecond.load();
+    if (rate <= 0) {
+        return Status::OK();
+    }
+    auto burst = tenantRateLimitBurst.load();
+    const double capacity = burst > 0 ? burst : rate;
+
+    auto& shard = _bucketShards[StringMapTraits::hash(tenant) % kBucketShards];
+    auto now = Clock::now();
+    bool admitted;
+    {
+        stdx::lock_guard<stdx::mutex> lk(shard.mutex);
+        auto it = shard.buckets.find(tenant);
+        if (it == shard.buckets.end()) {
+            if (shard.buckets.size() >= kMaxBucketsPerShard) {
+                // A bucket which refilled completely is indistinguishable from a new one.
+                std::vector<std::string> idle;
+                for (auto& entry : shard.buckets) {
+                    std::chrono::duration<double> elapsed = now - entry.second.lastRefill;
+                    if (entry.second.tokens + elapsed.count() * rate >= capacity) {
+                        idle.push_back(entry.first);
+                    }
+                }
+                for (auto& key : idle) {
+                    shard.buckets.erase(key);
+                }
+            }
+            it = shard.buckets.try_emplace(tenant, Bucket{capacity, now}).first;
+        }
+
+        auto& bucket = it->second;
+        std::chrono::duration<double> elapsed = now - bucket.lastRefill;
+        bucket.tokens = std::min(capacity, bucket.tokens + elapsed.count() * rate);
+        bucket.lastRefill = now;
+        admitted = bucket.tokens >= 1;
+        if (admitted) {
+            bucket.tokens -= 1;
+        }
+    }
+
+    if (!admitted) {
+        _requestsRejected.fetch_add(1, std::memory_order_relaxed);
+        return {ErrorCodes::RequestRateLimitExceeded,
+                str::stream() << "request rate limit of " << rate
+                              << " per second exceeded for tenant '" << tenant << "'"};
+    }
+    _requestsAdmitted.fetch_add(1, std::memory_order_relaxed);
+    return Status::OK();
+}
+
+void AdmissionController::appendStats(BSONObjBuilder* bob) const {
+    *bob << kSessionsAdmitted
+         << static_cast<long long>(_sessionsAdmitted.load(std::memory_order_relaxed))
+         << kSessionsRedirected
+         << static_cast<long long>(_sessionsRedirected.load(std::memory_order_relaxed))
+         << kSessionsRejected
+         << static_cast<long long>(_sessionsRejected.load(std::memory_order_relaxed))
+         << kRequestsAdmitted
+         << static_cast<long long>(_requestsAdmitted.load(std::memory_order_relaxed))
+         << kRequestsRejected
+         << static_cast<long long>(_requestsRejected.load(std::memory_order_relaxed))
+         << kRequestsShed << static_cast<long long>(_requestsShed.load(std::memory_order_relaxed));
+
+    long long tenants = 0;
+    for (auto& shard : _bucketShards) {
+        stdx::lock_guard<stdx::mutex> lk(shard.mutex);
+        tenants += shard.buckets.size();
+    }
+    *bob << kTenants << tenants;
+
+    auto now = Clock::now();
+    BSONArrayBuilder latency(bob->subarrayStart(kLatencyMicros));
+    auto threadGroupCount = _threadGroupCount.load(std::memory_order_acquire);
+    for (size_t id = 0; id < threadGroupCount; ++id) {
+        latency.append(static_cast<long long>(_latencyMicros(id, now)));
+    }
+}
+
+}  // namespace mongo::transport
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo::transport {
+
+/**
+ * Decides whether new sessions and requests are let in, so that overload turns into fast
+ * rejections at the edge instead of unbounded queues inside the coroutine thread groups.
+ *
+ * Sessions and requests are judged by the thread group they run on: a group is overloaded when its
+ * recent load exceeds admissionControlMaxThreadGroupLoad queued tasks, or when the smoothed latency
+ * of the requests it recently completed exceeds admissionControlTargetLatencyMillis. Requests
+ * refused because of it fail with ThreadGroupOverloaded before they started, so clients may retry
+ * them.
+ *
+ * Requests are judged by tenant, the client application name or the authenticated user, each of
+ * which draws from its own token bucket refilled at tenantRateLimitRequestsPerSecond.
+ *
+ * Every check is off while its server parameter is zero. All methods are thread safe.
+ */
+class AdmissionController {
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+public:
+    AdmissionController() = default;
+
+    static AdmissionController& get();
+
+    /**
+     * Sizes the per thread group tracking. Calling it again with a count no larger than the current
+     * one does nothing.
+     */
+    void setThreadGroupCount(size_t count);
+
+    /**
+     * 'load' is the thread group's recent load, in units of 1/ServiceExecutorCoroutine::kLoadScale
+     * queued tasks.
+     */
+    bool isOverloaded(size_t threadGroupId, uint32_t load) const;
+
+    /**
+     * Counts a session moved off the thread group it would have been placed on because that one
+     * was overloaded.
+     */
+    void sessionRedirected();
+
+    /**
+     * Returns ThreadGroupOverloaded if the thread group is too loaded to take on a new session.
+     */
+    Status admitSession(size_t threadGroupId, uint32_t load);
+
+    /**
+     * Called by the thread group about to run a request, with its recent load.
+     */
+    void recordRequestStart(size_t threadGroupId, uint32_t load);
+
+    /**
+     * Returns ThreadGroupOverloaded if the thread group, as of the latest request it started, must
+     * not take on more requests.
+     */
+    Status admitRequestOnThreadGroup(size_t threadGroupId);
+
+    /**
+     * Called by the thread group which ran the request.
+     */
+    void recordRequestLatency(size_t threadGroupId, Microseconds latency);
+
+    bool rateLimitEnabled() const;
+
+    /**
+     * Whether tenants are told apart by authenticated user rather than by application name.
+     */
+    bool rateLimitByUser() const;
+
+    /**
+     * Takes a token from the tenant's bucket, or returns RequestRateLimitExceeded if it is empty.
+     * Requests without a tenant share a single bucket.
+     */
+    Status admitRequest(StringData tenant);
+
+    void appendStats(BSONObjBuilder* bob) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadGroupState {
+        // Exponentially weighted moving average of the request latency.
+        std::atomic<int64_t> averageMicros{0};
+        // Time of the latest sample, in Clock ticks.
+        std::atomic<int64_t> lastSample{0};
+        // Load of the thread group when it started its latest request.
+        std::atomic<uint32_t> load{0};
+    };
+
+    struct Bucket {
+        double tokens;
+        Clock::time_point lastRefill;
+    };
+
+    struct BucketShard {
+        mutable stdx::mutex mutex;
+        StringMap<Bucket> buckets;
+    };
+
+    static constexpr size_t kBucketShards = 16;
+
+    /**
+     * Returns nullptr if the thread group is unknown.
+     */
+    ThreadGroupState* _threadGroup(size_t threadGroupId) const;
+
+    int64_t _latencyMicros(size_t threadGroupId, Clock::time_point now) const;
+
+    // Published before _threadGroupCount, which readers load first.
+    std::atomic<ThreadGroupState*> _threadGroups{nullptr};
+    std::atomic<size_t> _threadGroupCount{0};
+
+    // Every array ever published, since readers may still be using a smaller one.
+    stdx::mutex _threadGroupsMutex;
+    std::vector<std::unique_ptr<ThreadGroupState[]>> _threadGroupArrays;
+
+    std::array<BucketShard, kBucketShards> _bucketShards;
+
+    std::atomic<uint64_t> _sessionsAdmitted{0};
+    std::atomic<uint64_t> _sessionsRedirected{0};
+    std::atomic<uint64_t> _sessionsRejected{0};
+    std::atomic<uint64_t> _requestsAdmitted{0};
+    std::atomic<uint64_t> _requestsRejected{0};
+    std::atomic<uint64_t> _requestsShed{0};
+};
+
+}  // namespace mongo::transport
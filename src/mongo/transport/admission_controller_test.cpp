@@ -0,0 +1,182 @@
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/admission_controller.h"
+
+#include <limits>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor_coroutine.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/map_util.h"
+
+namespace mongo {
+namespace {
+
+using transport::AdmissionController;
+
+ServerParameter* getParameter(StringData name) {
+    auto parameter = mapFindWithDefault(ServerParameterSet::getGlobal()->getMap(),
+                                        name.toString(),
+                                        static_cast<ServerParameter*>(nullptr));
+    invariant(parameter);
+    return parameter;
+}
+
+/**
+ * Sets a server parameter for the lifetime of this object.
+ */
+class ServerParameterGuard {
+public:
+    ServerParameterGuard(StringData name, StringData value) : _parameter(getParameter(name)) {
+        BSONObjBuilder bob;
+        _parameter->append(nullptr, bob, "value");
+        _oldValue = bob.obj();
+        ASSERT_OK(_parameter->setFromString(value.toString()));
+    }
+
+    ~ServerParameterGuard() {
+        ASSERT_OK(_parameter->set(_oldValue["value"]));
+    }
+
+private:
+    ServerParameter* const _parameter;
+    BSONObj _oldValue;
+};
+
+BSONObj getStats(const AdmissionController& admission) {
+    BSONObjBuilder bob;
+    admission.appendStats(&bob);
+    return bob.obj();
+}
+
+TEST(AdmissionController, EverythingIsAdmittedByDefault) {
+    AdmissionController admission;
+    admission.setThreadGroupCount(2);
+
+    ASSERT_FALSE(admission.rateLimitEnabled());
+    ASSERT_FALSE(admission.rateLimitByUser());
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_OK(admission.admitRequest("app"));
+    }
+
+    admission.recordRequestLatency(0, Seconds(10));
+    ASSERT_OK(admission.admitSession(0, std::numeric_limits<uint32_t>::max()));
+}
+
+TEST(AdmissionController, TokenBucketLimitsEachTenant) {
+    ServerParameterGuard rate("tenantRateLimitRequestsPerSecond", "10");
+    ServerParameterGuard burst("tenantRateLimitBurst", "2");
+    AdmissionController admission;
+
+    ASSERT_TRUE(admission.rateLimitEnabled());
+    ASSERT_OK(admission.admitRequest("app1"));
+    ASSERT_OK(admission.admitRequest("app1"));
+    ASSERT_EQ(admission.admitRequest("app1"), ErrorCodes::RequestRateLimitExceeded);
+
+    // Every tenant has its own bucket, requests without a tenant share one.
+    ASSERT_OK(admission.admitRequest("app2"));
+    ASSERT_OK(admission.admitRequest(""));
+
+    // The bucket refills at the configured rate.
+    stdx::this_thread::sleep_for(Milliseconds(150).toSystemDuration());
+    ASSERT_OK(admission.admitRequest("app1"));
+
+    auto stats = getStats(admission);
+    ASSERT_EQ(stats["requestsAdmitted"].numberLong(), 5);
+    ASSERT_EQ(stats["requestsRejected"].numberLong(), 1);
+    ASSERT_EQ(stats["tenants"].numberLong(), 3);
+}
+
+TEST(AdmissionController, OverloadedThreadGroupShedsSessions) {
+    ServerParameterGuard maxLoad("admissionControlMaxThreadGroupLoad", "4");
+    AdmissionController admission;
+    admission.setThreadGroupCount(2);
+
+    const uint32_t limit = 4 * transport::ServiceExecutorCoroutine::kLoadScale;
+    ASSERT_FALSE(admission.isOverloaded(0, limit));
+    ASSERT_OK(admission.admitSession(0, limit));
+    ASSERT_TRUE(admission.isOverloaded(0, limit + 1));
+    ASSERT_EQ(admission.admitSession(0, limit + 1), ErrorCodes::ThreadGroupOverloaded);
+
+    auto stats = getStats(admission);
+    ASSERT_EQ(stats["sessionsAdmitted"].numberLong(), 1);
+    ASSERT_EQ(stats["sessionsRejected"].numberLong(), 1);
+}
+
+TEST(AdmissionController, SlowThreadGroupShedsSessions) {
+    ServerParameterGuard targetLatency("admissionControlTargetLatencyMillis", "10");
+    AdmissionController admission;
+    admission.setThreadGroupCount(2);
+
+    ASSERT_FALSE(admission.isOverloaded(0, 0));
+    admission.recordRequestLatency(0, Seconds(1));
+    ASSERT_TRUE(admission.isOverloaded(0, 0));
+    ASSERT_EQ(admission.admitSession(0, 0), ErrorCodes::ThreadGroupOverloaded);
+
+    // The other thread group still takes new sessions, which are redirected to it.
+    ASSERT_FALSE(admission.isOverloaded(1, 0));
+    admission.sessionRedirected();
+    ASSERT_OK(admission.admitSession(1, 0));
+
+    auto stats = getStats(admission);
+    ASSERT_EQ(stats["sessionsRedirected"].numberLong(), 1);
+    ASSERT_EQ(stats["sessionsAdmitted"].numberLong(), 1);
+    ASSERT_EQ(stats["sessionsRejected"].numberLong(), 1);
+    ASSERT_GT(stats["threadGroupLatencyMicros"].Array()[0].numberLong(), 10 * 1000);
+}
+
+TEST(AdmissionController, OverloadedThreadGroupShedsRequests) {
+    ServerParameterGuard maxLoad("admissionControlMaxThreadGroupLoad", "4");
+    AdmissionController admission;
+    admission.setThreadGroupCount(2);
+
+    const uint32_t limit = 4 * transport::ServiceExecutorCoroutine::kLoadScale;
+    admission.recordRequestStart(0, limit + 1);
+    admission.recordRequestStart(1, limit);
+    ASSERT_EQ(admission.admitRequestOnThreadGroup(0), ErrorCodes::ThreadGroupOverloaded);
+    ASSERT_TRUE(ErrorCodes::isAdmissionControlError(ErrorCodes::ThreadGroupOverloaded));
+    ASSERT_OK(admission.admitRequestOnThreadGroup(1));
+
+    // The group takes requests again once its load went down.
+    admission.recordRequestStart(0, 0);
+    ASSERT_OK(admission.admitRequestOnThreadGroup(0));
+
+    // Requests running outside of the known thread groups are never shed.
+    ASSERT_OK(admission.admitRequestOnThreadGroup(2));
+
+    ASSERT_EQ(getStats(admission)["requestsShed"].numberLong(), 1);
+}
+
+TEST(AdmissionController, ThreadGroupCountOnlyGrows) {
+    ServerParameterGuard targetLatency("admissionControlTargetLatencyMillis", "10");
+    AdmissionController admission;
+    admission.setThreadGroupCount(2);
+    admission.recordRequestLatency(1, Seconds(1));
+
+    // Setting the same or a smaller count again keeps what was tracked.
+    admission.setThreadGroupCount(2);
+    admission.setThreadGroupCount(1);
+    ASSERT_TRUE(admission.isOverloaded(1, 0));
+    ASSERT_EQ(getStats(admission)["threadGroupLatencyMicros"].Array().size(), 2U);
+
+    admission.setThreadGroupCount(4);
+    ASSERT_EQ(getStats(admission)["threadGroupLatencyMicros"].Array().size(), 4U);
+    admission.recordRequestLatency(3, Seconds(1));
+    ASSERT_TRUE(admission.isOverloaded(3, 0));
+}
+
+TEST(AdmissionController, TenantRateLimitKeyIsValidated) {
+    auto parameter = getParameter("tenantRateLimitKey");
+    ASSERT_EQ(parameter->setFromString("host"), ErrorCodes::BadValue);
+    ASSERT_EQ(parameter->setFromString(""), ErrorCodes::BadValue);
+
+    {
+        ServerParameterGuard key("tenantRateLimitKey", "user");
+        ASSERT_TRUE(AdmissionController().rateLimitByUser());
+    }
+    ASSERT_FALSE(AdmissionController().rateLimitByUser());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,129 @@
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/transport/coroutine_stack_pool.h"
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/debug_util.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo::transport {
+namespace {
+// Usable size of each coroutine stack, rounded up to whole pages. Only read at startup.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(coroutineStackSizeKB, int, 320);
+
+// Maximum number of unused stacks kept mapped by each thread group.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineStackPoolMaxCached, int, 64);
+
+constexpr auto kStackSizeBytes = "stackSizeBytes"_sd;
+constexpr auto kStacksInUse = "inUse"_sd;
+constexpr auto kStacksCached = "cached"_sd;
+constexpr auto kHighWaterMark = "highWaterMark"_sd;
+constexpr auto kTotalMapped = "totalMapped"_sd;
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t roundUpToPage(size_t size) {
+    return (size + pageSize() - 1) / pageSize() * pageSize();
+}
+}  // namespace
+
+CoroutineStackPool::CoroutineStackPool()
+    : _guardSize(pageSize()),
+      _stackSize(roundUpToPage(static_cast<size_t>(std::max(16, coroutineStackSizeKB)) * 1024)) {}
+
+CoroutineStackPool::~CoroutineStackPool() {
+    for (void* base : _freeStacks) {
+        ::munmap(base, _guardSize + _stackSize);
+    }
+}
+
+void CoroutineStackPool::_assertOwner() {
+    if (kDebugBuild) {
+        auto self = stdx::this_thread::get_id();
+        if (_owner == stdx::thread::id()) {
+            _owner = self;
+        }
+        invariant(_owner == self);
+    }
+}
+
+boost::context::stack_context CoroutineStackPool::allocate() {
+    _assertOwner();
+    void* base = nullptr;
+    if (!_freeStacks.empty()) {
+        base = _freeStacks.back();
+        _freeStacks.pop_back();
+        _cached.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        base = ::mmap(nullptr,
+                      _guardSize + _stackSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1,
+                      0);
+        uassert(ErrorCodes::ExceededMemoryLimit,
+                str::stream() << "Failed to map a coroutine stack: " << errnoWithDescription(),
+                base != MAP_FAILED);
+
+        // The stack grows downwards, so the guard page sits at the lowest address.
+        if (::mprotect(base, _guardSize, PROT_NONE) != 0) {
+            auto desc = errnoWithDescription();
+            ::munmap(base, _guardSize + _stackSize);
+            uasserted(ErrorCodes::InternalError,
+                      str::stream() << "Failed to protect a coroutine stack guard page: " << desc);
+        }
+        _totalMapped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t inUse = _inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (inUse > _highWaterMark.load(std::memory_order_relaxed)) {
+        _highWaterMark.store(inUse, std::memory_order_relaxed);
+    }
+
+    boost::context::stack_context sc;
+    sc.size = _stackSize;
+    sc.sp = static_cast<char*>(base) + _guardSize + _stackSize;
+    return sc;
+}
+
+void CoroutineStackPool::deallocate(boost::context::stack_context& sc) {
+    _assertOwner();
+    invariant(sc.sp && sc.size == _stackSize);
+    void* base = static_cast<char*>(sc.sp) - _stackSize - _guardSize;
+    _inUse.fetch_sub(1, std::memory_order_relaxed);
+
+    auto maxCached = static_cast<size_t>(std::max(0, coroutineStackPoolMaxCached.load()));
+    if (_freeStacks.size() < maxCached) {
+        _freeStacks.push_back(base);
+        _cached.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        ::munmap(base, _guardSize + _stackSize);
+    }
+    sc = boost::context::stack_context();
+}
+
+void CoroutineStackPool::appendStats(BSONObjBuilder* bob) const {
+    *bob << kStackSizeBytes << static_cast<long long>(_stackSize) << kStacksInUse
+         << static_cast<long long>(_inUse.load(std::memory_order_relaxed)) << kStacksCached
+         << static_cast<long long>(_cached.load(std::memory_order_relaxed)) << kHighWaterMark
+         << static_cast<long long>(_highWaterMark.load(std::memory_order_relaxed))
+         << kTotalMapped << static_cast<long long>(_totalMapped.load(std::memory_order_relaxed));
+}
+
+CoroutineStackPool* CoroutineStackPool::threadLocal() {
+    static thread_local CoroutineStackPool pool;
+    return &pool;
+}
+
+}  // namespace mongo::transport
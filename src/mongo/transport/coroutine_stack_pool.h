@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <boost/context/stack_context.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo::transport {
+
+/**
+ * A pool of coroutine stacks owned by a single ThreadGroup.
+ *
+ * Stacks are mmap'd with a PROT_NONE guard page below the usable area, so that a stack
+ * overflow faults instead of silently corrupting neighbouring memory. A stack is only held
+ * while a coroutine is ongoing; finished coroutines return their stack to the pool, which
+ * caches up to coroutineStackPoolMaxCached stacks and unmaps the rest.
+ *
+ * allocate() and deallocate() must only be called by the thread bound to the owning thread
+ * group, which debug builds check. appendStats() may be called from any thread.
+ */
+class CoroutineStackPool {
+    CoroutineStackPool(const CoroutineStackPool&) = delete;
+    CoroutineStackPool& operator=(const CoroutineStackPool&) = delete;
+
+public:
+    CoroutineStackPool();
+    ~CoroutineStackPool();
+
+    /**
+     * Returns a stack of stackSize() usable bytes. Throws if the stack cannot be mapped.
+     */
+    boost::context::stack_context allocate();
+
+    void deallocate(boost::context::stack_context& sc);
+
+    size_t stackSize() const {
+        return _stackSize;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const;
+
+    /**
+     * Pool used by threads which do not belong to a coroutine thread group.
+     */
+    static CoroutineStackPool* threadLocal();
+
+private:
+    void _assertOwner();
+
+    const size_t _guardSize;
+    const size_t _stackSize;
+
+    // Lowest address (the guard page) of every cached stack.
+    std::vector<void*> _freeStacks;
+
+    // The first thread to use the pool.
+    stdx::thread::id _owner;
+
+    std::atomic<size_t> _inUse{0};
+    std::atomic<size_t> _cached{0};
+    std::atomic<size_t> _highWaterMark{0};
+    std::atomic<uint64_t> _totalMapped{0};
+};
+
+}  // namespace mongo::transport
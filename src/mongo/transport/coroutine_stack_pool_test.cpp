@@ -0,0 +1,51 @@
+#include "mongo/platform/basic.h"
+
+#include <cstring>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/transport/coroutine_stack_pool.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+using transport::CoroutineStackPool;
+
+TEST(CoroutineStackPoolTest, StacksAreReused) {
+    CoroutineStackPool pool;
+
+    auto first = pool.allocate();
+    ASSERT(first.sp);
+    ASSERT_EQ(first.size, pool.stackSize());
+    void* firstSp = first.sp;
+
+    // The whole usable area must be writable.
+    std::memset(static_cast<char*>(first.sp) - first.size, 0xab, first.size);
+
+    pool.deallocate(first);
+    ASSERT_FALSE(first.sp);
+
+    auto second = pool.allocate();
+    ASSERT_EQ(second.sp, firstSp);
+    pool.deallocate(second);
+}
+
+TEST(CoroutineStackPoolTest, StatsTrackHighWaterMark) {
+    CoroutineStackPool pool;
+
+    auto a = pool.allocate();
+    auto b = pool.allocate();
+    pool.deallocate(a);
+
+    BSONObjBuilder bob;
+    pool.appendStats(&bob);
+    auto stats = bob.obj();
+    ASSERT_EQ(stats["inUse"].numberLong(), 1);
+    ASSERT_EQ(stats["cached"].numberLong(), 1);
+    ASSERT_EQ(stats["highWaterMark"].numberLong(), 2);
+    ASSERT_EQ(stats["totalMapped"].numberLong(), 2);
+
+    pool.deallocate(b);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -32,18 +32,37 @@
 
 #include "mongo/transport/message_compressor_manager.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_endian.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/rpc/message.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
 
+// Whether to offer and accept adaptive compression during negotiation.
+MONGO_EXPORT_SERVER_PARAMETER(networkCompressionAdaptive, bool, true);
+// With adaptive compression, messages smaller than this are not compressed.
+MONGO_EXPORT_SERVER_PARAMETER(networkCompressionMinBytes, int, 512);
+// With adaptive compression, messages which save less than this are compressed poorly.
+MONGO_EXPORT_SERVER_PARAMETER(networkCompressionMinSavingsPercent, int, 10);
+
+constexpr auto kAdaptiveFieldName = "compressionAdaptive"_sd;
+
+// Consecutive poorly compressed messages after which a connection backs off, and the bounds of
+// the number of messages it then sends uncompressed.
+constexpr uint32_t kPoorRatioCountBeforeBackoff = 4;
+constexpr uint32_t kMinBackoffLength = 8;
+constexpr uint32_t kMaxBackoffLength = 1024;
+
 // TODO(JBR): This should be changed so it 's closer to the MSGHEADER View/ConstView classes
 // than this little struct.
 struct CompressionHeader {
@@ -83,6 +102,11 @@ const transport::Session::Decoration<MessageCompressorManager> getForSession =
     transport::Session::declareDecoration<MessageCompressorManager>();
 }  // namespace
 
+AdaptiveCompressionStats& adaptiveCompressionStats() {
+    static AdaptiveCompressionStats stats;
+    return stats;
+}
+
 MessageCompressorManager::MessageCompressorManager()
     : MessageCompressorManager(&MessageCompressorRegistry::get()) {}
 
@@ -129,7 +153,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
+    Timer timer;
     auto sws = compressor->compressData(input, output);
+    compressor->counterHitCompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -140,6 +166,51 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     return {Message(outputMessageBuffer)};
 }
 
+StatusWith<Message> MessageCompressorManager::maybeCompressMessage(
+    const Message& msg, const MessageCompressorId* compressorId) {
+    if (!_adaptive) {
+        return compressMessage(msg, compressorId);
+    }
+
+    auto& stats = adaptiveCompressionStats();
+    if (msg.size() < std::max(0, networkCompressionMinBytes.load())) {
+        stats.skippedSmall.addAndFetch(1);
+        return {msg};
+    }
+    if (_backoffRemaining > 0) {
+        _backoffRemaining--;
+        stats.skippedBackoff.addAndFetch(1);
+        return {msg};
+    }
+
+    auto swm = compressMessage(msg, compressorId);
+    if (!swm.isOK()) {
+        return swm;
+    }
+
+    const auto compressedSize = static_cast<int64_t>(swm.getValue().size());
+    const auto minSavings = std::max(0, networkCompressionMinSavingsPercent.load());
+    if (compressedSize * 100 > static_cast<int64_t>(msg.size()) * (100 - minSavings)) {
+        if (++_poorRatioCount >= kPoorRatioCountBeforeBackoff) {
+            _poorRatioCount = 0;
+            _backoffLength = std::min(std::max(_backoffLength * 2, kMinBackoffLength),
+                                      kMaxBackoffLength);
+            _backoffRemaining = _backoffLength;
+            stats.backoffs.addAndFetch(1);
+            LOG(3) << "Backing off compression for " << _backoffLength << " messages";
+        }
+    } else {
+        _poorRatioCount = 0;
+        _backoffLength = 0;
+    }
+
+    if (compressedSize >= static_cast<int64_t>(msg.size())) {
+        stats.notSmaller.addAndFetch(1);
+        return {msg};
+    }
+    return swm;
+}
+
 StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& msg,
                                                                 MessageCompressorId* compressorId) {
     auto inputHeader = msg.header();
@@ -176,7 +247,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer timer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -195,6 +268,7 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
 
     // We're about to update the compressor list with the negotiation result from the server.
     _negotiated.clear();
+    _adaptive = false;
 
     auto& compressorList = _registry->getCompressorNames();
     if (compressorList.size() == 0)
@@ -206,6 +280,11 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
         sub.append(e);
     }
     sub.doneFast();
+
+    // Servers which do not know about adaptive compression ignore this field.
+    if (networkCompressionAdaptive.load()) {
+        output->append(kAdaptiveFieldName, true);
+    }
 }
 
 void MessageCompressorManager::clientFinish(const BSONObj& input) {
@@ -231,6 +310,9 @@ void MessageCompressorManager::clientFinish(const BSONObj& input) {
         LOG(3) << "Adding compressor " << ret->getName();
         _negotiated.push_back(ret);
     }
+
+    // The server only answers with this field if we offered it.
+    _adaptive = !_negotiated.empty() && input.getField(kAdaptiveFieldName).trueValue();
 }
 
 void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuilder* output) {
@@ -249,6 +331,9 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
                 sub.append(algo->getName());
             }
             sub.doneFast();
+            if (_adaptive) {
+                output->append(kAdaptiveFieldName, true);
+            }
         } else {
             LOG(3) << "Compression negotiation not requested by client";
         }
@@ -258,6 +343,7 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     // If compression has already been negotiated, then this is a renegotiation, so we should
     // reset the state of the manager.
     _negotiated.clear();
+    _adaptive = false;
 
     // First we go through all the compressor names that the client has requested support for
     BSONObj theirObj = elem.Obj();
@@ -288,6 +374,13 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
             sub.append(algo->getName());
         }
         sub.doneFast();
+
+        // Only clients which offered adaptive compression are told that we agree, older clients
+        // keep getting responses compressed exactly when their requests are.
+        if (networkCompressionAdaptive.load() && input.getField(kAdaptiveFieldName).trueValue()) {
+            _adaptive = true;
+            output->append(kAdaptiveFieldName, true);
+        }
     } else {
         LOG(3) << "Could not agree on compressor to use";
     }
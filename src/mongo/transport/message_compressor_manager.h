@@ -30,6 +30,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/transport/message_compressor_base.h"
 #include "mongo/transport/session.h"
 
@@ -42,6 +43,22 @@ class BSONObjBuilder;
 class Message;
 class MessageCompressorRegistry;
 
+/*
+ * Counters of the adaptive compression decisions made by every MessageCompressorManager.
+ */
+struct AdaptiveCompressionStats {
+    // Messages sent uncompressed because they were smaller than networkCompressionMinBytes.
+    AtomicInt64 skippedSmall;
+    // Messages sent uncompressed while their connection backed off after poor ratios.
+    AtomicInt64 skippedBackoff;
+    // Messages which were compressed, but sent uncompressed because they did not shrink.
+    AtomicInt64 notSmaller;
+    // Number of times a connection started to back off.
+    AtomicInt64 backoffs;
+};
+
+AdaptiveCompressionStats& adaptiveCompressionStats();
+
 class MessageCompressorManager {
     MONGO_DISALLOW_COPYING(MessageCompressorManager);
 
@@ -103,6 +120,26 @@ public:
     StatusWith<Message> compressMessage(const Message& msg,
                                         const MessageCompressorId* compressorId = nullptr);
 
+    /*
+     * Like compressMessage(), but when compression was negotiated as adaptive, returns 'msg'
+     * itself if compressing it is unlikely to pay off: if it is smaller than
+     * networkCompressionMinBytes, if it did not shrink, or while this connection backs off after
+     * several messages saved less than networkCompressionMinSavingsPercent. The back off doubles
+     * each time it starts again.
+     *
+     * Without adaptive compression, this behaves as compressMessage().
+     */
+    StatusWith<Message> maybeCompressMessage(const Message& msg,
+                                             const MessageCompressorId* compressorId = nullptr);
+
+    /*
+     * Returns whether both sides agreed on adaptive compression. The peer then accepts
+     * uncompressed messages and wants its uncompressed requests to get compressed responses.
+     */
+    bool isAdaptive() const {
+        return _adaptive;
+    }
+
     /*
      * Returns a new Message containing the decompressed copy of the input message.
      *
@@ -128,6 +165,13 @@ public:
 private:
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+
+    bool _adaptive{false};
+    // Consecutive messages which compressed poorly.
+    uint32_t _poorRatioCount{0};
+    // Messages left to send uncompressed, and the length of the current back off.
+    uint32_t _backoffRemaining{0};
+    uint32_t _backoffLength{0};
 };
 
 }  // namespace mongo
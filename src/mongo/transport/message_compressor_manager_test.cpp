@@ -31,6 +31,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
 #include "mongo/rpc/message.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
@@ -41,6 +42,13 @@
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 
+#ifdef MONGO_CONFIG_HAVE_LZ4
+#include "mongo/transport/message_compressor_lz4.h"
+#endif
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
+
 #include <string>
 #include <vector>
 
@@ -179,6 +187,18 @@ Message buildMessage() {
     return Message{buf};
 }
 
+Message buildMessage(size_t dataSize) {
+    const auto bufferSize = MsgData::MsgDataHeaderSize + dataSize;
+    auto buf = SharedBuffer::allocate(bufferSize);
+    MsgData::View testView(buf.get());
+    testView.setId(123456);
+    testView.setResponseToMsgId(654321);
+    testView.setOperation(dbQuery);
+    testView.setLen(bufferSize);
+    memset(testView.data(), 'x', dataSize);
+    return Message{buf};
+}
+
 TEST(MessageCompressorManager, NoCompressionRequested) {
     auto input = BSON("isMaster" << 1);
     checkServerNegotiation(input, {});
@@ -218,6 +238,78 @@ TEST(MessageCompressorManager, FullNormalCompression) {
     clientManager.clientFinish(serverObj);
 }
 
+TEST(MessageCompressorManager, AdaptiveCompressionNegotiated) {
+    auto registry = buildRegistry();
+    MessageCompressorManager clientManager(&registry);
+    MessageCompressorManager serverManager(&registry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    auto clientObj = clientOutput.done();
+    ASSERT_TRUE(clientObj["compressionAdaptive"].trueValue());
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"noop"});
+    ASSERT_TRUE(serverObj["compressionAdaptive"].trueValue());
+    ASSERT_TRUE(serverManager.isAdaptive());
+
+    clientManager.clientFinish(serverObj);
+    ASSERT_TRUE(clientManager.isAdaptive());
+}
+
+TEST(MessageCompressorManager, AdaptiveCompressionNotOfferedByOlderClients) {
+    auto registry = buildRegistry();
+    MessageCompressorManager serverManager(&registry);
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(BSON("isMaster" << 1 << "compression" << BSON_ARRAY("noop")),
+                                  &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"noop"});
+    ASSERT_TRUE(serverObj["compressionAdaptive"].eoo());
+    ASSERT_FALSE(serverManager.isAdaptive());
+
+    // Every message is compressed, however small.
+    auto compressed = assertOk(serverManager.maybeCompressMessage(buildMessage()));
+    ASSERT_EQ(compressed.operation(), dbCompressed);
+}
+
+TEST(MessageCompressorManager, AdaptiveCompressionSkipsSmallAndIncompressibleMessages) {
+    auto registry = buildRegistry();
+    MessageCompressorManager serverManager(&registry);
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(BSON("isMaster" << 1 << "compression" << BSON_ARRAY("noop")
+                                                  << "compressionAdaptive"
+                                                  << true),
+                                  &serverOutput);
+    ASSERT_TRUE(serverManager.isAdaptive());
+
+    auto& stats = adaptiveCompressionStats();
+    const auto skippedSmall = stats.skippedSmall.load();
+    const auto skippedBackoff = stats.skippedBackoff.load();
+    const auto notSmaller = stats.notSmaller.load();
+
+    auto sent = assertOk(serverManager.maybeCompressMessage(buildMessage()));
+    ASSERT_EQ(sent.operation(), dbQuery);
+    ASSERT_EQ(stats.skippedSmall.load(), skippedSmall + 1);
+
+    // The noop compressor never shrinks a message, so each one is sent as is. After four of
+    // them, the next eight are not even compressed.
+    auto large = buildMessage(4096);
+    for (int i = 0; i < 12; ++i) {
+        sent = assertOk(serverManager.maybeCompressMessage(large));
+        ASSERT_EQ(sent.operation(), dbQuery);
+    }
+    ASSERT_EQ(stats.notSmaller.load(), notSmaller + 4);
+    ASSERT_EQ(stats.skippedBackoff.load(), skippedBackoff + 8);
+
+    // Then it tries again.
+    assertOk(serverManager.maybeCompressMessage(large));
+    ASSERT_EQ(stats.notSmaller.load(), notSmaller + 5);
+}
+
 TEST(NoopMessageCompressor, Fidelity) {
     auto testMessage = buildMessage();
     checkFidelity(testMessage, stdx::make_unique<NoopMessageCompressor>());
@@ -241,6 +333,34 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+TEST(ZstdMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, DictionaryFidelity) {
+    auto testMessage = buildMessage();
+    // Anything without the dictionary magic number is used as raw content.
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>("Hello, world! Hello!"));
+}
+
+TEST(ZstdMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZstdMessageCompressor>());
+}
+#endif
+
+#ifdef MONGO_CONFIG_HAVE_LZ4
+TEST(Lz4MessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<Lz4MessageCompressor>());
+}
+
+TEST(Lz4MessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<Lz4MessageCompressor>());
+}
+#endif
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -29,12 +29,14 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/message_compressor_registry.h"
 
 namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMicros = "micros"_sd;
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -51,15 +53,25 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
 
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
         compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+                          << compressor->getCompressorBytesOut() << kMicros
+                          << compressor->getCompressorMicros();
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+                            << compressor->getDecompressorBytesOut() << kMicros
+                            << compressor->getDecompressorMicros();
         decompressorSection.doneFast();
         base.doneFast();
     }
+
+    auto& adaptiveStats = adaptiveCompressionStats();
+    BSONObjBuilder adaptiveSection(compressionSection.subobjStart("adaptive"));
+    adaptiveSection << "skippedSmall" << adaptiveStats.skippedSmall.load() << "skippedBackoff"
+                    << adaptiveStats.skippedBackoff.load() << "notSmaller"
+                    << adaptiveStats.notSmaller.load() << "backoffs"
+                    << adaptiveStats.backoffs.load();
+    adaptiveSection.doneFast();
     compressionSection.doneFast();
 }
 
@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2016 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <zstd.h>
+
+namespace mongo {
+namespace {
+MONGO_EXPORT_SERVER_PARAMETER(zstdCompressionLevel, int, ZSTD_CLEVEL_DEFAULT);
+
+// Dictionary used by the "zstd-dict" compressor, for instance trained with 'zstd --train' from
+// sampled OP_MSG payloads. Every node which negotiates "zstd-dict" must load the same file.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(zstdDictionaryFile, std::string, "");
+
+int compressionLevel() {
+    return std::max(ZSTD_minCLevel(), std::min(zstdCompressionLevel.load(), ZSTD_maxCLevel()));
+}
+
+/*
+ * Contexts hold large work areas, so each thread reuses its own.
+ */
+struct ZstdContexts {
+    ZstdContexts() : cctx(ZSTD_createCCtx()), dctx(ZSTD_createDCtx()) {
+        invariant(cctx && dctx);
+    }
+
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+
+    ZSTD_CCtx* const cctx;
+    ZSTD_DCtx* const dctx;
+};
+
+ZstdContexts& localContexts() {
+    static thread_local ZstdContexts contexts;
+    return contexts;
+}
+}  // namespace
+
+ZstdMessageCompressor::ZstdMessageCompressor() : MessageCompressorBase(MessageCompressor::kZstd) {}
+
+ZstdMessageCompressor::ZstdMessageCompressor(const std::string& dictionary)
+    : MessageCompressorBase(MessageCompressor::kZstdDictionary),
+      _cdict(ZSTD_createCDict(dictionary.data(), dictionary.size(), compressionLevel())),
+      _ddict(ZSTD_createDDict(dictionary.data(), dictionary.size())) {
+    invariant(_cdict && _ddict);
+}
+
+ZstdMessageCompressor::~ZstdMessageCompressor() {
+    ZSTD_freeCDict(_cdict);
+    ZSTD_freeDDict(_ddict);
+}
+
+std::size_t ZstdMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input,
+                                                            DataRange output) {
+    auto& contexts = localContexts();
+    size_t ret;
+    if (_cdict) {
+        ret = ZSTD_compress_usingCDict(contexts.cctx,
+                                       const_cast<char*>(output.data()),
+                                       output.length(),
+                                       input.data(),
+                                       input.length(),
+                                       _cdict);
+    } else {
+        ret = ZSTD_compressCCtx(contexts.cctx,
+                                const_cast<char*>(output.data()),
+                                output.length(),
+                                input.data(),
+                                input.length(),
+                                compressionLevel());
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
+                                                              DataRange output) {
+    auto& contexts = localContexts();
+    size_t ret;
+    if (_ddict) {
+        ret = ZSTD_decompress_usingDDict(contexts.dctx,
+                                         const_cast<char*>(output.data()),
+                                         output.length(),
+                                         input.data(),
+                                         input.length(),
+                                         _ddict);
+    } else {
+        ret = ZSTD_decompressDCtx(contexts.dctx,
+                                  const_cast<char*>(output.data()),
+                                  output.length(),
+                                  input.data(),
+                                  input.length());
+    }
+
+    if (ZSTD_isError(ret) || ret != output.length()) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), output.length());
+    return {output.length()};
+}
+
+
+MONGO_INITIALIZER_GENERAL(ZstdMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(stdx::make_unique<ZstdMessageCompressor>());
+
+    const auto& names = compressorRegistry.getCompressorNames();
+    const auto dictionaryName = getMessageCompressorName(MessageCompressor::kZstdDictionary);
+    if (std::find(names.begin(), names.end(), dictionaryName) == names.end()) {
+        return Status::OK();
+    }
+    if (zstdDictionaryFile.empty()) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "The " << dictionaryName
+                              << " network message compressor requires zstdDictionaryFile"};
+    }
+
+    std::ifstream file(zstdDictionaryFile, std::ios::binary);
+    std::stringstream dictionary;
+    dictionary << file.rdbuf();
+    if (!file || dictionary.str().empty()) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Could not read the zstd dictionary from " << zstdDictionaryFile};
+    }
+    log() << "Loaded a " << dictionary.str().size() << " byte zstd dictionary from "
+          << zstdDictionaryFile;
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZstdMessageCompressor>(dictionary.str()));
+    return Status::OK();
+}
+}  // namespace mongo
@@ -29,8 +29,11 @@
 #pragma once
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/transport/session.h"
+#include "mongo/transport/transport_layer.h"
 
 namespace mongo {
 
@@ -97,6 +100,29 @@ public:
      */
     virtual size_t numOpenSessions() const = 0;
 
+    /**
+     * Appends statistics about the service executors owned by this entry point, if any.
+     */
+    virtual void appendStats(BSONObjBuilder* bob) const {}
+
+    /**
+     * Offers the ingress reactors of the transport layer to the service entry point, whose
+     * executors then run them. Returns false if the reactors must be run by the service
+     * executor of the ServiceContext instead.
+     */
+    virtual bool adoptIngressReactors(const std::vector<transport::ReactorHandle>& reactors) {
+        return false;
+    }
+
+    /**
+     * Runs task once on every thread group of the service executors owned by this entry point
+     * and returns once every run has finished. Returns false, without running task, if this entry
+     * point has no thread groups.
+     */
+    virtual bool runOnEachThreadGroup(const stdx::function<void()>& task) {
+        return false;
+    }
+
     /**
      * Processes a request and fills out a DbResponse.
      */
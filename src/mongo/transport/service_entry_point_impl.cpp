@@ -28,16 +28,20 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/auth/restriction_environment.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/platform/basic.h"
+#include "mongo/transport/admission_controller.h"
 #include "mongo/transport/service_entry_point_impl.h"
 #include "mongo/transport/service_state_machine.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
+#include "mongo/util/periodic_runner.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
@@ -46,6 +50,23 @@
 #endif
 
 namespace mongo {
+namespace {
+// New sessions are placed on the coroutine thread group with the lowest recent load instead of
+// round-robin by connection count.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorLoadAwarePlacement, bool, true);
+
+// How often idle sessions are migrated from the most loaded thread group to the least loaded
+// one. Zero disables rebalancing. Only read at startup.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(coroutineServiceExecutorRebalanceIntervalMillis, int, 1000);
+
+// Sessions are only migrated if the recent load of the two thread groups differs by at least this
+// many queued tasks.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorRebalanceLoadThreshold, int, 2);
+
+// Upper bound of sessions migrated by one rebalancing round.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorRebalanceMaxSessions, int, 8);
+}  // namespace
+
 ServiceEntryPointImpl::ServiceEntryPointImpl(ServiceContext* svcCtx) : _svcCtx(svcCtx) {
 
     const auto supportedMax = [] {
@@ -75,12 +96,26 @@ ServiceEntryPointImpl::ServiceEntryPointImpl(ServiceContext* svcCtx) : _svcCtx(s
     if (serverGlobalParams.enableCoroutine && serverGlobalParams.reservedThreadNum) {
         _coroutineExecutor = std::make_unique<transport::ServiceExecutorCoroutine>(
             _svcCtx, serverGlobalParams.reservedThreadNum);
+        transport::AdmissionController::get().setThreadGroupCount(
+            _coroutineExecutor->threadGroupCount());
     }
 }
 
 Status ServiceEntryPointImpl::start() {
     if (_coroutineExecutor) {
-        return _coroutineExecutor->start();
+        auto status = _coroutineExecutor->start();
+        if (!status.isOK()) {
+            return status;
+        }
+
+        auto interval = coroutineServiceExecutorRebalanceIntervalMillis;
+        auto runner = _svcCtx->getPeriodicRunner();
+        if (interval > 0 && runner && _coroutineExecutor->threadGroupCount() > 1) {
+            runner->scheduleJob({"coroutineSessionRebalancer",
+                                 [this](Client* client) { _rebalanceSessions(); },
+                                 Milliseconds(interval)});
+        }
+        return Status::OK();
     } else
         return Status::OK();
 }
@@ -100,6 +135,40 @@ void ServiceEntryPointImpl::startSession(transport::SessionHandle session) {
     size_t connectionCount;
     auto transportMode = _svcCtx->getServiceExecutor()->transportMode();
 
+    // work balance, decided before the session is registered
+    size_t targetThreadGroupId = 0;
+    if (_coroutineExecutor) {
+        auto& admission = transport::AdmissionController::get();
+        const bool pinned =
+            _coroutineExecutor->pollsIngressReactors() && session->ingressReactorId() >= 0;
+        if (pinned) {
+            // Run-to-completion: the thread group polling the session's reactor also runs it.
+            targetThreadGroupId = session->ingressReactorId();
+        } else if (coroutineServiceExecutorLoadAwarePlacement.load()) {
+            targetThreadGroupId = _coroutineExecutor->leastLoadedThreadGroup();
+        } else {
+            targetThreadGroupId =
+                (_currentConnections.load() + 1) % serverGlobalParams.reservedThreadNum;
+            if (admission.isOverloaded(targetThreadGroupId,
+                                       _coroutineExecutor->threadGroupLoad(targetThreadGroupId))) {
+                auto leastLoaded = _coroutineExecutor->leastLoadedThreadGroup();
+                if (leastLoaded != targetThreadGroupId) {
+                    targetThreadGroupId = leastLoaded;
+                    admission.sessionRedirected();
+                }
+            }
+        }
+
+        // The session is kept rather than closed, so that the client learns about the overload
+        // from the ThreadGroupOverloaded errors its requests fail with until the group recovers.
+        auto status = admission.admitSession(
+            targetThreadGroupId, _coroutineExecutor->threadGroupLoad(targetThreadGroupId));
+        if (!status.isOK() && !quiet) {
+            log() << "connection from " << session->remote() << " #" << session->id()
+                  << " placed on an overloaded thread group: " << status;
+        }
+    }
+
     auto ssm = ServiceStateMachine::create(_svcCtx, session, transportMode);
     {
         stdx::lock_guard<decltype(_sessionsMutex)> lk(_sessionsMutex);
@@ -114,10 +183,8 @@ void ServiceEntryPointImpl::startSession(transport::SessionHandle session) {
     if (_coroutineExecutor) {
         MONGO_LOG(0) << "use coroutine service executor";
         ssm->setServiceExecutor(_coroutineExecutor.get());
-
-        // work balance
-        size_t targetThreadGroupId = connectionCount % serverGlobalParams.reservedThreadNum;
         ssm->setThreadGroupId(targetThreadGroupId);
+        _coroutineExecutor->sessionCountUpdate(targetThreadGroupId, 1);
         MONGO_LOG(0) << "Current ssm is assigned to thread group " << targetThreadGroupId;
     }
 
@@ -144,6 +211,9 @@ void ServiceEntryPointImpl::startSession(transport::SessionHandle session) {
         auto remote = session->remote();
         {
             stdx::lock_guard<decltype(_sessionsMutex)> lk(_sessionsMutex);
+            if (_coroutineExecutor) {
+                _coroutineExecutor->sessionCountUpdate((*ssmIt)->threadGroupId(), -1);
+            }
             _sessions.erase(ssmIt);
             connectionCount = _sessions.size();
             _currentConnections.store(connectionCount);
@@ -218,4 +288,106 @@ ServiceEntryPoint::Stats ServiceEntryPointImpl::sessionStats() const {
     return ret;
 }
 
+bool ServiceEntryPointImpl::adoptIngressReactors(
+    const std::vector<transport::ReactorHandle>& reactors) {
+    if (!_coroutineExecutor || !serverGlobalParams.runToCompletion ||
+        reactors.size() != _coroutineExecutor->threadGroupCount()) {
+        return false;
+    }
+
+    log() << "coroutine thread groups poll " << reactors.size() << " ingress reactors";
+    _coroutineExecutor->setIngressReactors(reactors);
+    return true;
+}
+
+bool ServiceEntryPointImpl::runOnEachThreadGroup(const stdx::function<void()>& task) {
+    if (!_coroutineExecutor) {
+        return false;
+    }
+
+    const size_t threadGroupCount = _coroutineExecutor->threadGroupCount();
+    stdx::mutex mutex;
+    stdx::condition_variable finishedCV;
+    size_t finished = 0;
+    auto finishOne = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        ++finished;
+        finishedCV.notify_one();
+    };
+
+    for (size_t id = 0; id < threadGroupCount; ++id) {
+        auto status = _coroutineExecutor->runOnThreadGroup(id, [&] {
+            task();
+            finishOne();
+        });
+        if (!status.isOK()) {
+            warning() << "Could not run a task on thread group " << id << causedBy(status);
+            finishOne();
+        }
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    finishedCV.wait(lk, [&] { return finished == threadGroupCount; });
+    return true;
+}
+
+void ServiceEntryPointImpl::_rebalanceSessions() {
+    // A migrated session would still have its network I/O run by its former thread group.
+    if (_coroutineExecutor->pollsIngressReactors()) {
+        return;
+    }
+
+    auto from = _coroutineExecutor->mostLoadedThreadGroup();
+    auto to = _coroutineExecutor->leastLoadedThreadGroup();
+    if (from == to) {
+        return;
+    }
+
+    auto threshold = static_cast<uint32_t>(
+        std::max(0, coroutineServiceExecutorRebalanceLoadThreshold.load()) *
+        transport::ServiceExecutorCoroutine::kLoadScale);
+    if (_coroutineExecutor->threadGroupLoad(from) <
+        _coroutineExecutor->threadGroupLoad(to) + threshold) {
+        return;
+    }
+
+    // Moving more than half of the difference would just make the target the new hot spot.
+    auto fromSessions = _coroutineExecutor->threadGroupSessionCount(from);
+    auto toSessions = _coroutineExecutor->threadGroupSessionCount(to);
+    if (fromSessions <= toSessions + 1) {
+        return;
+    }
+    size_t budget =
+        std::min<size_t>(std::max(0, coroutineServiceExecutorRebalanceMaxSessions.load()),
+                         (fromSessions - toSessions) / 2);
+
+    size_t migrated = 0;
+    {
+        stdx::lock_guard<decltype(_sessionsMutex)> lk(_sessionsMutex);
+        for (auto& ssm : _sessions) {
+            if (migrated >= budget) {
+                break;
+            }
+            if (ssm->threadGroupId() == from && ssm->migrateThreadGroup(to)) {
+                _coroutineExecutor->sessionMigrated(from, to);
+                ++migrated;
+            }
+        }
+    }
+
+    if (migrated > 0) {
+        LOG(1) << "Migrated " << migrated << " idle sessions from thread group " << from
+               << " to thread group " << to;
+    }
+}
+
+void ServiceEntryPointImpl::appendStats(BSONObjBuilder* bob) const {
+    if (_coroutineExecutor) {
+        _coroutineExecutor->appendStats(bob);
+    }
+
+    BSONObjBuilder admission(bob->subobjStart("admissionControl"));
+    transport::AdmissionController::get().appendStats(&admission);
+}
+
 }  // namespace mongo
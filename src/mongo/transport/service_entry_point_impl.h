@@ -71,10 +71,21 @@ public:
         return _currentConnections.load();
     }
 
+    void appendStats(BSONObjBuilder* bob) const override;
+
+    bool adoptIngressReactors(const std::vector<transport::ReactorHandle>& reactors) override;
+    bool runOnEachThreadGroup(const stdx::function<void()>& task) override;
+
 private:
     using SSMList = stdx::list<std::shared_ptr<ServiceStateMachine>>;
     using SSMListIterator = SSMList::iterator;
 
+    /**
+     * Migrates idle sessions from the most loaded coroutine thread group to the least loaded one.
+     * Run periodically by the PeriodicRunner.
+     */
+    void _rebalanceSessions();
+
     ServiceContext* const _svcCtx;
     AtomicWord<std::size_t> _nWorkers;
 
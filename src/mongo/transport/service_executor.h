@@ -32,6 +32,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/platform/bitwise_enum_operators.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/transport/coroutine_stack_pool.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/transport/transport_mode.h"
 #include "mongo/util/duration.h"
@@ -112,6 +113,21 @@ public:
     virtual void ongoingCoroutineCountUpdate(uint16_t threadGroupId, int delta){
         // 
     }
+
+    /*
+     * Returns the pool that coroutines started on the given thread group take their stacks from.
+     * Must only be used by the thread running that thread group.
+     */
+    virtual CoroutineStackPool* coroutineStackPool(uint16_t threadGroupId) {
+        return CoroutineStackPool::threadLocal();
+    }
+
+    /*
+     * Recent load of the given thread group, zero for executors without thread groups.
+     */
+    virtual uint32_t threadGroupLoad(uint16_t threadGroupId) const {
+        return 0;
+    }
 };
 
 }  // namespace transport
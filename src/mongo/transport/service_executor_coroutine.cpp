@@ -1,5 +1,6 @@
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -25,23 +26,88 @@ extern std::function<std::pair<std::function<void()>, std::function<void(int16_t
     getTxServiceFunctors;
 
 namespace transport {
-// namespace {
+namespace {
+// Idle thread groups take not-yet-started tasks from the task queues of busy thread groups.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorEnableWorkStealing, bool, true);
+
+// A thread group is only considered as a steal victim if at least this many tasks are waiting
+// in its task queue.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorStealThreshold, int, 2);
+
+// Bounds of the time an idle thread group busy-polls before it starts yielding its core. Within
+// the bounds, the spin time follows twice the recently observed idle gap.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorMinSpinMicros, int, 20);
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorMaxSpinMicros, int, 1000);
+
+// How long an idle thread group yields its core after spinning before it parks.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorYieldMicros, int, 1000);
+
+// Upper bound of a park while coroutines of the thread group wait for the tx service, which only
+// makes progress when the group's thread drives it.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorTxServiceParkMicros, int, 100);
+
+// Maximum number of tasks of each class run by one scheduling round of a thread group. Resumed
+// coroutines come first, then new tasks by priority.
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorResumeBatchSize, int, 100);
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorHighPriorityBatchSize, int, 32);
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorNormalPriorityBatchSize, int, 16);
+MONGO_EXPORT_SERVER_PARAMETER(coroutineServiceExecutorBackgroundPriorityBatchSize, int, 4);
+
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "coroutine"_sd;
+constexpr auto kThreadGroups = "threadGroups"_sd;
+constexpr auto kTaskQueueSize = "taskQueueSize"_sd;
+constexpr auto kResumeQueueSize = "resumeQueueSize"_sd;
+constexpr auto kOngoingCoroutines = "ongoingCoroutines"_sd;
+constexpr auto kTasksStolen = "tasksStolen"_sd;
+constexpr auto kTasksStolenFrom = "tasksStolenFrom"_sd;
+constexpr auto kRecentLoad = "recentLoad"_sd;
+constexpr auto kSessions = "sessions"_sd;
+constexpr auto kSessionsMigratedIn = "sessionsMigratedIn"_sd;
+constexpr auto kStackPool = "stackPool"_sd;
+constexpr auto kTaskQueueSizeByPriority = "taskQueueSizeByPriority"_sd;
+constexpr auto kTasksRun = "tasksRun"_sd;
+constexpr auto kResumesRun = "resumesRun"_sd;
+constexpr auto kTimesParked = "timesParked"_sd;
+constexpr auto kTimeParkedUs = "timeParkedMicros"_sd;
+constexpr auto kTimesParkedWithOngoingCoroutines = "timesParkedWithOngoingCoroutines"_sd;
+constexpr auto kTimeInTxProcessorUs = "timeInTxProcessorMicros"_sd;
+constexpr auto kIdleGapUs = "idleGapMicros"_sd;
+constexpr auto kSpinLimitUs = "spinLimitMicros"_sd;
+constexpr auto kIngressHandlersRun = "ingressHandlersRun"_sd;
+
+// Upper bound of the time a parked thread group waits in its ingress reactor. Bounds the delay
+// of a wake-up lost between the check of the queues and the wait.
+constexpr Milliseconds kIngressReactorParkTime{5};
+
+// Idle gaps longer than this are learned as this value.
+constexpr uint64_t kMaxIdleGapMicros = 1000 * 1000;
+
+size_t resumeQuota() {
+    return static_cast<size_t>(std::max(1, coroutineServiceExecutorResumeBatchSize.load()));
+}
+
+// Counters that only have a single writer do not need an atomic read-modify-write.
+void addRelaxed(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
 
-// // Tasks scheduled with MayRecurse may be called recursively if the recursion depth is below this
-// // value.
-// MONGO_EXPORT_SERVER_PARAMETER(reservedServiceExecutorRecursionLimit, int, 8);
+uint64_t toMicros(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
 
-// constexpr auto kThreadsRunning = "threadsRunning"_sd;
-// constexpr auto kExecutorLabel = "executor"_sd;
-// constexpr auto kExecutorName = "reserved"_sd;
-// constexpr auto kReadyThreads = "readyThreads"_sd;
-// constexpr auto kStartingThreads = "startingThreads"_sd;
-// }  // namespace
+// _recentLoad keeps (1 - 2^-kLoadDecayShift) of its previous value on each sample.
+constexpr uint32_t kLoadDecayShift = 3;
+// Every session bound to a group weighs 1/kSessionWeightDivisor of a queued task.
+constexpr uint32_t kSessionWeightDivisor = 16;
+}  // namespace
 
 
-void ThreadGroup::enqueueTask(Task task) {
+void ThreadGroup::enqueueTask(Task task, ServiceExecutorTaskPriority priority) {
+    TaskLane& lane = _taskLanes[static_cast<size_t>(priority)];
+    lane.size.fetch_add(1, std::memory_order_relaxed);
     _taskQueueSize.fetch_add(1, std::memory_order_relaxed);
-    _taskQueue.enqueue(std::move(task));
+    lane.queue.enqueue(std::move(task));
 
     notifyIfAsleep();
 }
@@ -56,20 +122,104 @@ void ThreadGroup::resumeTask(Task task) {
 void ThreadGroup::notifyIfAsleep() {
     if (_isSleep.load(std::memory_order_relaxed)) {
         std::unique_lock<std::mutex> lk(_sleepMutex);
+        _wakeUpLocked();
+    }
+}
+
+bool ThreadGroup::notifyToSteal() {
+    if (!_isSleep.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lk(_sleepMutex);
+    _stealRequested = true;
+    _wakeUpLocked();
+    return true;
+}
+
+void ThreadGroup::_wakeUpLocked() {
+    if (_ingressReactor) {
+        // Makes the reactor wait of the parked thread return.
+        _ingressReactor->schedule(Reactor::kPost, [] {});
+    } else {
         _sleepCV.notify_one();
     }
 }
 
+size_t ThreadGroup::pollIngressReactor() {
+    if (!_ingressReactor) {
+        return 0;
+    }
+    size_t cnt = _ingressReactor->poll();
+    addRelaxed(_ioHandlerCnt, cnt);
+    return cnt;
+}
+
 void ThreadGroup::setTxServiceFunctors(int16_t id) {
     std::tie(_txProcessorExec, _updateExtProc) = getTxServiceFunctors(id);
 }
 
 bool ThreadGroup::isBusy() const {
-    return (_ongoingCoroutineCnt > 0) || (_taskQueueSize.load(std::memory_order_relaxed) > 0) ||
+    return (_ongoingCoroutineCnt.load(std::memory_order_relaxed) > 0) || hasQueuedTasks();
+}
+
+bool ThreadGroup::hasQueuedTasks() const {
+    return (_taskQueueSize.load(std::memory_order_relaxed) > 0) ||
         (_resumeQueueSize.load(std::memory_order_relaxed) > 0);
 }
 
-void ThreadGroup::trySleep() {
+size_t ThreadGroup::dequeueTasks(ServiceExecutorTaskPriority priority,
+                                 Task* tasks,
+                                 size_t maxCnt) {
+    TaskLane& lane = _taskLanes[static_cast<size_t>(priority)];
+    if (maxCnt == 0 || lane.size.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    size_t cnt = lane.queue.try_dequeue_bulk(tasks, maxCnt);
+    if (cnt > 0) {
+        lane.size.fetch_sub(cnt);
+        _taskQueueSize.fetch_sub(cnt);
+    }
+    return cnt;
+}
+
+size_t ThreadGroup::stealTasks(Task* tasks, size_t maxCnt) {
+    // Leaves at least half of the queued tasks to the owner so that the owner and the thief do
+    // not keep bouncing the same backlog between each other.
+    size_t queued = _taskQueueSize.load(std::memory_order_relaxed);
+    size_t budget = std::min(maxCnt, (queued + 1) / 2);
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < kTaskLaneCnt && cnt < budget; ++i) {
+        cnt += dequeueTasks(static_cast<ServiceExecutorTaskPriority>(i), tasks + cnt, budget - cnt);
+    }
+    if (cnt > 0) {
+        _stolenCnt.fetch_add(cnt, std::memory_order_relaxed);
+    }
+    return cnt;
+}
+
+void ThreadGroup::sampleLoad() {
+    uint32_t cur = _ongoingCoroutineCnt.load(std::memory_order_relaxed) +
+        _taskQueueSize.load(std::memory_order_relaxed) +
+        _resumeQueueSize.load(std::memory_order_relaxed);
+    uint32_t prev = _recentLoad.load(std::memory_order_relaxed);
+    uint32_t next = prev - (prev >> kLoadDecayShift) +
+        ((cur * ServiceExecutorCoroutine::kLoadScale) >> kLoadDecayShift);
+    _recentLoad.store(next, std::memory_order_relaxed);
+}
+
+uint64_t ThreadGroup::placementScore() const {
+    return static_cast<uint64_t>(_recentLoad.load(std::memory_order_relaxed)) +
+        _sessionCnt.load(std::memory_order_relaxed) *
+        (ServiceExecutorCoroutine::kLoadScale / kSessionWeightDivisor);
+}
+
+void ThreadGroup::trySleep(Microseconds maxPark) {
+    const bool bounded = maxPark != Microseconds::max();
+    // A bounded park is taken while coroutines are ongoing, so only queued tasks end it early.
+    auto hasWork = [&] { return bounded ? hasQueuedTasks() : isBusy(); };
+
     // If there are tasks in the , does not sleep.
     // if (isBusy()) {
     //     return;
@@ -93,16 +243,41 @@ void ThreadGroup::trySleep() {
 
     // Double checkes again in the critical section before going to sleep. If additional tasks
     // are enqueued, does not sleep.
-    if (isBusy()) {
+    if (hasWork()) {
         _isSleep.store(false, std::memory_order_relaxed);
         return;
     }
 
-    MONGO_LOG(0) << "sleep";
+    MONGO_LOG(3) << "sleep";
 #ifdef EXT_TX_PROC_ENABLED
     _updateExtProc(-1);
 #endif
-    _sleepCV.wait(lk, [this] { return isBusy(); });
+    auto parkStart = Clock::now();
+    auto mustWake = [&] {
+        return hasWork() || _stealRequested || _isTerminated.load(std::memory_order_relaxed);
+    };
+    if (_ingressReactor) {
+        // The reactor waits in milliseconds.
+        const auto parkTime = bounded
+            ? std::max(Milliseconds(1), duration_cast<Milliseconds>(maxPark))
+            : kIngressReactorParkTime;
+        lk.unlock();
+        addRelaxed(_ioHandlerCnt,
+                   _ingressReactor->runOneFor(std::min(parkTime, kIngressReactorParkTime)));
+        lk.lock();
+    } else if (bounded) {
+        _sleepCV.wait_for(lk, maxPark.toSystemDuration(), mustWake);
+    } else {
+        _sleepCV.wait(lk, mustWake);
+    }
+    _stealRequested = false;
+    addRelaxed(_parkCnt, 1);
+    if (bounded) {
+        addRelaxed(_boundedParkCnt, 1);
+    }
+    addRelaxed(_parkNanos,
+               std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - parkStart)
+                   .count());
 
     // Woken up from sleep.
 #ifdef EXT_TX_PROC_ENABLED
@@ -111,10 +286,57 @@ void ThreadGroup::trySleep() {
     _isSleep.store(false, std::memory_order_relaxed);
 }
 
+uint64_t ThreadGroup::spinLimitMicros() const {
+    const uint64_t minSpin = std::max(0, coroutineServiceExecutorMinSpinMicros.load());
+    const uint64_t maxSpin = std::max(0, coroutineServiceExecutorMaxSpinMicros.load());
+    const uint64_t spin = 2 * _idleGapMicros.load(std::memory_order_relaxed);
+
+    // If work usually arrives later than we are willing to spin, spinning only wastes the core.
+    return spin <= maxSpin ? std::max(spin, minSpin) : minSpin;
+}
+
+void ThreadGroup::idle(Clock::time_point now) {
+    if (!_idling) {
+        _idling = true;
+        _idleStartTime = now;
+        return;
+    }
+
+    const uint64_t idleMicros = toMicros(now - _idleStartTime);
+    const uint64_t spinMicros = spinLimitMicros();
+    if (idleMicros < spinMicros) {
+        return;
+    }
+
+    if (idleMicros < spinMicros + std::max(0, coroutineServiceExecutorYieldMicros.load())) {
+        std::this_thread::yield();
+        return;
+    }
+
+    // Coroutines waiting for the tx service are only driven by _txProcessorExec on this thread, so
+    // the thread must come back to it soon.
+    if (_ongoingCoroutineCnt.load(std::memory_order_relaxed) > 0) {
+        trySleep(Microseconds(std::max(1, coroutineServiceExecutorTxServiceParkMicros.load())));
+    } else {
+        trySleep(Microseconds::max());
+    }
+}
+
+void ThreadGroup::busy(Clock::time_point now) {
+    if (!_idling) {
+        return;
+    }
+    _idling = false;
+
+    const uint64_t gap = std::min(toMicros(now - _idleStartTime), kMaxIdleGapMicros);
+    const uint64_t prev = _idleGapMicros.load(std::memory_order_relaxed);
+    _idleGapMicros.store(prev - prev / 8 + gap / 8, std::memory_order_relaxed);
+}
+
 void ThreadGroup::terminate() {
     _isTerminated.store(true, std::memory_order_relaxed);
     std::unique_lock<std::mutex> lk(_sleepMutex);
-    _sleepCV.notify_one();
+    _wakeUpLocked();
 }
 
 
@@ -173,27 +395,49 @@ Status ServiceExecutorCoroutine::_startWorker(int16_t groupId) {
 #endif
         std::array<Task, kTaskBatchSize> taskBulk;
         size_t idleCnt = 0;
-        std::chrono::steady_clock::time_point idleStartTime;
         while (_stillRunning.load(std::memory_order_relaxed)) {
             if (!_stillRunning.load(std::memory_order_relaxed)) {
                 break;
             }
 
-            size_t cnt = 0;
+            // One scheduling round serves the resume queue and then every task lane in priority
+            // order, each up to its batch quota. Every non-empty class makes progress in every
+            // round, and the tx processor runs at least once per bounded round.
+            // In run-to-completion mode, network events come first. Their handlers schedule the
+            // requests they complete on this group, which runs them in the same round.
+            size_t cnt = threadGroup.pollIngressReactor();
             // process resume task
             if (threadGroup._resumeQueueSize.load(std::memory_order_relaxed) > 0) {
-                cnt = threadGroup._resumeQueue.try_dequeue_bulk(taskBulk.begin(), taskBulk.size());
-                threadGroup._resumeQueueSize.fetch_sub(cnt);
-                for (size_t i = 0; i < cnt; ++i) {
+                size_t resumeCnt = threadGroup._resumeQueue.try_dequeue_bulk(
+                    taskBulk.begin(), std::min(taskBulk.size(), resumeQuota()));
+                threadGroup._resumeQueueSize.fetch_sub(resumeCnt);
+                addRelaxed(threadGroup._resumeCnt, resumeCnt);
+                for (size_t i = 0; i < resumeCnt; ++i) {
                     setThreadName(threadNameSD);
                     taskBulk[i]();
                 }
+                cnt += resumeCnt;
             }
 
-            // process normal task
-            if (cnt == 0 && threadGroup._taskQueueSize.load(std::memory_order_relaxed) > 0) {
-                cnt = threadGroup._taskQueue.try_dequeue_bulk(taskBulk.begin(), taskBulk.size());
-                threadGroup._taskQueueSize.fetch_sub(cnt);
+            // process new task, by priority
+            for (size_t lane = 0; lane < ThreadGroup::kTaskLaneCnt &&
+                 threadGroup._taskQueueSize.load(std::memory_order_relaxed) > 0;
+                 ++lane) {
+                auto priority = static_cast<ServiceExecutorTaskPriority>(lane);
+                size_t taskCnt =
+                    threadGroup.dequeueTasks(priority, taskBulk.begin(), _batchQuota(priority));
+                addRelaxed(threadGroup._taskCnt, taskCnt);
+                for (size_t i = 0; i < taskCnt; ++i) {
+                    setThreadName(threadNameSD);
+                    taskBulk[i]();
+                }
+                cnt += taskCnt;
+            }
+
+            // steal normal task from other busy thread groups
+            if (cnt == 0 && _stealsTasks()) {
+                cnt = _stealTasks(threadGroupId, taskBulk.begin(), kStealBatchSize);
+                addRelaxed(threadGroup._taskCnt, cnt);
                 for (size_t i = 0; i < cnt; ++i) {
                     setThreadName(threadNameSD);
                     taskBulk[i]();
@@ -201,25 +445,25 @@ Status ServiceExecutorCoroutine::_startWorker(int16_t groupId) {
             }
 #ifdef EXT_TX_PROC_ENABLED
             // process as a TxProcessor
+            auto txProcessorStart = ThreadGroup::Clock::now();
             (threadGroup._txProcessorExec)();
+            auto now = ThreadGroup::Clock::now();
+            addRelaxed(threadGroup._txProcessorNanos,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(now - txProcessorStart)
+                           .count());
+#else
+            auto now = ThreadGroup::Clock::now();
 #endif
             if (cnt == 0) {
-                if (idleCnt == 0) {
-                    idleStartTime = std::chrono::steady_clock::now();
-                    MONGO_LOG(3) << "idleStartTime " << idleStartTime.time_since_epoch().count();
-                }
-                idleCnt++;
                 if ((idleCnt & kIdleCycle) == 0) {
-                    // check timeout
-                    auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                        std::chrono::steady_clock::now() - idleStartTime)
-                                        .count();
-                    if (interval > kIdleTimeoutMs) {
-                        threadGroup.trySleep();
-                    }
+                    threadGroup.sampleLoad();
                 }
+                idleCnt++;
+                threadGroup.idle(now);
             } else {
+                threadGroup.sampleLoad();
                 idleCnt = 0;
+                threadGroup.busy(now);
             }
         }
 
@@ -228,6 +472,61 @@ Status ServiceExecutorCoroutine::_startWorker(int16_t groupId) {
 }
 
 
+size_t ServiceExecutorCoroutine::_batchQuota(ServiceExecutorTaskPriority priority) const {
+    int quota = 0;
+    switch (priority) {
+        case ServiceExecutorTaskPriority::kHigh:
+            quota = coroutineServiceExecutorHighPriorityBatchSize.load();
+            break;
+        case ServiceExecutorTaskPriority::kNormal:
+            quota = coroutineServiceExecutorNormalPriorityBatchSize.load();
+            break;
+        case ServiceExecutorTaskPriority::kBackground:
+            quota = coroutineServiceExecutorBackgroundPriorityBatchSize.load();
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+    return std::min(static_cast<size_t>(std::max(1, quota)), kTaskBatchSize);
+}
+
+bool ServiceExecutorCoroutine::_stealsTasks() const {
+    return !_pollsIngressReactors && coroutineServiceExecutorEnableWorkStealing.load();
+}
+
+size_t ServiceExecutorCoroutine::_stealTasks(int16_t groupId, Task* tasks, size_t maxCnt) {
+    const size_t groupCnt = _threadGroups.size();
+    const size_t threshold =
+        static_cast<size_t>(std::max(1, coroutineServiceExecutorStealThreshold.load()));
+
+    // Scans the other groups starting from the right neighbour so that thieves spread over
+    // different victims instead of all hammering group 0.
+    for (size_t offset = 1; offset < groupCnt; ++offset) {
+        ThreadGroup& victim = _threadGroups[(groupId + offset) % groupCnt];
+        if (victim._taskQueueSize.load(std::memory_order_relaxed) < threshold) {
+            continue;
+        }
+
+        size_t cnt = victim.stealTasks(tasks, maxCnt);
+        if (cnt > 0) {
+            _threadGroups[groupId]._stealCnt.fetch_add(cnt, std::memory_order_relaxed);
+            MONGO_LOG(3) << "thread group " << groupId << " stole " << cnt
+                         << " tasks from thread group " << (groupId + offset) % groupCnt;
+            return cnt;
+        }
+    }
+    return 0;
+}
+
+void ServiceExecutorCoroutine::_wakeThief(uint16_t groupId) {
+    const size_t groupCnt = _threadGroups.size();
+    for (size_t offset = 1; offset < groupCnt; ++offset) {
+        if (_threadGroups[(groupId + offset) % groupCnt].notifyToSteal()) {
+            return;
+        }
+    }
+}
+
 Status ServiceExecutorCoroutine::shutdown(Milliseconds timeout) {
     LOG(0) << "Shutting down coroutine executor";
 
@@ -295,7 +594,16 @@ Status ServiceExecutorCoroutine::schedule(Task task,
     //     return Status::OK();
     // }
 
-    _threadGroups[threadGroupId].enqueueTask(std::move(task));
+    ThreadGroup& threadGroup = _threadGroups[threadGroupId];
+    threadGroup.enqueueTask(std::move(task), taskNameToPriority(taskName));
+
+    // Parked groups do not poll for work to steal, so one of them is woken up once the backlog
+    // of the target group is worth stealing from.
+    if (_stealsTasks() &&
+        threadGroup._taskQueueSize.load(std::memory_order_relaxed) >=
+            static_cast<size_t>(std::max(1, coroutineServiceExecutorStealThreshold.load()))) {
+        _wakeThief(threadGroupId);
+    }
 
     return Status::OK();
 }
@@ -308,16 +616,133 @@ std::function<void()> ServiceExecutorCoroutine::coroutineResumeFunctor(uint16_t
     };
 }
 
+Status ServiceExecutorCoroutine::runOnThreadGroup(uint16_t threadGroupId, Task task) {
+    if (!_stillRunning.load(std::memory_order_relaxed)) {
+        return Status{ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+    invariant(threadGroupId < _threadGroups.size());
+    _threadGroups[threadGroupId].resumeTask(std::move(task));
+    return Status::OK();
+}
+
 void ServiceExecutorCoroutine::ongoingCoroutineCountUpdate(uint16_t threadGroupId, int delta) {
-    _threadGroups[threadGroupId]._ongoingCoroutineCnt += delta;
+    _threadGroups[threadGroupId]._ongoingCoroutineCnt.fetch_add(delta, std::memory_order_relaxed);
+}
+
+CoroutineStackPool* ServiceExecutorCoroutine::coroutineStackPool(uint16_t threadGroupId) {
+    return &_threadGroups[threadGroupId]._stackPool;
+}
+
+void ServiceExecutorCoroutine::setIngressReactors(const std::vector<ReactorHandle>& reactors) {
+    invariant(!_stillRunning.load());
+    invariant(reactors.size() == _threadGroups.size());
+    for (size_t i = 0; i < reactors.size(); ++i) {
+        _threadGroups[i]._ingressReactor = reactors[i];
+    }
+    _pollsIngressReactors = true;
+}
+
+uint16_t ServiceExecutorCoroutine::leastLoadedThreadGroup() const {
+    uint16_t target = 0;
+    for (uint16_t i = 1; i < _threadGroups.size(); ++i) {
+        if (_threadGroups[i].placementScore() < _threadGroups[target].placementScore()) {
+            target = i;
+        }
+    }
+    return target;
+}
+
+uint16_t ServiceExecutorCoroutine::mostLoadedThreadGroup() const {
+    uint16_t target = 0;
+    for (uint16_t i = 1; i < _threadGroups.size(); ++i) {
+        if (_threadGroups[i].placementScore() > _threadGroups[target].placementScore()) {
+            target = i;
+        }
+    }
+    return target;
+}
+
+uint32_t ServiceExecutorCoroutine::threadGroupLoad(uint16_t threadGroupId) const {
+    return _threadGroups[threadGroupId]._recentLoad.load(std::memory_order_relaxed);
+}
+
+uint32_t ServiceExecutorCoroutine::threadGroupSessionCount(uint16_t threadGroupId) const {
+    return _threadGroups[threadGroupId]._sessionCnt.load(std::memory_order_relaxed);
+}
+
+void ServiceExecutorCoroutine::sessionCountUpdate(uint16_t threadGroupId, int delta) {
+    _threadGroups[threadGroupId]._sessionCnt.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void ServiceExecutorCoroutine::sessionMigrated(uint16_t fromThreadGroupId,
+                                               uint16_t toThreadGroupId) {
+    sessionCountUpdate(fromThreadGroupId, -1);
+    sessionCountUpdate(toThreadGroupId, 1);
+    _threadGroups[toThreadGroupId]._migratedInCnt.fetch_add(1, std::memory_order_relaxed);
 }
 
 void ServiceExecutorCoroutine::appendStats(BSONObjBuilder* bob) const {
-    // stdx::lock_guard<stdx::mutex> lk(_mutex);
-    // *bob << kExecutorLabel << kExecutorName << kThreadsRunning
-    //      << static_cast<int>(_numRunningWorkerThreads.loadRelaxed()) << kReadyThreads;
-    //  << static_cast<int>(_numReadyThreads) << kStartingThreads
-    //  << static_cast<int>(_numStartingThreads);
+    BSONObjBuilder section(bob->subobjStart("coroutineExecutorStats"));
+    section << kExecutorLabel << kExecutorName;
+
+    BSONArrayBuilder groups(section.subarrayStart(kThreadGroups));
+    for (const ThreadGroup& threadGroup : _threadGroups) {
+        BSONObjBuilder group(groups.subobjStart());
+        group << kTaskQueueSize
+              << static_cast<long long>(threadGroup._taskQueueSize.load(std::memory_order_relaxed))
+              << kResumeQueueSize
+              << static_cast<long long>(
+                     threadGroup._resumeQueueSize.load(std::memory_order_relaxed))
+              << kOngoingCoroutines
+              << static_cast<int>(threadGroup._ongoingCoroutineCnt.load(std::memory_order_relaxed))
+              << kTasksStolen
+              << static_cast<long long>(threadGroup._stealCnt.load(std::memory_order_relaxed))
+              << kTasksStolenFrom
+              << static_cast<long long>(threadGroup._stolenCnt.load(std::memory_order_relaxed))
+              << kRecentLoad
+              << static_cast<double>(threadGroup._recentLoad.load(std::memory_order_relaxed)) /
+                kLoadScale
+              << kSessions
+              << static_cast<long long>(threadGroup._sessionCnt.load(std::memory_order_relaxed))
+              << kSessionsMigratedIn
+              << static_cast<long long>(
+                     threadGroup._migratedInCnt.load(std::memory_order_relaxed));
+        group << kTasksRun
+              << static_cast<long long>(threadGroup._taskCnt.load(std::memory_order_relaxed))
+              << kResumesRun
+              << static_cast<long long>(threadGroup._resumeCnt.load(std::memory_order_relaxed))
+              << kTimesParked
+              << static_cast<long long>(threadGroup._parkCnt.load(std::memory_order_relaxed))
+              << kTimeParkedUs
+              << static_cast<long long>(threadGroup._parkNanos.load(std::memory_order_relaxed) /
+                                        1000)
+              << kTimesParkedWithOngoingCoroutines
+              << static_cast<long long>(threadGroup._boundedParkCnt.load(std::memory_order_relaxed))
+              << kTimeInTxProcessorUs
+              << static_cast<long long>(
+                     threadGroup._txProcessorNanos.load(std::memory_order_relaxed) / 1000)
+              << kIdleGapUs
+              << static_cast<long long>(threadGroup._idleGapMicros.load(std::memory_order_relaxed))
+              << kSpinLimitUs << static_cast<long long>(threadGroup.spinLimitMicros());
+        if (_pollsIngressReactors) {
+            group << kIngressHandlersRun
+                  << static_cast<long long>(
+                         threadGroup._ioHandlerCnt.load(std::memory_order_relaxed));
+        }
+        BSONObjBuilder lanes(group.subobjStart(kTaskQueueSizeByPriority));
+        for (size_t lane = 0; lane < ThreadGroup::kTaskLaneCnt; ++lane) {
+            lanes << taskPriorityToString(static_cast<ServiceExecutorTaskPriority>(lane))
+                  << static_cast<long long>(
+                         threadGroup._taskLanes[lane].size.load(std::memory_order_relaxed));
+        }
+        lanes.doneFast();
+        BSONObjBuilder stackPool(group.subobjStart(kStackPool));
+        threadGroup._stackPool.appendStats(&stackPool);
+        stackPool.doneFast();
+        group.doneFast();
+    }
+    groups.doneFast();
+    section.doneFast();
 }
 
 }  // namespace transport
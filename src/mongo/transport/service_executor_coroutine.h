@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string_view>
@@ -9,8 +11,10 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/transport/coroutine_stack_pool.h"
 #include "mongo/transport/service_executor.h"
 #include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/transport_layer.h"
 
 #include <bthread/moodycamelqueue.h>
 
@@ -19,17 +23,48 @@ namespace mongo::transport {
 class ThreadGroup {
     friend class ServiceExecutorCoroutine;
     using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
 
 public:
-    void enqueueTask(Task task);
+    void enqueueTask(Task task,
+                     ServiceExecutorTaskPriority priority = ServiceExecutorTaskPriority::kNormal);
     void resumeTask(Task task);
 
     void notifyIfAsleep();
 
     /**
-     * @brief Called by the thread bound to this thread group.
+     * @brief Called by the thread bound to this thread group. Runs the network handlers of the
+     * group's ingress reactor which are ready, if the group polls one.
      */
-    void trySleep();
+    size_t pollIngressReactor();
+
+    /**
+     * Wakes the thread bound to this thread group up if it is asleep, so that it can steal tasks
+     * from a busy group. Returns false if the thread was not asleep.
+     */
+    bool notifyToSteal();
+
+    /**
+     * @brief Called by the thread bound to this thread group. Parks the thread until tasks are
+     * queued, or for at most 'maxPark' if it is not Microseconds::max().
+     */
+    void trySleep(Microseconds maxPark);
+
+    /**
+     * @brief Called by the thread bound to this thread group after a loop iteration that ran no
+     * task. Spins, yields or parks depending on how long the group has been idle and on the idle
+     * gaps observed recently: if work usually arrives within the spin budget, spinning catches it
+     * without a wake-up, otherwise the thread parks early instead of burning the core. While
+     * coroutines of the group are ongoing, parks are short so that the tx service keeps being
+     * driven.
+     */
+    void idle(Clock::time_point now);
+
+    /**
+     * @brief Called by the thread bound to this thread group after a loop iteration that ran
+     * tasks. Learns the length of the idle gap that just ended.
+     */
+    void busy(Clock::time_point now);
 
     void terminate();
 
@@ -38,9 +73,50 @@ public:
 private:
     bool isBusy() const;
 
+    bool hasQueuedTasks() const;
+
+    /**
+     * @brief Dequeues at most maxCnt not-yet-started tasks of the given priority.
+     */
+    size_t dequeueTasks(ServiceExecutorTaskPriority priority, Task* tasks, size_t maxCnt);
+
+    /**
+     * @brief Called by the thread bound to another thread group. Dequeues at most maxCnt
+     * not-yet-started tasks, highest priority first, so that the idle caller can run them.
+     * Resumed coroutines are never stolen, they always go back to the group that started them.
+     */
+    size_t stealTasks(Task* tasks, size_t maxCnt);
+
+    /**
+     * @brief Called by the thread bound to this thread group. Folds the current queue depth and
+     * ongoing coroutine count into _recentLoad.
+     */
+    void sampleLoad();
+
+    /**
+     * Placement score: the recent load, with the number of bound sessions as a tie breaker.
+     */
+    uint64_t placementScore() const;
+
+    uint64_t spinLimitMicros() const;
+
+    /**
+     * Wakes the parked thread up. Must be called with _sleepMutex held.
+     */
+    void _wakeUpLocked();
+
     // uint16_t id;
 
-    moodycamel::ConcurrentQueue<Task> _taskQueue;
+    struct TaskLane {
+        moodycamel::ConcurrentQueue<Task> queue;
+        std::atomic<size_t> size{0};
+    };
+    static constexpr size_t kTaskLaneCnt =
+        static_cast<size_t>(ServiceExecutorTaskPriority::kMaxTaskPriority);
+
+    // One lane per priority class for tasks that have not started yet.
+    std::array<TaskLane, kTaskLaneCnt> _taskLanes;
+    // Total number of tasks in all lanes.
     std::atomic<size_t> _taskQueueSize{0};
     moodycamel::ConcurrentQueue<Task> _resumeQueue;
     std::atomic<size_t> _resumeQueueSize{0};
@@ -49,11 +125,47 @@ private:
     std::mutex _sleepMutex;
     std::condition_variable _sleepCV;
     std::atomic<bool> _isTerminated{false};
-    uint16_t _ongoingCoroutineCnt{0};
+    // Protected by _sleepMutex.
+    bool _stealRequested{false};
+    std::atomic<uint16_t> _ongoingCoroutineCnt{0};
+
+    // Work stealing statistics. _stealCnt counts the tasks this group took from others,
+    // _stolenCnt counts the tasks others took from this group.
+    std::atomic<uint64_t> _stealCnt{0};
+    std::atomic<uint64_t> _stolenCnt{0};
+
+    // Exponentially weighted moving average of queue depth plus ongoing coroutines, in units of
+    // 1/kLoadScale. Only written by the thread bound to this group.
+    std::atomic<uint32_t> _recentLoad{0};
+    // Sessions currently bound to this thread group.
+    std::atomic<uint32_t> _sessionCnt{0};
+    std::atomic<uint64_t> _migratedInCnt{0};
+
+    CoroutineStackPool _stackPool;
+
+    // Ingress reactor polled by this group in run-to-completion mode. While parked, the thread
+    // waits in the reactor instead of on _sleepCV, so that network events still wake it up.
+    ReactorHandle _ingressReactor;
+    std::atomic<uint64_t> _ioHandlerCnt{0};
 
     std::atomic<uint64_t> _tickCnt{0};
     static constexpr uint64_t kTrySleepTimeOut = 5;
 
+    // Idle policy state, only touched by the thread bound to this group.
+    bool _idling{false};
+    Clock::time_point _idleStartTime;
+    // Exponentially weighted moving average of recent idle gaps, in microseconds.
+    std::atomic<uint64_t> _idleGapMicros{0};
+
+    // Statistics, only written by the thread bound to this group.
+    std::atomic<uint64_t> _taskCnt{0};
+    std::atomic<uint64_t> _resumeCnt{0};
+    std::atomic<uint64_t> _parkCnt{0};
+    std::atomic<uint64_t> _parkNanos{0};
+    // Parks bounded because coroutines were ongoing.
+    std::atomic<uint64_t> _boundedParkCnt{0};
+    std::atomic<uint64_t> _txProcessorNanos{0};
+
     std::function<void()> _txProcessorExec;
     std::function<void(int16_t)> _updateExtProc;
 };
@@ -87,12 +199,78 @@ public:
         return Mode::kAsynchronous;
     }
     std::function<void()> coroutineResumeFunctor(uint16_t threadGroupId, Task task) override;
+
+    /**
+     * Runs task on the thread of the given thread group. Unlike schedule(), the task is never
+     * stolen by another group, so it may build state owned by this group.
+     */
+    Status runOnThreadGroup(uint16_t threadGroupId, Task task);
+
     void ongoingCoroutineCountUpdate(uint16_t threadGroupId, int delta) override;
+    CoroutineStackPool* coroutineStackPool(uint16_t threadGroupId) override;
+
+    /**
+     * Run-to-completion mode: thread group i polls reactors[i] within its own loop, so that the
+     * network I/O and the processing of the sessions bound to it run on the same thread. Must be
+     * called before start(), with one reactor per thread group.
+     */
+    void setIngressReactors(const std::vector<ReactorHandle>& reactors);
+
+    bool pollsIngressReactors() const {
+        return _pollsIngressReactors;
+    }
     void appendStats(BSONObjBuilder* bob) const override;
 
+    size_t threadGroupCount() const {
+        return _threadGroups.size();
+    }
+
+    /**
+     * Returns the thread group with the lowest recent queue depth and ongoing coroutine count.
+     * Ties are broken by the number of sessions bound to each group.
+     */
+    uint16_t leastLoadedThreadGroup() const;
+    uint16_t mostLoadedThreadGroup() const;
+
+    /**
+     * Recent load of a thread group, in units of 1/kLoadScale tasks.
+     */
+    uint32_t threadGroupLoad(uint16_t threadGroupId) const override;
+    uint32_t threadGroupSessionCount(uint16_t threadGroupId) const;
+
+    /**
+     * Bookkeeping of the sessions bound to each thread group, used by placement.
+     */
+    void sessionCountUpdate(uint16_t threadGroupId, int delta);
+    void sessionMigrated(uint16_t fromThreadGroupId, uint16_t toThreadGroupId);
+
+    constexpr static uint32_t kLoadScale{256};
+
 private:
     Status _startWorker(int16_t groupId);
 
+    /**
+     * Maximum number of tasks of the given priority run by one scheduling round.
+     */
+    size_t _batchQuota(ServiceExecutorTaskPriority priority) const;
+
+    /**
+     * Whether idle thread groups steal tasks. In run-to-completion mode they never do, since the
+     * tasks of a session must run on the thread group polling its reactor.
+     */
+    bool _stealsTasks() const;
+
+    /**
+     * Tries to steal new tasks from the other thread groups on behalf of the idle group groupId.
+     * Returns the number of tasks placed into tasks.
+     */
+    size_t _stealTasks(int16_t groupId, Task* tasks, size_t maxCnt);
+
+    /**
+     * Wakes one sleeping thread group up to steal from groupId, whose task queue is backing up.
+     */
+    void _wakeThief(uint16_t groupId);
+
     // static thread_local std::deque<Task> _localWorkQueue;
     // static thread_local int _localRecursionDepth;
     // static thread_local int64_t _localThreadIdleCounter;
@@ -106,14 +284,15 @@ private:
     // AtomicUInt32 _numRunningWorkerThreads{0};
 
     const size_t _reservedThreads;
+    bool _pollsIngressReactors{false};
 
     std::vector<ThreadGroup> _threadGroups;
     // std::thread _backgroundTimeService;
 
     constexpr static std::string_view _name{"coroutine"};
     constexpr static size_t kTaskBatchSize{100};
+    constexpr static size_t kStealBatchSize{16};
     constexpr static uint32_t kIdleCycle = (1 << 10) - 1;  // 2^n-1
-    constexpr static uint32_t kIdleTimeoutMs = 1000;
 };
 
 }  // namespace mongo::transport
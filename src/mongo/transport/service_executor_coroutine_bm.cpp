@@ -0,0 +1,329 @@
+#include "mongo/platform/basic.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <boost/context/continuation.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/object_pool.h"
+#include "mongo/db/client.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/service_context.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/coroutine_stack_pool.h"
+#include "mongo/transport/mock_session.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_executor_coroutine.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/service_state_machine.h"
+#include "mongo/transport/transport_layer_mock.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+extern std::function<std::pair<std::function<void()>, std::function<void(int16_t)>>(int16_t)>
+    getTxServiceFunctors;
+
+namespace {
+using namespace transport;
+
+const int kMaxThreadGroups = 16;
+
+// Stacks come from a CoroutineStackPool, as in the ServiceStateMachine.
+class NoopStackAllocator {
+public:
+    boost::context::stack_context allocate() {
+        return boost::context::stack_context();
+    }
+
+    void deallocate(boost::context::stack_context& sc) {}
+};
+
+/**
+ * Answers every request with {ok: 1} without running a command.
+ */
+class StubSEP : public ServiceEntryPoint {
+public:
+    void startSession(SessionHandle session) override {}
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        OpMsgBuilder builder;
+        builder.setBody(BSON("ok" << 1));
+        return DbResponse{builder.finish()};
+    }
+
+    void endAllSessions(Session::TagMask tags) override {}
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        return 0;
+    }
+};
+
+/**
+ * Sources the same ping request 'requests' times, then reports the session as closed.
+ */
+class PingSession : public MockSession {
+public:
+    PingSession(TransportLayer* tl, int requests) : MockSession(tl), _remaining(requests) {
+        OpMsgBuilder builder;
+        builder.setBody(BSON("ping" << 1));
+        _request = builder.finish();
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        if (_remaining-- <= 0) {
+            return TransportLayer::TicketSessionClosedStatus;
+        }
+        return _request;
+    }
+
+    Status sinkMessage(Message message) override {
+        return Status::OK();
+    }
+
+private:
+    int _remaining;
+    Message _request;
+};
+
+ServiceContext* benchmarkServiceContext() {
+    static ServiceContext* const serviceContext = [] {
+        // There is no tx service in this benchmark, every thread group gets no-op functors.
+        getTxServiceFunctors = [](int16_t) {
+            return std::make_pair(std::function<void()>([] {}),
+                                  std::function<void(int16_t)>([](int16_t) {}));
+        };
+
+        setGlobalServiceContext(ServiceContext::make());
+        auto sc = getGlobalServiceContext();
+        sc->setServiceEntryPoint(stdx::make_unique<StubSEP>());
+        sc->setTransportLayer(stdx::make_unique<TransportLayerMock>());
+        return sc;
+    }();
+    return serviceContext;
+}
+
+std::unique_ptr<ServiceExecutorCoroutine> startExecutor(size_t threadGroups) {
+    auto executor =
+        stdx::make_unique<ServiceExecutorCoroutine>(benchmarkServiceContext(), threadGroups);
+    uassertStatusOK(executor->start());
+    return executor;
+}
+
+void stopExecutor(std::unique_ptr<ServiceExecutorCoroutine> executor) {
+    uassertStatusOK(executor->shutdown(Seconds(10)));
+    // The worker threads are detached and may still touch their thread groups after shutdown()
+    // returns, so the executor is intentionally leaked.
+    executor.release();
+}
+
+void BM_coroutineSwitch(benchmark::State& state) {
+    CoroutineStackPool pool;
+    auto stack = pool.allocate();
+    bool done = false;
+
+    boost::context::preallocated prealloc(stack.sp, stack.size, stack);
+    auto coro = boost::context::callcc(std::allocator_arg,
+                                       prealloc,
+                                       NoopStackAllocator(),
+                                       [&done](boost::context::continuation&& sink) {
+                                           while (!done) {
+                                               sink = sink.resume();
+                                           }
+                                           return std::move(sink);
+                                       });
+
+    // Each iteration resumes the coroutine and switches back, as a yield followed by a resume.
+    for (auto _ : state) {
+        coro = coro.resume();
+    }
+
+    done = true;
+    coro = coro.resume();
+    invariant(!coro);
+    pool.deallocate(stack);
+}
+
+void BM_coroutineStartFinish(benchmark::State& state) {
+    CoroutineStackPool pool;
+
+    for (auto _ : state) {
+        auto stack = pool.allocate();
+        boost::context::preallocated prealloc(stack.sp, stack.size, stack);
+        auto coro = boost::context::callcc(
+            std::allocator_arg,
+            prealloc,
+            NoopStackAllocator(),
+            [](boost::context::continuation&& sink) { return std::move(sink); });
+        benchmark::DoNotOptimize(coro);
+        pool.deallocate(stack);
+    }
+}
+
+/**
+ * Time from scheduling a task on an idle thread group until it runs, including the wake-up.
+ */
+void BM_enqueueToRun(benchmark::State& state) {
+    auto executor = startExecutor(1);
+
+    std::atomic<bool> ran{false};
+    for (auto _ : state) {
+        ran.store(false, std::memory_order_relaxed);
+        uassertStatusOK(
+            executor->schedule([&ran] { ran.store(true, std::memory_order_release); },
+                               ServiceExecutor::kEmptyFlags,
+                               ServiceExecutorTaskName::kSSMProcessMessage,
+                               0));
+        while (!ran.load(std::memory_order_acquire)) {
+        }
+    }
+
+    stopExecutor(std::move(executor));
+}
+
+/**
+ * Tiny tasks spread over state.range(0) thread groups.
+ */
+void BM_taskThroughput(benchmark::State& state) {
+    const int kTasksPerIteration = 10000;
+    const auto threadGroups = static_cast<uint16_t>(state.range(0));
+    auto executor = startExecutor(threadGroups);
+
+    std::atomic<int> finished{0};
+    for (auto _ : state) {
+        finished.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < kTasksPerIteration; ++i) {
+            uassertStatusOK(executor->schedule(
+                [&finished] { finished.fetch_add(1, std::memory_order_relaxed); },
+                ServiceExecutor::kEmptyFlags,
+                ServiceExecutorTaskName::kSSMProcessMessage,
+                static_cast<uint16_t>(i % threadGroups)));
+        }
+        while (finished.load(std::memory_order_relaxed) < kTasksPerIteration) {
+            stdx::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+
+    stopExecutor(std::move(executor));
+}
+
+/**
+ * Ping requests driven through the ServiceStateMachine, one session per thread group. Every
+ * request goes through source, a coroutine running the stub entry point, and sink.
+ */
+void BM_ssmRequestThroughput(benchmark::State& state) {
+    const int kRequestsPerSession = 1000;
+    const auto threadGroups = static_cast<uint16_t>(state.range(0));
+    auto sc = benchmarkServiceContext();
+    auto executor = startExecutor(threadGroups);
+
+    // Requests run in coroutines regardless of the server options the benchmark was started with.
+    const bool oldEnableCoroutine = serverGlobalParams.enableCoroutine;
+    serverGlobalParams.enableCoroutine = true;
+
+    std::atomic<int> ended{0};
+    for (auto _ : state) {
+        ended.store(0, std::memory_order_relaxed);
+        for (uint16_t group = 0; group < threadGroups; ++group) {
+            auto session = std::make_shared<PingSession>(sc->getTransportLayer(),
+                                                         kRequestsPerSession);
+            auto ssm = ServiceStateMachine::create(sc, session, Mode::kAsynchronous, group);
+            ssm->setServiceExecutor(executor.get());
+            ssm->setCleanupHook([&ended] { ended.fetch_add(1, std::memory_order_release); });
+            ssm->start(ServiceStateMachine::Ownership::kOwned);
+        }
+        while (ended.load(std::memory_order_acquire) < threadGroups) {
+            stdx::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadGroups * kRequestsPerSession);
+
+    stopExecutor(std::move(executor));
+    serverGlobalParams.enableCoroutine = oldEnableCoroutine;
+}
+
+struct PooledObject {
+    void reset() {}
+
+    char payload[512];
+};
+
+/**
+ * Allocates batches of state.range(0) objects with the given cache budgets. With a thread cache
+ * holding a single object, a batch is served by the shared cache if it is large enough, and
+ * otherwise constructs most objects.
+ */
+void runObjectPoolBatches(benchmark::State& state, int threadCacheBytes, int sharedCacheBytes) {
+    const auto batchSize = static_cast<size_t>(state.range(0));
+    const int oldThreadCacheBytes = objectPoolThreadCacheBytes.load();
+    const int oldSharedCacheBytes = objectPoolSharedCacheBytes.load();
+    objectPoolThreadCacheBytes.store(threadCacheBytes);
+    objectPoolSharedCacheBytes.store(sharedCacheBytes);
+
+    std::vector<PooledObject*> batch(batchSize);
+    for (auto _ : state) {
+        for (auto& obj : batch) {
+            obj = ObjectPool<PooledObject>::newObjectRawPointer();
+        }
+        benchmark::ClobberMemory();
+        for (auto obj : batch) {
+            ObjectPool<PooledObject>::recycleObject(obj);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+
+    objectPoolThreadCacheBytes.store(oldThreadCacheBytes);
+    objectPoolSharedCacheBytes.store(oldSharedCacheBytes);
+}
+
+void BM_objectPoolThreadCacheHit(benchmark::State& state) {
+    runObjectPoolBatches(state, 1 << 20, 0);
+}
+
+void BM_objectPoolSharedCacheHit(benchmark::State& state) {
+    runObjectPoolBatches(state, sizeof(PooledObject), 1 << 20);
+}
+
+void BM_objectPoolMiss(benchmark::State& state) {
+    runObjectPoolBatches(state, sizeof(PooledObject), 0);
+}
+
+// Baseline for the object pool benchmarks.
+void BM_newDelete(benchmark::State& state) {
+    const auto batchSize = static_cast<size_t>(state.range(0));
+    std::vector<PooledObject*> batch(batchSize);
+    for (auto _ : state) {
+        for (auto& obj : batch) {
+            obj = new PooledObject();
+        }
+        benchmark::ClobberMemory();
+        for (auto obj : batch) {
+            delete obj;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
+BENCHMARK(BM_coroutineSwitch);
+BENCHMARK(BM_coroutineStartFinish);
+BENCHMARK(BM_enqueueToRun)->UseRealTime();
+BENCHMARK(BM_taskThroughput)->RangeMultiplier(2)->Range(1, kMaxThreadGroups)->UseRealTime();
+BENCHMARK(BM_ssmRequestThroughput)->RangeMultiplier(2)->Range(1, kMaxThreadGroups)->UseRealTime();
+BENCHMARK(BM_objectPoolThreadCacheHit)->Arg(1)->Arg(64);
+BENCHMARK(BM_objectPoolSharedCacheHit)->Arg(64);
+BENCHMARK(BM_objectPoolMiss)->Arg(64);
+BENCHMARK(BM_newDelete)->Arg(1)->Arg(64);
+
+}  // namespace
+}  // namespace mongo
@@ -32,6 +32,7 @@ namespace mongo {
 namespace transport {
 enum class ServiceExecutorTaskName {
     kSSMProcessMessage,
+    kSSMProcessPriorityMessage,
     kSSMSourceMessage,
     kSSMExhaustMessage,
     kSSMStartSession,
@@ -39,6 +40,7 @@ enum class ServiceExecutorTaskName {
 };
 
 constexpr auto kSSMProcessMessageName = "processMessage"_sd;
+constexpr auto kSSMProcessPriorityMessageName = "processPriorityMessage"_sd;
 constexpr auto kSSMSourceMessageName = "sourceMessage"_sd;
 constexpr auto kSSMExhaustMessageName = "exhaustMessage"_sd;
 constexpr auto kSSMStartSessionName = "startSession"_sd;
@@ -47,6 +49,8 @@ inline StringData taskNameToString(ServiceExecutorTaskName taskName) {
     switch (taskName) {
         case ServiceExecutorTaskName::kSSMProcessMessage:
             return kSSMProcessMessageName;
+        case ServiceExecutorTaskName::kSSMProcessPriorityMessage:
+            return kSSMProcessPriorityMessageName;
         case ServiceExecutorTaskName::kSSMSourceMessage:
             return kSSMSourceMessageName;
         case ServiceExecutorTaskName::kSSMExhaustMessage:
@@ -57,5 +61,44 @@ inline StringData taskNameToString(ServiceExecutorTaskName taskName) {
             MONGO_UNREACHABLE;
     }
 }
+
+/*
+ * Scheduling classes of executors that keep separate queues per class. Classes are served in
+ * this order, each up to its own batch quota per scheduling round.
+ */
+enum class ServiceExecutorTaskPriority {
+    kHigh,        // Control plane commands: isMaster, heartbeats, killOp...
+    kNormal,      // User requests and network I/O
+    kBackground,  // Starting new sessions
+    kMaxTaskPriority
+};
+
+constexpr auto kTaskPriorityHighName = "high"_sd;
+constexpr auto kTaskPriorityNormalName = "normal"_sd;
+constexpr auto kTaskPriorityBackgroundName = "background"_sd;
+
+inline ServiceExecutorTaskPriority taskNameToPriority(ServiceExecutorTaskName taskName) {
+    switch (taskName) {
+        case ServiceExecutorTaskName::kSSMProcessPriorityMessage:
+            return ServiceExecutorTaskPriority::kHigh;
+        case ServiceExecutorTaskName::kSSMStartSession:
+            return ServiceExecutorTaskPriority::kBackground;
+        default:
+            return ServiceExecutorTaskPriority::kNormal;
+    }
+}
+
+inline StringData taskPriorityToString(ServiceExecutorTaskPriority priority) {
+    switch (priority) {
+        case ServiceExecutorTaskPriority::kHigh:
+            return kTaskPriorityHighName;
+        case ServiceExecutorTaskPriority::kNormal:
+            return kTaskPriorityNormalName;
+        case ServiceExecutorTaskPriority::kBackground:
+            return kTaskPriorityBackgroundName;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
 }  // namespace transport
 }  // namespace mongo
@@ -34,15 +34,21 @@
 
 #include "mongo/db/service_context.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_coroutine.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 #include <asio.hpp>
 
 namespace mongo {
+extern thread_local int16_t localThreadId;
+extern std::function<std::pair<std::function<void()>, std::function<void(int16_t)>>(int16_t)>
+    getTxServiceFunctors;
+
 namespace {
 using namespace transport;
 
@@ -106,6 +112,17 @@ public:
         }
     }
 
+    size_t poll() noexcept final {
+        _ioContext.restart();
+        return _ioContext.poll();
+    }
+
+    size_t runOneFor(Milliseconds time) noexcept final {
+        asio::io_context::work work(_ioContext);
+        _ioContext.restart();
+        return _ioContext.run_one_for(time.toSystemDuration());
+    }
+
     void stop() final {
         _ioContext.stop();
     }
@@ -175,6 +192,34 @@ protected:
     std::unique_ptr<ServiceExecutorSynchronous> executor;
 };
 
+class ServiceExecutorCoroutineFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = ServiceContext::make();
+        setGlobalServiceContext(std::move(scOwned));
+
+        // There is no tx service in this test, every thread group gets no-op functors.
+        getTxServiceFunctors = [](int16_t) {
+            return std::make_pair(std::function<void()>([] {}),
+                                  std::function<void(int16_t)>([](int16_t) {}));
+        };
+        executor = stdx::make_unique<ServiceExecutorCoroutine>(getGlobalServiceContext(),
+                                                               threadGroupCount());
+    }
+
+    virtual size_t threadGroupCount() const {
+        return 2;
+    }
+
+    void tearDown() override {
+        // The worker threads are detached and may still touch their thread groups after
+        // shutdown() returns, so the executor is intentionally leaked.
+        executor.release();
+    }
+
+    std::unique_ptr<ServiceExecutorCoroutine> executor;
+};
+
 void scheduleBasicTask(ServiceExecutor* exec, bool expectSuccess) {
     stdx::condition_variable cond;
     stdx::mutex mutex;
@@ -216,6 +261,234 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorCoroutineFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorCoroutineFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorCoroutineFixture, IdleGroupStealsTasks) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool blockerStarted = false;
+    bool releaseBlocker = false;
+    std::vector<int16_t> ranOn;
+
+    // Keeps thread group 0 busy so that the following tasks can only run elsewhere.
+    auto blocker = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        blockerStarted = true;
+        cond.notify_all();
+        cond.wait(lk, [&] { return releaseBlocker; });
+    };
+    auto task = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ranOn.push_back(localThreadId);
+        cond.notify_all();
+    };
+
+    ASSERT_OK(executor->schedule(
+        blocker, ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession, 0));
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return blockerStarted; });
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_OK(executor->schedule(
+            task, ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMProcessMessage, 0));
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    cond.wait(lk, [&] { return !ranOn.empty(); });
+    ASSERT_EQ(ranOn.front(), 1);
+
+    releaseBlocker = true;
+    cond.notify_all();
+    cond.wait(lk, [&] { return ranOn.size() == 2; });
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto groups = bob.obj()["coroutineExecutorStats"]["threadGroups"].Array();
+    ASSERT_EQ(groups.size(), 2UL);
+    ASSERT_GTE(groups[1]["tasksStolen"].numberLong(), 1);
+    ASSERT_GTE(groups[0]["tasksStolenFrom"].numberLong(), 1);
+}
+
+TEST_F(ServiceExecutorCoroutineFixture, GroupsPollingReactorsDoNotSteal) {
+    executor->setIngressReactors(
+        {std::make_shared<ASIOReactor>(), std::make_shared<ASIOReactor>()});
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool blockerStarted = false;
+    bool releaseBlocker = false;
+    std::vector<int16_t> ranOn;
+
+    auto blocker = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        blockerStarted = true;
+        cond.notify_all();
+        cond.wait(lk, [&] { return releaseBlocker; });
+    };
+    auto task = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ranOn.push_back(localThreadId);
+        cond.notify_all();
+    };
+
+    ASSERT_OK(executor->schedule(
+        blocker, ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession, 0));
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return blockerStarted; });
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_OK(executor->schedule(
+            task, ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMProcessMessage, 0));
+    }
+
+    // Thread group 1 stays idle while the tasks of thread group 0 wait for it.
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_FALSE(cond.wait_for(
+        lk, Milliseconds(200).toSystemDuration(), [&] { return !ranOn.empty(); }));
+
+    releaseBlocker = true;
+    cond.notify_all();
+    cond.wait(lk, [&] { return ranOn.size() == 2; });
+    ASSERT_EQ(ranOn[0], 0);
+    ASSERT_EQ(ranOn[1], 0);
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto groups = bob.obj()["coroutineExecutorStats"]["threadGroups"].Array();
+    ASSERT_EQ(groups[1]["tasksStolen"].numberLong(), 0);
+}
+
+class ServiceExecutorCoroutineSingleGroupFixture : public ServiceExecutorCoroutineFixture {
+protected:
+    size_t threadGroupCount() const override {
+        return 1;
+    }
+};
+
+/**
+ * Returns the stats of the first thread group once 'pred' holds on them, or after 10 seconds.
+ */
+template <typename Predicate>
+BSONObj waitForFirstGroupStats(ServiceExecutor* executor, Predicate pred) {
+    BSONObj stats;
+    for (int i = 0; i < 1000; ++i) {
+        BSONObjBuilder bob;
+        executor->appendStats(&bob);
+        stats = bob.obj()["coroutineExecutorStats"]["threadGroups"].Array()[0].Obj().getOwned();
+        if (pred(stats)) {
+            break;
+        }
+        sleepmillis(10);
+    }
+    return stats;
+}
+
+TEST_F(ServiceExecutorCoroutineSingleGroupFixture, IdleGroupParksAndWakesUp) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    auto stats = waitForFirstGroupStats(
+        executor.get(), [](const BSONObj& stats) { return stats["timesParked"].numberLong() > 0; });
+    ASSERT_GT(stats["timesParked"].numberLong(), 0);
+    ASSERT_EQ(stats["timesParkedWithOngoingCoroutines"].numberLong(), 0);
+
+    // Scheduling a task wakes the parked group up.
+    scheduleBasicTask(executor.get(), true);
+    stats = waitForFirstGroupStats(
+        executor.get(), [](const BSONObj& stats) { return stats["tasksRun"].numberLong() > 0; });
+    ASSERT_EQ(stats["tasksRun"].numberLong(), 1);
+    ASSERT_GT(stats["timeParkedMicros"].numberLong(), 0);
+}
+
+TEST_F(ServiceExecutorCoroutineSingleGroupFixture, GroupWithOngoingCoroutinesParksBriefly) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    // Nothing is scheduled, so every park ends on its own timeout.
+    executor->ongoingCoroutineCountUpdate(0, 1);
+    auto stats = waitForFirstGroupStats(executor.get(), [](const BSONObj& stats) {
+        return stats["timesParkedWithOngoingCoroutines"].numberLong() >= 10;
+    });
+    ASSERT_GTE(stats["timesParkedWithOngoingCoroutines"].numberLong(), 10);
+    ASSERT_GTE(stats["timesParked"].numberLong(),
+               stats["timesParkedWithOngoingCoroutines"].numberLong());
+
+    executor->ongoingCoroutineCountUpdate(0, -1);
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorCoroutineSingleGroupFixture, HighPriorityTasksRunFirst) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool blockerStarted = false;
+    bool releaseBlocker = false;
+    std::vector<std::string> ranTasks;
+
+    auto blocker = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        blockerStarted = true;
+        cond.notify_all();
+        cond.wait(lk, [&] { return releaseBlocker; });
+    };
+    auto makeTask = [&](std::string name) {
+        return [&, name] {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            ranTasks.push_back(name);
+            cond.notify_all();
+        };
+    };
+
+    // The blocker runs in the last lane, so that the tasks below are all served by the next round.
+    ASSERT_OK(executor->schedule(
+        blocker, ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession, 0));
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return blockerStarted; });
+    }
+
+    ASSERT_OK(executor->schedule(makeTask("session"),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession,
+                                 0));
+    ASSERT_OK(executor->schedule(makeTask("user"),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMProcessMessage,
+                                 0));
+    ASSERT_OK(executor->schedule(makeTask("isMaster"),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMProcessPriorityMessage,
+                                 0));
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    releaseBlocker = true;
+    cond.notify_all();
+    cond.wait(lk, [&] { return ranTasks.size() == 3; });
+
+    ASSERT_EQ(ranTasks[0], "isMaster");
+    ASSERT_EQ(ranTasks[1], "user");
+    ASSERT_EQ(ranTasks[2], "session");
+}
 
 }  // namespace
 }  // namespace mongo
@@ -30,6 +30,8 @@
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
 
 #include "mongo/transport/service_state_machine.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
 #include "mongo/base/object_pool.h"
 #include "mongo/base/status.h"
 #include "mongo/config.h"
@@ -37,8 +39,10 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/rpc/message.h"
+#include "mongo/transport/admission_controller.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/service_entry_point.h"
 #include "mongo/transport/service_executor_task_names.h"
@@ -51,10 +55,26 @@
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/socket_exception.h"
+#include "mongo/util/operation_arena.h"
 #include "mongo/util/quick_exit.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace mongo {
+extern thread_local int16_t localThreadId;
+
 namespace {
+// Responses held back while the client has more requests in flight are sent together once
+// there are this many, or this many bytes of them. They are never held past the scheduling round
+// of the coroutine which produced them.
+constexpr size_t kMaxCoalescedResponses = 16;
+MONGO_EXPORT_SERVER_PARAMETER(maxCoalescedResponseBytes, int, 256 * 1024);
+// Longest time a response is held back waiting for the next one.
+MONGO_EXPORT_SERVER_PARAMETER(maxCoalescedResponseDelayMicros, int, 1000);
+
 // Set up proper headers for formatting an exhaust request, if we need to
 bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     MsgData::View header = dbresponse.response.header();
@@ -88,6 +108,78 @@ bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     return true;
 }
 
+// Commands which keep the cluster and its operators in control. They are scheduled ahead of user
+// requests so that they stay responsive when a thread group is saturated.
+constexpr StringData kPriorityCommands[] = {"isMaster"_sd,
+                                            "ismaster"_sd,
+                                            "ping"_sd,
+                                            "replSetHeartbeat"_sd,
+                                            "replSetUpdatePosition"_sd,
+                                            "_isSelf"_sd,
+                                            "killOp"_sd,
+                                            "killSessions"_sd,
+                                            "killAllSessions"_sd};
+
+// Returns the first field name of the BSON document at data, or an empty StringData if there is
+// no well-formed document of at most len bytes.
+StringData firstFieldName(const char* data, int len) {
+    if (len < 5) {
+        return StringData();
+    }
+    int32_t objSize = ConstDataView(data).read<LittleEndian<int32_t>>();
+    if (objSize < 5 || objSize > len || data[objSize - 1] != 0 || data[4] == EOO) {
+        return StringData();
+    }
+    const char* name = data + 5;
+    size_t nameLen = strnlen(name, objSize - 5);
+    return nameLen < static_cast<size_t>(objSize - 5) ? StringData(name, nameLen) : StringData();
+}
+
+// Peeks at the command name of a request without parsing the whole message. Only looks at the
+// body section of OP_MSG if it comes first, and at OP_QUERY on a $cmd namespace.
+StringData peekCommandName(const Message& msg) {
+    const char* data = msg.singleData().data();
+    int len = msg.singleData().dataLen();
+
+    switch (msg.operation()) {
+        case dbMsg:
+            // flagBits followed by the kind byte of the first section
+            if (len < 5 || data[4] != 0) {
+                return StringData();
+            }
+            return firstFieldName(data + 5, len - 5);
+        case dbQuery: {
+            // flags, ns, numberToSkip, numberToReturn, query
+            if (len < 4) {
+                return StringData();
+            }
+            const char* ns = data + 4;
+            size_t nsLen = strnlen(ns, len - 4);
+            if (nsLen == static_cast<size_t>(len - 4) ||
+                !StringData(ns, nsLen).endsWith(".$cmd"_sd)) {
+                return StringData();
+            }
+            int offset = 4 + nsLen + 1 + 8;
+            return offset < len ? firstFieldName(data + offset, len - offset) : StringData();
+        }
+        default:
+            return StringData();
+    }
+}
+
+bool isPriorityCommand(const Message& msg) {
+    StringData name = peekCommandName(msg);
+    if (name.empty()) {
+        return false;
+    }
+    for (auto command : kPriorityCommands) {
+        if (name == command) {
+            return true;
+        }
+    }
+    return false;
+}
+
 }  // namespace
 
 using transport::ServiceExecutor;
@@ -269,7 +361,7 @@ void ServiceStateMachine::reset(ServiceContext* svcContext,
     // _threadName = str::stream() << "conn" << _session()->id();
     _dbClient = svcContext->makeClient(_threadName, std::move(session));
     _dbClientPtr = _dbClient.get();
-    _threadGroupId = groupId;
+    _threadGroupId.store(groupId);
     _owned.store(Ownership::kUnowned);
 }
 
@@ -318,13 +410,74 @@ void ServiceStateMachine::_sinkMessage(ThreadGuard guard, Message toSink) {
             return Future<void>::makeReady(_session()->sinkMessage(std::move(toSink)));
         } else {
             invariant(_transportMode == transport::Mode::kAsynchronous);
-            return _session()->asyncSinkMessage(std::move(toSink));
+            if (!toSink.empty()) {
+                if (_pendingSinks.empty()) {
+                    _pendingSinksSinceMicros = curTimeMicros64();
+                }
+                _pendingSinkBytes += toSink.size();
+                _pendingSinks.push_back(std::move(toSink));
+            }
+            if (_shouldHoldResponses()) {
+                return Future<void>::makeReady();
+            }
+            return _flushPendingSinks();
         }
     };
 
     sinkMsgImpl().getAsync([this](Status status) { _sinkCallback(std::move(status)); });
 }
 
+bool ServiceStateMachine::_shouldHoldResponses() {
+    // Only a coroutine sends the held responses when it gives its thread group up, see
+    // _flushBeforeYield(). Elsewhere a slow next request would hold them for its whole duration.
+    if (!serverGlobalParams.enableCoroutine) {
+        return false;
+    }
+    // The next response is on its way when an exhaust cursor continues, or when the client
+    // pipelined another request which is already received. The getMores of a tailable exhaust
+    // cursor may wait for new data, so its responses are never held.
+    if (_inExhaust ? _exhaustTailable : !_session()->hasBufferedInput()) {
+        return false;
+    }
+    if (curTimeMicros64() - _pendingSinksSinceMicros >=
+        static_cast<unsigned long long>(std::max(0, maxCoalescedResponseDelayMicros.load()))) {
+        return false;
+    }
+    return _pendingSinks.size() < kMaxCoalescedResponses &&
+        _pendingSinkBytes < static_cast<size_t>(std::max(0, maxCoalescedResponseBytes.load()));
+}
+
+Future<void> ServiceStateMachine::_flushPendingSinks() {
+    auto messages = std::move(_pendingSinks);
+    _pendingSinks.clear();
+    _pendingSinkBytes = 0;
+    auto send = [this, messages = std::move(messages)]() mutable {
+        if (messages.empty()) {
+            return Future<void>::makeReady();
+        }
+        if (messages.size() == 1) {
+            return _session()->asyncSinkMessage(std::move(messages.front()));
+        }
+        return _session()->asyncSinkMessages(std::move(messages));
+    };
+
+    // Writes to the session must not overlap.
+    if (_flushInProgress) {
+        auto inProgress = std::move(*_flushInProgress);
+        _flushInProgress.reset();
+        return std::move(inProgress).then(std::move(send));
+    }
+    return send();
+}
+
+void ServiceStateMachine::_flushBeforeYield() {
+    if (_pendingSinks.empty()) {
+        return;
+    }
+    // Any error is reported by the next sink, which waits for this one.
+    _flushInProgress = _flushPendingSinks();
+}
+
 void ServiceStateMachine::_sourceCallback(Status status) {
     MONGO_LOG(1) << "ServiceStateMachine::_sourceCallback";
     // The first thing to do is create a ThreadGuard which will take ownership of the SSM in this
@@ -345,9 +498,12 @@ void ServiceStateMachine::_sourceCallback(Status status) {
         // If this callback doesn't own the ThreadGuard, then we're being called recursively,
         // and the executor shouldn't start a new thread to process the message - it can use this
         // one just after this returns.
-        return _scheduleNextWithGuard(std::move(guard),
-                                      ServiceExecutor::kMayRecurse,
-                                      transport::ServiceExecutorTaskName::kSSMProcessMessage);
+        return _scheduleNextWithGuard(
+            std::move(guard),
+            ServiceExecutor::kMayRecurse,
+            isPriorityCommand(_inMessage)
+                ? transport::ServiceExecutorTaskName::kSSMProcessPriorityMessage
+                : transport::ServiceExecutorTaskName::kSSMProcessMessage);
     } else if (ErrorCodes::isInterruption(status.code()) ||
                ErrorCodes::isNetworkError(status.code())) {
         LOG(2) << "Session from " << remote << " encountered a network error during SourceMessage";
@@ -430,15 +586,22 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         
         if (serverGlobalParams.enableCoroutine) {
             opCtx->setCoroutineFunctors(&_coroYield, &_coroResume);
+            transport::AdmissionController::get().recordRequestStart(
+                _coroThreadGroupId, _serviceExecutor->threadGroupLoad(_coroThreadGroupId));
         }
 
         // The handleRequest is implemented in a subclass for mongod/mongos and actually all the
         // database work for this request.
+        Timer requestTimer;
         dbresponse = _sep->handleRequest(opCtx.get(), _inMessage);
+        if (serverGlobalParams.enableCoroutine) {
+            transport::AdmissionController::get().recordRequestLatency(
+                _coroThreadGroupId, Microseconds(requestTimer.micros()));
 
-
-        _coroStatus = CoroStatus::Empty;
-        _serviceExecutor->ongoingCoroutineCountUpdate(_threadGroupId, -1);
+            // Paired with the update made when the coroutine was started.
+            _coroStatus = CoroStatus::Empty;
+            _serviceExecutor->ongoingCoroutineCountUpdate(_coroThreadGroupId, -1);
+        }
 
         // opCtx must be destroyed here so that the operation cannot show
         // up in currentOp results after the response reaches the client
@@ -453,6 +616,12 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         toSink.header().setId(nextMessageId());
         toSink.header().setResponseToMsgId(_inMessage.header().getId());
 
+        // Only the request starting an exhaust cursor is an OP_QUERY, with the cursor's options.
+        if (dbresponse.exhaustNS.size() > 0 && _inMessage.operation() == dbQuery) {
+            _exhaustTailable =
+                DbMessage(_inMessage).reservedField() & QueryOption_CursorTailable;
+        }
+
         // If this is an exhaust cursor, don't source more Messages
         if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&_inMessage, dbresponse)) {
             _inExhaust = true;
@@ -463,13 +632,19 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
         networkCounter.hitLogicalOut(toSink.size());
 
-        if (_compressorId) {
-            auto swm = compressorMgr.compressMessage(toSink, &_compressorId.value());
+        // With adaptive compression, the client wants large responses compressed even when it
+        // sent its request uncompressed.
+        if (_compressorId || compressorMgr.isAdaptive()) {
+            auto swm = compressorMgr.maybeCompressMessage(toSink, _compressorId.get_ptr());
             uassertStatusOK(swm.getStatus());
             toSink = swm.getValue();
         }
         _sinkMessage(std::move(guard), std::move(toSink));
 
+    } else if (!_pendingSinks.empty() && !_session()->hasBufferedInput()) {
+        // Responses held back for earlier requests must reach the client before waiting for it.
+        _inMessage.reset();
+        _sinkMessage(std::move(guard), Message());
     } else {
         _state.store(State::Source);
         _inMessage.reset();
@@ -508,31 +683,45 @@ void ServiceStateMachine::_runNextInGuard(ThreadGuard guard) {
                 } else {
                     if (_coroStatus == CoroStatus::Empty) {
                         MONGO_LOG(1) << "coroutine begin";
+                        // The task may have been stolen by another thread group. The coroutine
+                        // belongs to the group that starts it, and is always resumed there.
+                        _coroThreadGroupId =
+                            localThreadId >= 0 ? static_cast<uint16_t>(localThreadId)
+                                               : _threadGroupId.load();
+                        auto stackPool =
+                            _serviceExecutor->coroutineStackPool(_coroThreadGroupId);
+                        _coroStackPool = stackPool;
+                        _coroStack = stackPool->allocate();
                         _coroStatus = CoroStatus::OnGoing;
-                        _serviceExecutor->ongoingCoroutineCountUpdate(_threadGroupId, 1);
+                        _serviceExecutor->ongoingCoroutineCountUpdate(_coroThreadGroupId, 1);
                         auto func = [this, ssm = shared_from_this()] {
                             Client::setCurrent(std::move(ssm->_dbClient));
                             _runResumeProcess();
                         };
 
                         _coroResume =
-                            _serviceExecutor->coroutineResumeFunctor(_threadGroupId, func);
+                            _serviceExecutor->coroutineResumeFunctor(_coroThreadGroupId, func);
 
-                        boost::context::stack_context sc = coroStackContext();
-                        boost::context::preallocated prealloc(sc.sp, sc.size, sc);
-                        _source = boost::context::callcc(
+                        auto stack = _coroStack;
+                        boost::context::preallocated prealloc(stack.sp, stack.size, stack);
+                        auto source = boost::context::callcc(
                             std::allocator_arg,
                             prealloc,
                             NoopAllocator(),
                             [this, &guard](boost::context::continuation&& sink) {
                                 _coroYield = [this, &sink]() {
                                     MONGO_LOG(1) << "call yield";
+                                    _flushBeforeYield();
                                     _dbClient = Client::releaseCurrent();
+                                    // The thread runs other coroutines until this one resumes.
+                                    auto arena = OperationArena::releaseCurrent();
                                     sink = sink.resume();
+                                    OperationArena::setCurrent(arena);
                                 };
                                 _processMessage(std::move(guard));
                                 return std::move(sink);
                             });
+                        _coroutineSwitchedBack(std::move(source), stackPool, stack);
 
                         // _source =
                         //     boost::context::callcc([this, &guard](boost::context::continuation&&
@@ -547,7 +736,7 @@ void ServiceStateMachine::_runNextInGuard(ThreadGuard guard) {
                         //     });
                     } else if (_coroStatus == CoroStatus::OnGoing) {
                         MONGO_LOG(1) << "coroutine ongoing";
-                        _source = _source.resume();
+                        _resumeCoroutine();
                     }
                 }
             } break;
@@ -578,10 +767,39 @@ void ServiceStateMachine::_runResumeProcess() {
     MONGO_LOG(1) << "ServiceStateMachine::_resumeRun";
     if (_coroStatus == CoroStatus::OnGoing) {
         MONGO_LOG(1) << "coroutine ongoing";
-        _source = _source.resume();
+        _resumeCoroutine();
     }
 }
 
+void ServiceStateMachine::_resumeCoroutine() {
+    // Read before switching, the members may be reused by the next request once the coroutine
+    // has finished.
+    auto stackPool = _coroStackPool;
+    auto stack = _coroStack;
+    auto source = std::move(_source).resume();
+    _coroutineSwitchedBack(std::move(source), stackPool, stack);
+}
+
+void ServiceStateMachine::_coroutineSwitchedBack(boost::context::continuation source,
+                                                 transport::CoroutineStackPool* stackPool,
+                                                 boost::context::stack_context stack) {
+    if (source) {
+        // The coroutine yielded with the ThreadGuard still held on its stack. It is only resumed
+        // by a task of this thread group, which can't run before this one returns.
+        _source = std::move(source);
+        return;
+    }
+
+    // The continuation is empty once the coroutine function has returned. The ThreadGuard was
+    // released inside the coroutine when the response was sunk, so the next state may already
+    // run on another thread group, and the SSM may even be gone. Nothing but locals may be
+    // touched from here on.
+    //
+    // The stack goes back to the pool it was taken from. This thread owns that pool: coroutines
+    // are started and resumed only by the thread group they belong to.
+    stackPool->deallocate(stack);
+}
+
 void ServiceStateMachine::start(Ownership ownershipModel) {
     MONGO_LOG(1) << "ServiceStateMachine::start";
     _scheduleNextWithGuard(ThreadGuard(this),
@@ -604,7 +822,8 @@ void ServiceStateMachine::_scheduleNextWithGuard(ThreadGuard guard,
 
     guard.release();
     // Status status = Status::OK();
-    Status status = _serviceExecutor->schedule(std::move(func), flags, taskName, _threadGroupId);
+    Status status =
+        _serviceExecutor->schedule(std::move(func), flags, taskName, _threadGroupId.load());
     // if (taskName == transport::ServiceExecutorTaskName::kSSMProcessMessage) {
     //     // coroutine mode in actually
     //     status = _serviceExecutor->schedule(std::move(func), flags, taskName, _threadGroupId);
@@ -665,7 +884,27 @@ void ServiceStateMachine::setServiceExecutor(transport::ServiceExecutor* service
 
 void ServiceStateMachine::setThreadGroupId(size_t id) {
     MONGO_LOG(1) << "ServiceStateMachine::setThreadGroupId. id: " << id;
-    _threadGroupId = id;
+    _threadGroupId.store(id);
+}
+
+uint16_t ServiceStateMachine::threadGroupId() const {
+    return _threadGroupId.load();
+}
+
+bool ServiceStateMachine::migrateThreadGroup(uint16_t id) {
+    // A session waiting for its next request has finished its coroutine in _processMessage
+    // before moving to SinkWait, so nothing is bound to the current thread group. Even if the
+    // session wakes up concurrently, a coroutine started afterwards records the group it runs
+    // on and is resumed there.
+    auto curState = state();
+    if (curState != State::Source && curState != State::SourceWait) {
+        return false;
+    }
+
+    MONGO_LOG(1) << "ServiceStateMachine::migrateThreadGroup. from: " << _threadGroupId.load()
+                 << " to: " << id;
+    _threadGroupId.store(id);
+    return true;
 }
 
 ServiceStateMachine::State ServiceStateMachine::state() {
@@ -684,6 +923,9 @@ void ServiceStateMachine::_cleanupSession(ThreadGuard guard) {
     _state.store(State::Ended);
 
     _inMessage.reset();
+    _pendingSinks.clear();
+    _pendingSinkBytes = 0;
+    _flushInProgress.reset();
 
     // By ignoring the return value of Client::releaseCurrent() we destroy the session.
     // _dbClient is now nullptr and _dbClientPtr is invalid and should never be accessed.
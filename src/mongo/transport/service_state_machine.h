@@ -33,6 +33,7 @@
 #include <boost/context/continuation_fcontext.hpp>
 #include <boost/context/stack_context.hpp>
 #include <functional>
+#include <vector>
 
 #include "boost/optional/optional.hpp"
 #include "mongo/base/status.h"
@@ -49,6 +50,7 @@
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_mode.h"
+#include "mongo/util/future.h"
 
 namespace mongo {
 
@@ -166,6 +168,14 @@ public:
 
     void setThreadGroupId(size_t id);
 
+    uint16_t threadGroupId() const;
+
+    /*
+     * Moves an idle session, one that is waiting for its next request, to another thread group.
+     * Returns false and leaves the session untouched if it is processing a request.
+     */
+    bool migrateThreadGroup(uint16_t id);
+
 private:
     /*
      * A class that wraps up lifetime management of the _dbClient and _threadName for runNext();
@@ -225,6 +235,20 @@ private:
     void _sourceMessage(ThreadGuard guard);
     void _sinkMessage(ThreadGuard guard, Message toSink);
 
+    /*
+     * In coroutine mode, responses are held back while another one is known to follow soon, and
+     * then sent together with a single write, unless the oldest one has waited for longer than
+     * maxCoalescedResponseDelayMicros. These decide when to send them and do so.
+     */
+    bool _shouldHoldResponses();
+    Future<void> _flushPendingSinks();
+
+    /*
+     * Sends the held responses before the coroutine gives its thread group up, since the request
+     * it processes may take long to produce the next one.
+     */
+    void _flushBeforeYield();
+
     /*
      * Releases all the resources associated with the session and call the cleanupHook.
      */
@@ -247,9 +271,19 @@ private:
     stdx::function<void()> _cleanupHook;
 
     bool _inExhaust = false;
+    // Whether the exhaust cursor is tailable, see _shouldHoldResponses().
+    bool _exhaustTailable = false;
     boost::optional<MessageCompressorId> _compressorId;
     Message _inMessage;
 
+    // Responses not sent yet, see _shouldHoldResponses().
+    std::vector<Message> _pendingSinks;
+    size_t _pendingSinkBytes = 0;
+    // When the oldest of _pendingSinks was held back, in curTimeMicros64() time.
+    unsigned long long _pendingSinksSinceMicros = 0;
+    // Write of the responses sent by _flushBeforeYield(), which the next write must wait for.
+    boost::optional<Future<void>> _flushInProgress;
+
     AtomicWord<Ownership> _owned{Ownership::kUnowned};
 #if MONGO_CONFIG_DEBUG_BUILD
     AtomicWord<stdx::thread::id> _owningThread;
@@ -271,23 +305,34 @@ private:
         }
     };
 
-    static constexpr size_t kCoroStackSize = 320 * 1024;
-    boost::context::stack_context coroStackContext() {
-        boost::context::stack_context sc;
-        sc.size = kCoroStackSize;
-        // Because stack grows downwards from high address?
-        sc.sp = _coroStack + kCoroStackSize;
-        return sc;
-    }
+    /*
+     * Switches to the suspended coroutine until it yields again or finishes.
+     */
+    void _resumeCoroutine();
+
+    /*
+     * Called on the thread group of the coroutine once it has switched back to 'source'. Keeps a
+     * yielded coroutine, or gives the stack of a finished one back to 'stackPool'. The stack
+     * can't be released from inside the coroutine, because it is still running on it.
+     */
+    void _coroutineSwitchedBack(boost::context::continuation source,
+                                transport::CoroutineStackPool* stackPool,
+                                boost::context::stack_context stack);
 
     boost::context::continuation _source;
-    char _coroStack[kCoroStackSize];
+    // Taken from _coroStackPool, the pool of _coroThreadGroupId, while a coroutine is ongoing.
+    boost::context::stack_context _coroStack;
+    transport::CoroutineStackPool* _coroStackPool{nullptr};
 
     enum class CoroStatus { Empty = 0, OnGoing, Finished };
     CoroStatus _coroStatus{CoroStatus::Empty};
     std::function<void()> _coroYield;
     std::function<void()> _coroResume;
-    uint16_t _threadGroupId{0};
+    // Written by the service entry point when the session is migrated to another thread group.
+    AtomicWord<uint16_t> _threadGroupId{0};
+    // The thread group running the current coroutine. It differs from _threadGroupId when the
+    // process task was stolen by an idle thread group.
+    uint16_t _coroThreadGroupId{0};
 };
 
 template <typename T>
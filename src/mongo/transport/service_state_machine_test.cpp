@@ -35,12 +35,15 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/rpc/op_msg.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/transport/mock_session.h"
 #include "mongo/transport/service_entry_point.h"
 #include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_coroutine.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/transport/service_state_machine.h"
 #include "mongo/transport/transport_layer_mock.h"
@@ -51,6 +54,9 @@
 #include "mongo/util/tick_source_mock.h"
 
 namespace mongo {
+extern std::function<std::pair<std::function<void()>, std::function<void(int16_t)>>(int16_t)>
+    getTxServiceFunctors;
+
 namespace {
 
 std::string stateToString(ServiceStateMachine::State state) {
@@ -339,6 +345,21 @@ TEST_F(ServiceStateMachineFixture, TestOkaySimpleCommand) {
     checkPingOk();
 }
 
+TEST_F(ServiceStateMachineFixture, MigrateThreadGroupOnlyWhenIdle) {
+    ASSERT_FALSE(_ssm->migrateThreadGroup(1));
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Process);
+    ASSERT_FALSE(_ssm->migrateThreadGroup(1));
+    ASSERT_EQ(_ssm->threadGroupId(), 0);
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Source);
+    ASSERT_TRUE(_ssm->migrateThreadGroup(1));
+    ASSERT_EQ(_ssm->threadGroupId(), 1);
+    checkPingOk();
+}
+
 TEST_F(ServiceStateMachineFixture, TestThrowHandling) {
     _sep->setUassertInHandler();
 
@@ -572,5 +593,152 @@ TEST_F(ServiceStateMachineFixture, SSMRunsRecursively) {
     ASSERT_EQ(_ssm->state(), State::Ended);
 }
 
+/**
+ * Answers every request with {ok: 1}. Safe to call from several thread groups at once.
+ */
+class CountingSEP : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {}
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        handled.fetchAndAdd(1);
+        OpMsgBuilder builder;
+        builder.setBody(BSON("ok" << 1));
+        return DbResponse{builder.finish()};
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {}
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        return 0;
+    }
+
+    AtomicWord<int> handled{0};
+};
+
+/**
+ * Sources the same ping request 'requests' times, then reports the session as closed. Both
+ * directions complete inline, so the next state of the SSM is scheduled while the coroutine of
+ * the previous request is still unwinding.
+ */
+class PingSession : public MockSession {
+public:
+    PingSession(TransportLayer* tl, int requests) : MockSession(tl), _remaining(requests) {
+        _request = buildRequest(BSON("ping" << 1));
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        if (_remaining-- <= 0) {
+            return TransportLayer::TicketSessionClosedStatus;
+        }
+        return _request;
+    }
+
+    Status sinkMessage(Message message) override {
+        sunk.fetchAndAdd(1);
+        return Status::OK();
+    }
+
+    AtomicWord<int> sunk{0};
+
+private:
+    int _remaining;
+    Message _request;
+};
+
+class ServiceStateMachineCoroutineFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        _oldEnableCoroutine = serverGlobalParams.enableCoroutine;
+        serverGlobalParams.enableCoroutine = true;
+
+        auto scOwned = ServiceContext::make();
+        _sc = scOwned.get();
+        setGlobalServiceContext(std::move(scOwned));
+
+        auto sep = stdx::make_unique<CountingSEP>();
+        _sep = sep.get();
+        _sc->setServiceEntryPoint(std::move(sep));
+        _sc->setTransportLayer(stdx::make_unique<TransportLayerMock>());
+
+        // There is no tx service in this test, every thread group gets no-op functors.
+        getTxServiceFunctors = [](int16_t) {
+            return std::make_pair(std::function<void()>([] {}),
+                                  std::function<void(int16_t)>([](int16_t) {}));
+        };
+        _executor = stdx::make_unique<ServiceExecutorCoroutine>(_sc, kThreadGroups);
+        ASSERT_OK(_executor->start());
+    }
+
+    void tearDown() override {
+        ASSERT_OK(_executor->shutdown(Seconds(10)));
+        // The worker threads are detached and may still touch their thread groups after
+        // shutdown() returns, so the executor is intentionally leaked.
+        _executor.release();
+        serverGlobalParams.enableCoroutine = _oldEnableCoroutine;
+    }
+
+    static constexpr uint16_t kThreadGroups = 4;
+
+    ServiceContext* _sc;
+    CountingSEP* _sep;
+    std::unique_ptr<ServiceExecutorCoroutine> _executor;
+
+private:
+    bool _oldEnableCoroutine;
+};
+
+// All sessions are bound to thread group 0, so the other groups keep stealing their tasks. The
+// state of a session must only ever be touched by the thread owning it, including the stack of
+// a coroutine that finishes after the session moved on.
+TEST_F(ServiceStateMachineCoroutineFixture, SessionsSurviveWorkStealing) {
+    const int kSessions = 64;
+    const int kRequestsPerSession = 500;
+
+    AtomicWord<int> ended{0};
+    std::vector<std::shared_ptr<PingSession>> sessions;
+    for (int i = 0; i < kSessions; ++i) {
+        auto session = std::make_shared<PingSession>(_sc->getTransportLayer(), kRequestsPerSession);
+        sessions.push_back(session);
+        auto ssm = ServiceStateMachine::create(_sc, session, transport::Mode::kAsynchronous, 0);
+        ssm->setServiceExecutor(_executor.get());
+        ssm->setCleanupHook([&ended] { ended.fetchAndAdd(1); });
+        ssm->start(ServiceStateMachine::Ownership::kOwned);
+    }
+
+    // The stack of the last coroutine of a session is given back once it has unwound, which may
+    // be after the session ended.
+    long long stolen = 0;
+    long long stacksInUse = 0;
+    const auto deadline = Date_t::now() + Seconds(60);
+    do {
+        ASSERT_LT(Date_t::now(), deadline);
+        stdx::this_thread::sleep_for(Milliseconds(10).toSystemDuration());
+
+        BSONObjBuilder bob;
+        _executor->appendStats(&bob);
+        stolen = 0;
+        stacksInUse = 0;
+        for (const auto& group : bob.obj()["coroutineExecutorStats"]["threadGroups"].Array()) {
+            stolen += group["tasksStolen"].numberLong();
+            stacksInUse += group["stackPool"]["inUse"].numberLong();
+        }
+    } while (ended.load() < kSessions || stacksInUse > 0);
+
+    ASSERT_EQ(_sep->handled.load(), kSessions * kRequestsPerSession);
+    for (const auto& session : sessions) {
+        ASSERT_EQ(session->sunk.load(), kRequestsPerSession);
+    }
+    ASSERT_GT(stolen, 0);
+}
+
 }  // namespace
 }  // namespace mongo
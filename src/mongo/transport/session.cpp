@@ -68,5 +68,16 @@ Session::TagMask Session::getTags() const {
     return _tags.load();
 }
 
+Future<void> Session::asyncSinkMessages(std::vector<Message> messages,
+                                        const transport::BatonHandle& baton) {
+    auto future = Future<void>::makeReady();
+    for (auto& message : messages) {
+        future = std::move(future).then([this, message = std::move(message), baton]() mutable {
+            return asyncSinkMessage(std::move(message), baton);
+        });
+    }
+    return future;
+}
+
 }  // namespace transport
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/platform/atomic_word.h"
@@ -116,6 +117,21 @@ public:
     virtual Future<void> asyncSinkMessage(Message message,
                                           const transport::BatonHandle& handle = nullptr) = 0;
 
+    /**
+     * Sink several Messages in order, as consecutive calls to asyncSinkMessage() would. Network
+     * sessions may send them with a single gathering write.
+     */
+    virtual Future<void> asyncSinkMessages(std::vector<Message> messages,
+                                           const transport::BatonHandle& handle = nullptr);
+
+    /**
+     * Returns whether part of the next Message has already been received from the remote host,
+     * so that sourcing it will not wait for the network.
+     */
+    virtual bool hasBufferedInput() const {
+        return false;
+    }
+
     /**
      * Cancel any outstanding async operations. There is no way to cancel synchronous calls.
      * Futures will finish with an ErrorCodes::CallbackCancelled error if they haven't already
@@ -146,6 +162,14 @@ public:
     virtual const HostAndPort& remote() const = 0;
     virtual const HostAndPort& local() const = 0;
 
+    /**
+     * Index of the ingress reactor which runs this session's network I/O, or -1 if the session
+     * is not bound to one.
+     */
+    virtual int ingressReactorId() const {
+        return -1;
+    }
+
     /**
      * Atomically set all of the session tags specified in the 'tagsToSet' bit field. If the
      * 'kPending' tag is set, indicating that no tags have yet been specified for the session, this
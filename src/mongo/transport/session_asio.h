@@ -29,7 +29,10 @@
 #pragma once
 
 #include "asio/write.hpp"
+#include <algorithm>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "mongo/base/system_error.h"
 #include "mongo/config.h"
@@ -39,6 +42,7 @@
 #include "mongo/transport/transport_layer_asio.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/net/socket_utils.h"
+#include "mongo/util/shared_buffer.h"
 #ifdef MONGO_CONFIG_SSL
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_types.h"
@@ -79,8 +83,14 @@ class TransportLayerASIO::ASIOSession final : public Session {
 public:
     // If the socket is disconnected while any of these options are being set, this constructor
     // may throw, but it is guaranteed to throw a mongo DBException.
-    ASIOSession(TransportLayerASIO* tl, GenericSocket socket, bool isIngressSession) try
-        : _socket(std::move(socket)), _tl(tl), _isIngressSession(isIngressSession) {
+    ASIOSession(TransportLayerASIO* tl,
+                GenericSocket socket,
+                bool isIngressSession,
+                int ingressReactorId = -1) try
+        : _socket(std::move(socket)),
+          _tl(tl),
+          _isIngressSession(isIngressSession),
+          _ingressReactorId(ingressReactorId) {
         auto family = endpointToSockAddr(_socket.local_endpoint()).getType();
         if (family == AF_INET || family == AF_INET6) {
             _socket.set_option(asio::ip::tcp::no_delay(true));
@@ -114,6 +124,10 @@ public:
         return _local;
     }
 
+    int ingressReactorId() const override {
+        return _ingressReactorId;
+    }
+
     void end() override {
         if (getSocket().is_open()) {
             std::error_code ec;
@@ -158,6 +172,36 @@ public:
             });
     }
 
+    Future<void> asyncSinkMessages(std::vector<Message> messages,
+                                   const transport::BatonHandle& baton = nullptr) override {
+        ensureAsync();
+#ifdef MONGO_CONFIG_SSL
+        _ranHandshake = true;
+        if (_sslSocket) {
+            // TLS records are built from one buffer at a time, so there is nothing to gather.
+            return Session::asyncSinkMessages(std::move(messages), baton);
+        }
+#endif
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(messages.size());
+        size_t totalSize = 0;
+        for (const auto& message : messages) {
+            buffers.emplace_back(message.buf(), message.size());
+            totalSize += message.size();
+        }
+
+        return writeGathered(std::move(buffers), baton)
+            .then([this, messages = std::move(messages) /*keep the buffers alive*/, totalSize] {
+                if (_isIngressSession) {
+                    networkCounter.hitPhysicalOut(totalSize);
+                }
+            });
+    }
+
+    bool hasBufferedInput() const override {
+        return !_readAhead.empty();
+    }
+
     void cancelAsyncOperations(const transport::BatonHandle& baton = nullptr) override {
         LOG(3) << "Cancelling outstanding I/O operations on connection to " << _remote;
         if (baton) {
@@ -289,6 +333,11 @@ protected:
     }
 
 private:
+    static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+    // Capacity of the buffer a request is read ahead into. Together with the 16 byte buffer
+    // header, it fills the 4KB size class of the SharedBufferPool.
+    static constexpr size_t kReadAheadBytes = 4096 - 16;
+
     template <int Name>
     class ASIOSocketTimeoutOption {
     public:
@@ -341,38 +390,32 @@ private:
     }
 
     Future<Message> sourceMessageImpl(const transport::BatonHandle& baton = nullptr) {
-        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+        if (canReadAhead()) {
+            return sourceMessageReadAhead(baton);
+        }
 
-        auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
-        auto ptr = headerBuffer.get();
-        return read(asio::buffer(ptr, kHeaderSize), baton)
-            .then([headerBuffer = std::move(headerBuffer), this, baton]() mutable {
-                if (checkForHTTPRequest(asio::buffer(headerBuffer.get(), kHeaderSize))) {
+        return read(asio::buffer(_headerBuffer, kHeaderSize), baton)
+            .then([this, baton]() mutable {
+                if (checkForHTTPRequest(asio::buffer(_headerBuffer, kHeaderSize))) {
                     return sendHTTPResponse(baton);
                 }
 
-                const auto msgLen = size_t(MSGHEADER::View(headerBuffer.get()).getMessageLength());
-                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
-                    StringBuilder sb;
-                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
-                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
-                    const auto str = sb.str();
-                    LOG(0) << str;
-
-                    return Future<Message>::makeReady(Status(ErrorCodes::ProtocolError, str));
+                auto swMsgLen = validateMessageLength(_headerBuffer);
+                if (!swMsgLen.isOK()) {
+                    return Future<Message>::makeReady(swMsgLen.getStatus());
                 }
+                const auto msgLen = swMsgLen.getValue();
 
+                auto buffer = SharedBuffer::allocatePooled(msgLen);
+                memcpy(buffer.get(), _headerBuffer, kHeaderSize);
                 if (msgLen == kHeaderSize) {
                     // This probably isn't a real case since all (current) messages have bodies.
                     if (_isIngressSession) {
                         networkCounter.hitPhysicalIn(msgLen);
                     }
-                    return Future<Message>::makeReady(Message(std::move(headerBuffer)));
+                    return Future<Message>::makeReady(Message(std::move(buffer)));
                 }
 
-                auto buffer = SharedBuffer::allocate(msgLen);
-                memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
-
                 MsgData::View msgView(buffer.get());
                 return read(asio::buffer(msgView.data(), msgView.dataLen()), baton)
                     .then([this, buffer = std::move(buffer), msgLen]() mutable {
@@ -384,6 +427,127 @@ private:
             });
     }
 
+    StatusWith<size_t> validateMessageLength(const char* header) {
+        const auto msgLen = size_t(MSGHEADER::ConstView(header).getMessageLength());
+        if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+            StringBuilder sb;
+            sb << "recv(): message msgLen " << msgLen << " is invalid. "
+               << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+            const auto str = sb.str();
+            LOG(0) << str;
+
+            return Status(ErrorCodes::ProtocolError, str);
+        }
+        return msgLen;
+    }
+
+    /**
+     * Whether requests may be read ahead of the message boundary. Only async ingress sessions
+     * over plain sockets do, after the first message has told whether the client speaks TLS.
+     */
+    bool canReadAhead() const {
+        if (!_isIngressSession || _blockingMode != Async) {
+            return false;
+        }
+#ifdef MONGO_CONFIG_SSL
+        if (_sslSocket || !_ranHandshake) {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * Reads as much as is available, up to a pooled buffer of kReadAheadBytes, instead of the
+     * header and the body in separate reads. Most requests fit, so they are received with a
+     * single system call straight into the buffer the Message keeps. Bytes beyond the message,
+     * which belong to requests the client pipelined, are kept for the next call.
+     */
+    Future<Message> sourceMessageReadAhead(const transport::BatonHandle& baton) {
+        auto buffer = SharedBuffer::allocatePooled(kReadAheadBytes);
+        if (!_readAhead.empty()) {
+            const size_t received = std::min(_readAhead.size(), buffer.capacity());
+            memcpy(buffer.get(), _readAhead.data(), received);
+            _readAhead.erase(0, received);
+            return finishReadAhead(std::move(buffer), received, baton);
+        }
+
+        auto ptr = buffer.get();
+        const auto capacity = buffer.capacity();
+        return readSome(asio::buffer(ptr, capacity), baton)
+            .then([this, buffer = std::move(buffer), baton](size_t received) mutable {
+                return finishReadAhead(std::move(buffer), received, baton);
+            });
+    }
+
+    Future<Message> finishReadAhead(SharedBuffer buffer,
+                                    size_t received,
+                                    const transport::BatonHandle& baton) {
+        if (received < kHeaderSize) {
+            auto ptr = buffer.get() + received;
+            return read(asio::buffer(ptr, kHeaderSize - received), baton)
+                .then([this, buffer = std::move(buffer), baton]() mutable {
+                    return finishReadAhead(std::move(buffer), kHeaderSize, baton);
+                });
+        }
+
+        if (checkForHTTPRequest(asio::buffer(buffer.get(), kHeaderSize))) {
+            return sendHTTPResponse(baton);
+        }
+
+        auto swMsgLen = validateMessageLength(buffer.get());
+        if (!swMsgLen.isOK()) {
+            return Future<Message>::makeReady(swMsgLen.getStatus());
+        }
+        const auto msgLen = swMsgLen.getValue();
+
+        if (received > msgLen) {
+            // Ahead of anything left over from an earlier read, which comes after these bytes.
+            _readAhead.insert(0, buffer.get() + msgLen, received - msgLen);
+            received = msgLen;
+        }
+
+        if (msgLen > buffer.capacity()) {
+            auto larger = SharedBuffer::allocatePooled(msgLen);
+            memcpy(larger.get(), buffer.get(), received);
+            buffer = std::move(larger);
+        }
+
+        auto finish = [this, msgLen](SharedBuffer buffer) {
+            if (_isIngressSession) {
+                networkCounter.hitPhysicalIn(msgLen);
+            }
+            return Message(std::move(buffer));
+        };
+        if (received == msgLen) {
+            return Future<Message>::makeReady(finish(std::move(buffer)));
+        }
+
+        auto ptr = buffer.get() + received;
+        return read(asio::buffer(ptr, msgLen - received), baton)
+            .then([buffer = std::move(buffer), finish]() mutable {
+                return finish(std::move(buffer));
+            });
+    }
+
+    /**
+     * Reads whatever is available on the plain socket, waiting until at least one byte is.
+     */
+    Future<size_t> readSome(const asio::mutable_buffer& buffer,
+                            const transport::BatonHandle& baton) {
+        std::error_code ec;
+        auto size = _socket.read_some(buffer, ec);
+        if ((ec == asio::error::would_block) || (ec == asio::error::try_again)) {
+            if (baton) {
+                return baton->addSession(*this, Baton::Type::In).then([this, buffer, baton] {
+                    return readSome(buffer, baton);
+                });
+            }
+            return _socket.async_read_some(buffer, UseFuture{});
+        }
+        return futurize(ec, size);
+    }
+
     template <typename MutableBufferSequence>
     Future<void> read(const MutableBufferSequence& buffers,
                       const transport::BatonHandle& baton = nullptr) {
@@ -480,6 +644,37 @@ private:
         }
     }
 
+    /**
+     * Writes several buffers to the plain socket with as few system calls as possible, like
+     * opportunisticWrite() does for a single buffer.
+     */
+    Future<void> writeGathered(std::vector<asio::const_buffer> buffers,
+                               const transport::BatonHandle& baton) {
+        std::error_code ec;
+        auto size = asio::write(_socket, buffers, ec);
+        if ((ec == asio::error::would_block) || (ec == asio::error::try_again)) {
+            // Drop whatever the partial write already sent.
+            auto it = buffers.begin();
+            while (it != buffers.end() && size >= it->size()) {
+                size -= it->size();
+                ++it;
+            }
+            buffers.erase(buffers.begin(), it);
+            if (size > 0) {
+                buffers.front() += size;
+            }
+
+            if (baton) {
+                return baton->addSession(*this, Baton::Type::Out)
+                    .then([this, buffers = std::move(buffers), baton]() mutable {
+                        return writeGathered(std::move(buffers), baton);
+                    });
+            }
+            return asio::async_write(_socket, buffers, UseFuture{}).ignoreValue();
+        }
+        return futurize(ec);
+    }
+
     /**
      * moreToSend checks the ssl socket after an opportunisticWrite.  If there are still bytes to
      * send, we manually send them off the underlying socket.  Then we hook that up with a future
@@ -709,6 +904,12 @@ private:
 
     TransportLayerASIO* const _tl;
     bool _isIngressSession;
+    const int _ingressReactorId;
+
+    // Header of the message being received, when not reading ahead.
+    char _headerBuffer[kHeaderSize];
+    // Bytes received beyond the previous message, see sourceMessageReadAhead().
+    std::string _readAhead;
 };
 
 }  // namespace transport
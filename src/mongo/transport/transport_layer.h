@@ -154,6 +154,17 @@ public:
      */
     virtual void run() noexcept = 0;
     virtual void runFor(Milliseconds time) noexcept = 0;
+
+    /*
+     * Runs the handlers which are ready to run without blocking, and returns how many ran.
+     */
+    virtual size_t poll() noexcept = 0;
+
+    /*
+     * Blocks until a handler has run or the timeout expires, and returns how many handlers ran.
+     */
+    virtual size_t runOneFor(Milliseconds time) noexcept = 0;
+
     virtual void stop() = 0;
     virtual void drain() = 0;
 
@@ -38,6 +38,7 @@
 
 #include "mongo/transport/transport_layer_asio.h"
 
+#include <algorithm>
 #include <asio.hpp>
 #include <asio/system_timer.hpp>
 #include <boost/algorithm/string.hpp>
@@ -46,6 +47,7 @@
 
 #include "mongo/base/system_error.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/transport/asio_utils.h"
 #include "mongo/transport/service_entry_point.h"
@@ -70,6 +72,19 @@ namespace transport {
 
 MONGO_FAIL_POINT_DEFINE(transportLayerASIOasyncConnectTimesOut);
 
+namespace {
+// Listening sockets bound to each TCP address, each one accepting on its own listener thread.
+// SO_REUSEPORT is only set when there are several. Zero means one per ingress reactor.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(listenerAcceptorsPerAddress, int, 1);
+
+// Connections an acceptor takes from the backlog each time it wakes up.
+MONGO_EXPORT_SERVER_PARAMETER(listenerAcceptBatchSize, int, 64);
+
+#ifdef SO_REUSEPORT
+using ReusePortOption = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+}  // namespace
+
 class ASIOReactorTimer final : public ReactorTimer {
 public:
     explicit ASIOReactorTimer(asio::io_context& ctx)
@@ -169,6 +184,35 @@ public:
         }
     }
 
+    // A reactor polled by its thread group runs out of work whenever it has no sessions, which
+    // stops the io_context, so poll() and runOneFor() restart it.
+    size_t poll() noexcept override {
+        ThreadIdGuard threadIdGuard(this);
+        try {
+            if (_ioContext.stopped()) {
+                _ioContext.restart();
+            }
+            return _ioContext.poll();
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51401);
+        }
+    }
+
+    size_t runOneFor(Milliseconds time) noexcept override {
+        ThreadIdGuard threadIdGuard(this);
+        asio::io_context::work work(_ioContext);
+        try {
+            if (_ioContext.stopped()) {
+                _ioContext.restart();
+            }
+            return _ioContext.run_one_for(time.toSystemDuration());
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51402);
+        }
+    }
+
     void stop() override {
         _ioContext.stop();
     }
@@ -225,6 +269,14 @@ private:
 thread_local TransportLayerASIO::ASIOReactor* TransportLayerASIO::ASIOReactor::_reactorForThread =
     nullptr;
 
+struct TransportLayerASIO::Acceptor {
+    SockAddr addr;
+    GenericAcceptor acceptor;
+    // The ingress reactor which gets every socket accepted here, or -1 to spread them over all
+    // ingress reactors.
+    int ingressReactorId;
+};
+
 TransportLayerASIO::Options::Options(const ServerGlobalParams* params)
     : port(params->port),
       ipList(params->bind_ips),
@@ -232,22 +284,27 @@ TransportLayerASIO::Options::Options(const ServerGlobalParams* params)
       useUnixSockets(!params->noUnixSocket),
 #endif
       enableIPv6(params->enableIPv6),
-      maxConns(params->maxConns) {
+      maxConns(params->maxConns),
+      acceptorsPerAddress(static_cast<size_t>(std::max(listenerAcceptorsPerAddress, 0))) {
 }
 
 TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
                                        ServiceEntryPoint* sep)
     :  //_ingressReactor(std::make_shared<ASIOReactor>()),
       _egressReactor(std::make_shared<ASIOReactor>()),
-      _acceptorReactor(std::make_shared<ASIOReactor>()),
+      _acceptorReactors{std::make_shared<ASIOReactor>()},
 #ifdef MONGO_CONFIG_SSL
       _ingressSSLContext(nullptr),
       _egressSSLContext(nullptr),
 #endif
       _sep(sep),
       _listenerOptions(opts) {
-    _ingressReactors.reserve(serverGlobalParams.adaptiveThreadNum);
-    for (int i = 0; i < serverGlobalParams.adaptiveThreadNum; ++i) {
+    // In run-to-completion mode every coroutine thread group polls one ingress reactor.
+    const size_t ingressReactorCnt = serverGlobalParams.runToCompletion
+        ? serverGlobalParams.reservedThreadNum
+        : serverGlobalParams.adaptiveThreadNum;
+    _ingressReactors.reserve(ingressReactorCnt);
+    for (size_t i = 0; i < ingressReactorCnt; ++i) {
         _ingressReactors.emplace_back(std::make_shared<ASIOReactor>());
     }
 }
@@ -650,7 +707,18 @@ Status TransportLayerASIO::setup() {
     }
 
     _listenerPort = _listenerOptions.port;
-    WrappedResolver resolver(*_acceptorReactor);
+    WrappedResolver resolver(*_acceptorReactors.front());
+
+    auto acceptorsPerAddress = _listenerOptions.acceptorsPerAddress;
+    if (acceptorsPerAddress == 0) {
+        acceptorsPerAddress = _ingressReactors.size();
+    }
+#ifndef SO_REUSEPORT
+    if (acceptorsPerAddress > 1) {
+        warning() << "SO_REUSEPORT is not supported, listening with one acceptor per address";
+        acceptorsPerAddress = 1;
+    }
+#endif
 
     for (auto& ip : listenAddrs) {
         std::error_code ec;
@@ -682,51 +750,106 @@ Status TransportLayerASIO::setup() {
                 fassertFailedNoTrace(40488);
             }
 
-            GenericAcceptor acceptor(*_acceptorReactor);
-            acceptor.open(addr->protocol());
-            acceptor.set_option(GenericAcceptor::reuse_address(true));
-            if (addr.family() == AF_INET6) {
-                acceptor.set_option(asio::ip::v6_only(true));
-            }
-
-            acceptor.non_blocking(true, ec);
-            if (ec) {
-                return errorCodeToStatus(ec);
+            // UNIX sockets cannot share their path, so only TCP addresses get several acceptors.
+            const bool isTCP = addr.family() == AF_INET || addr.family() == AF_INET6;
+            const size_t acceptorCount = isTCP ? acceptorsPerAddress : 1;
+            while (_acceptorReactors.size() < acceptorCount) {
+                _acceptorReactors.emplace_back(std::make_shared<ASIOReactor>());
             }
+            // With one acceptor per ingress reactor, each one keeps its connections on its own
+            // reactor.
+            const bool pinIngressReactor =
+                acceptorCount > 1 && acceptorCount == _ingressReactors.size();
 
-            acceptor.bind(*addr, ec);
-            if (ec) {
-                return errorCodeToStatus(ec);
+            sockaddr_storage sa;
+            memcpy(&sa, addr->data(), addr->size());
+            const size_t firstAcceptor = _acceptors.size();
+
+            auto endpoint = *addr;
+#ifdef SO_REUSEPORT
+            if (acceptorCount > 1) {
+                // SO_REUSEPORT would also let the acceptors share the port with any other process
+                // of the same user listening on it with the option. The address is bound once
+                // without it first, which fails if someone else owns the port.
+                GenericAcceptor probe(*_acceptorReactors[0]);
+                probe.open(addr->protocol());
+                probe.set_option(GenericAcceptor::reuse_address(true));
+                if (addr.family() == AF_INET6) {
+                    probe.set_option(asio::ip::v6_only(true));
+                }
+                probe.bind(*addr, ec);
+                if (!ec) {
+                    // Keeps an ephemeral port for the acceptors.
+                    endpoint = probe.local_endpoint(ec);
+                }
+                if (ec) {
+                    return errorCodeToStatus(ec);
+                }
             }
+#endif
 
-#ifndef _WIN32
-            if (addr.family() == AF_UNIX) {
-                if (::chmod(addr.toString().c_str(), serverGlobalParams.unixSocketPermissions) ==
-                    -1) {
-                    error() << "Failed to chmod socket file " << addr.toString().c_str() << " "
-                            << errnoWithDescription(errno);
-                    fassertFailedNoTrace(40487);
+            for (size_t i = 0; i < acceptorCount; ++i) {
+                GenericAcceptor acceptor(*_acceptorReactors[i]);
+                acceptor.open(addr->protocol());
+                acceptor.set_option(GenericAcceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+                if (acceptorCount > 1) {
+                    acceptor.set_option(ReusePortOption(true));
                 }
-            }
 #endif
-            if (_listenerOptions.port == 0 &&
-                (addr.family() == AF_INET || addr.family() == AF_INET6)) {
-                if (_listenerPort != _listenerOptions.port) {
-                    return Status(ErrorCodes::BadValue,
-                                  "Port 0 (ephemeral port) is not allowed when"
-                                  " listening on multiple IP interfaces");
+                if (addr.family() == AF_INET6) {
+                    acceptor.set_option(asio::ip::v6_only(true));
                 }
-                std::error_code ec;
-                auto endpoint = acceptor.local_endpoint(ec);
+
+                acceptor.non_blocking(true, ec);
                 if (ec) {
                     return errorCodeToStatus(ec);
                 }
-                _listenerPort = endpointToHostAndPort(endpoint).port();
-            }
 
-            sockaddr_storage sa;
-            memcpy(&sa, addr->data(), addr->size());
-            _acceptors.emplace_back(SockAddr(sa, addr->size()), std::move(acceptor));
+                if (i == 0) {
+                    acceptor.bind(endpoint, ec);
+                } else {
+                    // Binding to the first acceptor's endpoint reuses its port even if it was
+                    // ephemeral.
+                    auto firstEndpoint = _acceptors[firstAcceptor].acceptor.local_endpoint(ec);
+                    if (!ec) {
+                        acceptor.bind(firstEndpoint, ec);
+                    }
+                }
+                if (ec) {
+                    return errorCodeToStatus(ec);
+                }
+
+                if (i == 0) {
+#ifndef _WIN32
+                    if (addr.family() == AF_UNIX) {
+                        if (::chmod(addr.toString().c_str(),
+                                    serverGlobalParams.unixSocketPermissions) == -1) {
+                            error() << "Failed to chmod socket file " << addr.toString().c_str()
+                                    << " " << errnoWithDescription(errno);
+                            fassertFailedNoTrace(40487);
+                        }
+                    }
+#endif
+                    if (_listenerOptions.port == 0 && isTCP) {
+                        if (_listenerPort != _listenerOptions.port) {
+                            return Status(ErrorCodes::BadValue,
+                                          "Port 0 (ephemeral port) is not allowed when"
+                                          " listening on multiple IP interfaces");
+                        }
+                        std::error_code ec;
+                        auto endpoint = acceptor.local_endpoint(ec);
+                        if (ec) {
+                            return errorCodeToStatus(ec);
+                        }
+                        _listenerPort = endpointToHostAndPort(endpoint).port();
+                    }
+                }
+
+                _acceptors.push_back({SockAddr(sa, addr->size()),
+                                      std::move(acceptor),
+                                      pinIngressReactor ? static_cast<int>(i) : -1});
+            }
         }
     }
 
@@ -771,16 +894,23 @@ Status TransportLayerASIO::start() {
 
     if (_listenerOptions.isIngress()) {
         for (auto& acceptor : _acceptors) {
-            acceptor.second.listen(serverGlobalParams.listenBacklog);
-            _acceptConnection(acceptor.second);
+            acceptor.acceptor.listen(serverGlobalParams.listenBacklog);
+            _acceptConnection(acceptor);
         }
 
-        _listenerThread = stdx::thread([this] {
-            setThreadName("listener");
-            while (_running.load()) {
-                _acceptorReactor->run();
+        for (size_t i = 0; i < _acceptorReactors.size(); ++i) {
+            std::string threadName = "listener";
+            if (i > 0) {
+                threadName = str::stream() << "listener-" << i;
             }
-        });
+            _listenerThreads.emplace_back(
+                [ this, reactor = _acceptorReactors[i], threadName = std::move(threadName) ] {
+                    setThreadName(threadName);
+                    while (_running.load()) {
+                        reactor->run();
+                    }
+                });
+        }
 
         const char* ssl = "";
 #ifdef MONGO_CONFIG_SSL
@@ -803,8 +933,8 @@ void TransportLayerASIO::shutdown() {
     // Loop through the acceptors and cancel their calls to async_accept. This will prevent new
     // connections from being opened.
     for (auto& acceptor : _acceptors) {
-        acceptor.second.cancel();
-        auto& addr = acceptor.first;
+        acceptor.acceptor.cancel();
+        auto& addr = acceptor.addr;
         if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
             auto path = addr.getAddr();
             log() << "removing socket file: " << path;
@@ -815,15 +945,19 @@ void TransportLayerASIO::shutdown() {
         }
     }
 
-    // If the listener thread is joinable (that is, we created/started a listener thread), then
-    // the io_context is owned exclusively by the TransportLayer and we should stop it and join
-    // the listener thread.
+    // If we created/started listener threads, then the io_contexts are owned exclusively by the
+    // TransportLayer and we should stop them and join the listener threads.
     //
     // Otherwise the ServiceExecutor may need to continue running the io_context to drain running
     // connections, so we just cancel the acceptors and return.
-    if (_listenerThread.joinable()) {
-        _acceptorReactor->stop();
-        _listenerThread.join();
+    if (!_listenerThreads.empty()) {
+        for (auto& reactor : _acceptorReactors) {
+            reactor->stop();
+        }
+        for (auto& thread : _listenerThreads) {
+            thread.join();
+        }
+        _listenerThreads.clear();
     }
 }
 
@@ -850,34 +984,63 @@ std::vector<ReactorHandle> TransportLayerASIO::getIngressReactors() {
     return reactorHandles;
 }
 
-void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
+size_t TransportLayerASIO::_nextIngressReactorId(const Acceptor& acceptor) {
+    if (acceptor.ingressReactorId >= 0) {
+        return static_cast<size_t>(acceptor.ingressReactorId);
+    }
+    return _acceptedCount.addAndFetch(1) % _ingressReactors.size();
+}
 
-    auto acceptCb = [this, &acceptor](const std::error_code& ec, GenericSocket peerSocket) mutable {
+void TransportLayerASIO::_acceptConnection(Acceptor& acceptor) {
+    const size_t reactorId = _nextIngressReactorId(acceptor);
+    auto acceptCb = [this, &acceptor, reactorId](const std::error_code& ec,
+                                                 GenericSocket peerSocket) mutable {
         if (!_running.load())
             return;
 
+        auto& socketAcceptor = acceptor.acceptor;
         if (ec) {
             log() << "Error accepting new connection on "
-                  << endpointToHostAndPort(acceptor.local_endpoint()) << ": " << ec.message();
+                  << endpointToHostAndPort(socketAcceptor.local_endpoint()) << ": "
+                  << ec.message();
             _acceptConnection(acceptor);
             return;
         }
 
-        try {
-            std::shared_ptr<ASIOSession> session(
-                new ASIOSession(this, std::move(peerSocket), true));
-            _sep->startSession(std::move(session));
-        } catch (const DBException& e) {
-            warning() << "Error accepting new connection " << e;
+        auto startSession = [this](GenericSocket socket, size_t id) {
+            try {
+                std::shared_ptr<ASIOSession> session(
+                    new ASIOSession(this, std::move(socket), true, static_cast<int>(id)));
+                _sep->startSession(std::move(session));
+            } catch (const DBException& e) {
+                warning() << "Error accepting new connection " << e;
+            }
+        };
+        startSession(std::move(peerSocket), reactorId);
+
+        // During a reconnect storm the backlog holds many more connections. Taking them with
+        // non-blocking accepts saves a trip through the reactor for each one.
+        const int batchSize = listenerAcceptBatchSize.load();
+        for (int accepted = 1; accepted < batchSize && _running.load(); ++accepted) {
+            const size_t nextReactorId = _nextIngressReactorId(acceptor);
+            GenericSocket nextSocket(*_ingressReactors[nextReactorId]);
+            std::error_code acceptEc;
+            socketAcceptor.accept(nextSocket, acceptEc);
+            if (acceptEc) {
+                if (acceptEc != asio::error::would_block && acceptEc != asio::error::try_again) {
+                    log() << "Error accepting new connection on "
+                          << endpointToHostAndPort(socketAcceptor.local_endpoint()) << ": "
+                          << acceptEc.message();
+                }
+                break;
+            }
+            startSession(std::move(nextSocket), nextReactorId);
         }
 
         _acceptConnection(acceptor);
     };
-    _acceptedCount++;
-    MONGO_LOG(0) << "accept thread name: " << getThreadName()
-                 << " ingressReactor: " << _acceptedCount % serverGlobalParams.adaptiveThreadNum;
-    acceptor.async_accept(*_ingressReactors[_acceptedCount % serverGlobalParams.adaptiveThreadNum],
-                          std::move(acceptCb));
+    LOG(2) << "accept thread name: " << getThreadName() << " ingressReactor: " << reactorId;
+    acceptor.acceptor.async_accept(*_ingressReactors[reactorId], std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
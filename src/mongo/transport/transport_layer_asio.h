@@ -35,6 +35,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/config.h"
 #include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
@@ -109,6 +110,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t acceptorsPerAddress = 1;  // listening sockets bound to each TCP address with
+                                         // SO_REUSEPORT, 0 for one per ingress reactor
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -148,7 +151,10 @@ private:
     using ConstASIOSessionHandle = std::shared_ptr<const ASIOSession>;
     using GenericAcceptor = asio::basic_socket_acceptor<asio::generic::stream_protocol>;
 
-    void _acceptConnection(GenericAcceptor& acceptor);
+    struct Acceptor;
+
+    void _acceptConnection(Acceptor& acceptor);
+    size_t _nextIngressReactorId(const Acceptor& acceptor);
 
     template <typename Endpoint>
     StatusWith<ASIOSessionHandle> _doSyncConnect(Endpoint endpoint,
@@ -161,9 +167,10 @@ private:
 
     stdx::mutex _mutex;
 
-    // There are three reactors that are used by TransportLayerASIO. The _ingressReactor contains
-    // all the accepted sockets and all ingress networking activity. The _acceptorReactor contains
-    // all the sockets in _acceptors.  The _egressReactor contains egress connections.
+    // There are three kinds of reactors that are used by TransportLayerASIO. The _ingressReactors
+    // contain all the accepted sockets and all ingress networking activity. The _acceptorReactors
+    // contain all the sockets in _acceptors, each one run by its own listener thread. The
+    // _egressReactor contains egress connections.
     //
     // TransportLayerASIO should never call run() on the _ingressReactor.
     // In synchronous mode, this will cause a massive performance degradation due to
@@ -172,7 +179,7 @@ private:
     // with the acceptors epoll set, thus avoiding those wakeups.  Calling run will
     // undo that benefit.
     //
-    // TransportLayerASIO should run its own thread that calls run() on the _acceptorReactor
+    // TransportLayerASIO should run its own threads that call run() on the _acceptorReactors
     // to process calls to async_accept - this is the equivalent of the "listener" thread in
     // other TransportLayers.
     //
@@ -186,19 +193,22 @@ private:
     // std::shared_ptr<ASIOReactor> _ingressReactor;
     std::vector<std::shared_ptr<ASIOReactor>> _ingressReactors;
     std::shared_ptr<ASIOReactor> _egressReactor;
-    std::shared_ptr<ASIOReactor> _acceptorReactor;
+    // When a TCP address gets several acceptors, the i-th one runs on the i-th reactor, so that
+    // the kernel spreads new connections over as many listener threads.
+    std::vector<std::shared_ptr<ASIOReactor>> _acceptorReactors;
 
-    size_t _acceptedCount{0};
+    AtomicWord<unsigned long long> _acceptedCount{0};
 
 #ifdef MONGO_CONFIG_SSL
     std::unique_ptr<asio::ssl::context> _ingressSSLContext;
     std::unique_ptr<asio::ssl::context> _egressSSLContext;
 #endif
 
-    std::vector<std::pair<SockAddr, GenericAcceptor>> _acceptors;
+    // Acceptors keep their address in this vector once setup() returns.
+    std::vector<Acceptor> _acceptors;
 
-    // Only used if _listenerOptions.async is false.
-    stdx::thread _listenerThread;
+    // One per acceptor reactor.
+    std::vector<stdx::thread> _listenerThreads;
 
     ServiceEntryPoint* const _sep = nullptr;
     AtomicWord<bool> _running{false};
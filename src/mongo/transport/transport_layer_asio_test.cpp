@@ -84,9 +84,9 @@ public:
         _transport = tl;
     }
 
-    void waitForConnect() {
+    void waitForConnect(size_t sessions = 1) {
         stdx::unique_lock<stdx::mutex> lock(_mutex);
-        _cv.wait(lock, [&] { return !_sessions.empty(); });
+        _cv.wait(lock, [&] { return _sessions.size() >= sessions; });
     }
 
 private:
@@ -159,6 +159,66 @@ TEST(TransportLayerASIO, PortZeroConnect) {
     tla.shutdown();
 }
 
+TEST(TransportLayerASIO, MultipleAcceptorsPortZeroConnect) {
+    ServiceEntryPointUtil sepu;
+
+    auto options = [] {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerASIO::Options opts(&params);
+        opts.port = 0;
+        opts.acceptorsPerAddress = 4;
+        return opts;
+    }();
+
+    transport::TransportLayerASIO tla(options, &sepu);
+    sepu.setTransportLayer(&tla);
+
+    ASSERT_OK(tla.setup());
+    ASSERT_OK(tla.start());
+    int port = tla.listenerPort();
+    ASSERT_GT(port, 0);
+
+    // Enough connections that every acceptor is likely to get some.
+    const size_t kConnections = 16;
+    std::vector<std::unique_ptr<SimpleConnectionThread>> connectThreads;
+    for (size_t i = 0; i < kConnections; ++i) {
+        connectThreads.push_back(stdx::make_unique<SimpleConnectionThread>(port));
+    }
+    sepu.waitForConnect(kConnections);
+    for (auto& connectThread : connectThreads) {
+        connectThread->stop();
+    }
+    sepu.endAllSessions({});
+    tla.shutdown();
+}
+
+TEST(TransportLayerASIO, MultipleAcceptorsDoNotShareAPortWithOthers) {
+    ServiceEntryPointUtil sepu;
+
+    auto makeOptions = [](int port) {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerASIO::Options opts(&params);
+        opts.port = port;
+        opts.acceptorsPerAddress = 4;
+        return opts;
+    };
+
+    transport::TransportLayerASIO tla(makeOptions(0), &sepu);
+    sepu.setTransportLayer(&tla);
+    ASSERT_OK(tla.setup());
+    ASSERT_OK(tla.start());
+
+    // Its acceptors set SO_REUSEPORT, but another listener asking for the port is still refused.
+    ServiceEntryPointUtil otherSepu;
+    transport::TransportLayerASIO other(makeOptions(tla.listenerPort()), &otherSepu);
+    otherSepu.setTransportLayer(&other);
+    ASSERT_NOT_OK(other.setup());
+
+    tla.shutdown();
+}
+
 class TimeoutSEP : public ServiceEntryPoint {
 public:
     void endAllSessions(transport::Session::TagMask tags) override {
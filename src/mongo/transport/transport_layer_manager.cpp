@@ -26,11 +26,14 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/transport/transport_layer_manager.h"
 
 #include "mongo/base/status.h"
+#include "mongo/config.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
@@ -38,10 +41,15 @@
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/log.h"
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 #include <limits>
 
+#ifdef MONGO_CONFIG_IO_URING
+#include "mongo/transport/transport_layer_uring.h"
+#endif
+
 #include <iostream>
 
 namespace mongo {
@@ -126,11 +134,53 @@ std::unique_ptr<TransportLayer> TransportLayerManager::makeAndStartDefaultEgress
     return std::unique_ptr<TransportLayer>(std::move(ret));
 }
 
+#ifdef MONGO_CONFIG_IO_URING
+namespace {
+std::unique_ptr<TransportLayer> createUring(const ServerGlobalParams* config,
+                                            ServiceContext* ctx) {
+    auto sep = ctx->getServiceEntryPoint();
+
+    transport::TransportLayerASIO::Options opts(config);
+    opts.transportMode = transport::Mode::kAsynchronous;
+    auto transportLayerUring = stdx::make_unique<transport::TransportLayerUring>(opts, sep);
+
+    auto reactors = transportLayerUring->getIngressReactors();
+    if (sep && sep->adoptIngressReactors(reactors)) {
+        // The coroutine thread groups poll the reactors, the adaptive executor runs none.
+        reactors.clear();
+    }
+    ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorAdaptive>(ctx, std::move(reactors)));
+
+    // The io_uring transport layer only accepts sessions. Egress connections and batons come from
+    // an ASIO transport layer, which goes first since the manager connects through its first one.
+    transport::TransportLayerASIO::Options egressOpts(config);
+    egressOpts.mode = transport::TransportLayerASIO::Options::kEgress;
+    egressOpts.ipList.clear();
+
+    std::vector<std::unique_ptr<TransportLayer>> retVector;
+    retVector.emplace_back(stdx::make_unique<transport::TransportLayerASIO>(egressOpts, nullptr));
+    retVector.emplace_back(std::move(transportLayerUring));
+    return stdx::make_unique<TransportLayerManager>(std::move(retVector));
+}
+}  // namespace
+#endif
+
 std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     const ServerGlobalParams* config, ServiceContext* ctx) {
     std::unique_ptr<TransportLayer> transportLayer;
     auto sep = ctx->getServiceEntryPoint();
 
+#ifdef MONGO_CONFIG_IO_URING
+    if (config->transportLayer == "uring") {
+        auto status = transport::TransportLayerUring::checkSupported(config);
+        if (status.isOK()) {
+            return createUring(config, ctx);
+        }
+        warning() << "The io_uring transport layer is unavailable, using asio instead: "
+                  << status;
+    }
+#endif
+
     transport::TransportLayerASIO::Options opts(config);
     if (config->serviceExecutor == "adaptive") {
         opts.transportMode = transport::Mode::kAsynchronous;
@@ -145,6 +195,10 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     if (config->serviceExecutor == "adaptive") {
         // auto reactor = transportLayerASIO->getReactor(TransportLayer::kIngress);
         auto reactors = transportLayerASIO->getIngressReactors();
+        if (sep && sep->adoptIngressReactors(reactors)) {
+            // The coroutine thread groups poll the reactors, the adaptive executor runs none.
+            reactors.clear();
+        }
         ctx->setServiceExecutor(
             stdx::make_unique<ServiceExecutorAdaptive>(ctx, std::move(reactors)));
     } else if (config->serviceExecutor == "synchronous") {
@@ -0,0 +1,1333 @@
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_uring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <liburing.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/rpc/message.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/session.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/socket_utils.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+// Submission queue entries of each ingress ring. Only read at startup.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ioUringQueueDepth, int, 1024);
+
+// Number and size of the receive buffers each ingress ring provides to the kernel. The number is
+// rounded up to a power of two. Only read at startup.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ioUringRecvBufferCount, int, 256);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ioUringRecvBufferKB, int, 16);
+
+constexpr unsigned short kRecvBufferGroup = 0;
+constexpr size_t kHeaderSize = sizeof(MSGHEADER::Value);
+
+// A session stops receiving once this many bytes wait to be sourced, and starts again when the
+// next message is sourced.
+constexpr size_t kMaxBufferedInput = 1024 * 1024;
+
+// user_data of submissions whose completion needs no handling, and of the reactor wake-up poll.
+constexpr uint64_t kIgnoredTag = 0;
+constexpr uint64_t kWakeupTag = 1;
+
+constexpr unsigned kReapBatch = 64;
+
+const Status kClosedStatus{ErrorCodes::HostUnreachable, "Connection was closed"};
+
+Status systemError(int err, StringData what) {
+    return {ErrorCodes::SocketException,
+            str::stream() << what << " failed: " << errnoWithDescription(err)};
+}
+
+// Same mapping as errorCodeToStatus() for ASIO sessions.
+Status errnoToStatus(int err) {
+    switch (err) {
+        case ECANCELED:
+            return {ErrorCodes::CallbackCanceled, "Callback was canceled"};
+        case EAGAIN:
+            return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+        case ECONNRESET:
+        case ENETRESET:
+        case EPIPE:
+            return kClosedStatus;
+        default:
+            return {ErrorCodes::SocketException, errnoWithDescription(err)};
+    }
+}
+
+__kernel_timespec toTimespec(Milliseconds duration) {
+    const auto ms = std::max(0LL, durationCount<Milliseconds>(duration));
+    __kernel_timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000 * 1000;
+    return ts;
+}
+
+unsigned roundUpToPowerOfTwo(unsigned value) {
+    unsigned result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * Kernels before 6.0 either lack io_uring, or reject provided buffer rings or multishot
+ * receives. Receiving a byte over a socket pair the way sessions do tells them apart.
+ */
+Status probeKernel() {
+    io_uring ring;
+    int ret = io_uring_queue_init(8, &ring, 0);
+    if (ret < 0) {
+        return systemError(-ret, "io_uring_queue_init");
+    }
+    ON_BLOCK_EXIT([&] { io_uring_queue_exit(&ring); });
+
+    char buffer[64];
+    auto bufRing = io_uring_setup_buf_ring(&ring, 1, kRecvBufferGroup, 0, &ret);
+    if (!bufRing) {
+        return systemError(-ret, "io_uring_setup_buf_ring");
+    }
+    ON_BLOCK_EXIT([&] { io_uring_free_buf_ring(&ring, bufRing, 1, kRecvBufferGroup); });
+    io_uring_buf_ring_add(bufRing, buffer, sizeof(buffer), 0, io_uring_buf_ring_mask(1), 0);
+    io_uring_buf_ring_advance(bufRing, 1);
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return systemError(errno, "socketpair");
+    }
+    ON_BLOCK_EXIT([&] {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    });
+
+    auto sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_recv_multishot(sqe, fds[0], nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kRecvBufferGroup;
+    if (::write(fds[1], "x", 1) != 1) {
+        return systemError(errno, "write");
+    }
+
+    io_uring_cqe* cqe;
+    ret = io_uring_submit_and_wait(&ring, 1);
+    if (ret >= 0) {
+        ret = io_uring_wait_cqe(&ring, &cqe);
+    }
+    if (ret < 0) {
+        return systemError(-ret, "io_uring_submit_and_wait");
+    }
+    const int res = cqe->res;
+    io_uring_cqe_seen(&ring, cqe);
+    if (res < 0) {
+        return systemError(-res, "multishot recv");
+    }
+    return Status::OK();
+}
+}  // namespace
+
+/**
+ * A reactor running an io_uring. The ring is only touched by the thread which last ran or polled
+ * the reactor; other threads hand their work over with schedule(), which wakes the reactor up
+ * through an eventfd.
+ */
+class TransportLayerUring::UringReactor final
+    : public Reactor,
+      public std::enable_shared_from_this<TransportLayerUring::UringReactor> {
+public:
+    /**
+     * An operation submitted to the ring. Multishot operations complete several times. An
+     * operation is deleted after its last completion, unless complete() submitted it again.
+     */
+    class Op {
+    public:
+        virtual ~Op() = default;
+        virtual bool complete(int res, unsigned flags) = 0;
+    };
+
+    UringReactor() = default;
+
+    ~UringReactor() {
+        if (_bufRing) {
+            io_uring_free_buf_ring(&_ring, _bufRing, _recvBufferCount, kRecvBufferGroup);
+        }
+        if (_ringInitialized) {
+            io_uring_queue_exit(&_ring);
+        }
+        if (_eventFd >= 0) {
+            ::close(_eventFd);
+        }
+    }
+
+    Status init() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        // Completions are only reaped by the reactor thread, so the kernel may defer its task
+        // work until that thread enters the ring instead of interrupting it.
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+        const unsigned entries = static_cast<unsigned>(std::max(64, ioUringQueueDepth));
+        int ret = io_uring_queue_init_params(entries, &_ring, &params);
+        if (ret == -EINVAL) {
+            memset(&params, 0, sizeof(params));
+            ret = io_uring_queue_init_params(entries, &_ring, &params);
+        }
+        if (ret < 0) {
+            return systemError(-ret, "io_uring_queue_init");
+        }
+        _ringInitialized = true;
+
+        _recvBufferCount = roundUpToPowerOfTwo(
+            static_cast<unsigned>(std::min(32768, std::max(1, ioUringRecvBufferCount))));
+        _recvBufferSize = static_cast<size_t>(std::max(1, ioUringRecvBufferKB)) * 1024;
+        _recvBuffers.reset(new char[_recvBufferCount * _recvBufferSize]);
+        _bufRing = io_uring_setup_buf_ring(&_ring, _recvBufferCount, kRecvBufferGroup, 0, &ret);
+        if (!_bufRing) {
+            return systemError(-ret, "io_uring_setup_buf_ring");
+        }
+        const int mask = io_uring_buf_ring_mask(_recvBufferCount);
+        for (unsigned id = 0; id < _recvBufferCount; ++id) {
+            io_uring_buf_ring_add(_bufRing, recvBuffer(id), _recvBufferSize, id, mask, id);
+        }
+        io_uring_buf_ring_advance(_bufRing, _recvBufferCount);
+
+        _eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_eventFd < 0) {
+            return systemError(errno, "eventfd");
+        }
+        _armWakeup();
+        return Status::OK();
+    }
+
+    void run() noexcept override {
+        _setOwner();
+        try {
+            while (!_stopped.load()) {
+                _runOnce(Milliseconds(100));
+            }
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51403);
+        }
+    }
+
+    void runFor(Milliseconds time) noexcept override {
+        _setOwner();
+        try {
+            const auto deadline = now() + time;
+            for (auto current = now(); current < deadline && !_stopped.load(); current = now()) {
+                _runOnce(deadline - current);
+            }
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51404);
+        }
+    }
+
+    size_t poll() noexcept override {
+        _setOwner();
+        try {
+            return _runOnce(Milliseconds(0));
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51405);
+        }
+    }
+
+    size_t runOneFor(Milliseconds time) noexcept override {
+        _setOwner();
+        try {
+            return _runOnce(time);
+        } catch (...) {
+            severe() << "Uncaught exception in reactor: " << exceptionToStatus();
+            fassertFailed(51406);
+        }
+    }
+
+    void stop() override {
+        _stopped.store(true);
+        _wakeup();
+    }
+
+    void drain() override {
+        _setOwner();
+        while (_runOnce(Milliseconds(0))) {
+            LOG(2) << "Draining remaining work in reactor.";
+        }
+        _stopped.store(true);
+    }
+
+    std::unique_ptr<ReactorTimer> makeTimer() override;
+
+    Date_t now() override {
+        return Date_t::now();
+    }
+
+    void schedule(ScheduleMode mode, Task task) override {
+        const bool onThread = onReactorThread();
+        if (mode == kDispatch && onThread) {
+            task();
+            return;
+        }
+
+        bool wasEmpty;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_tasksMutex);
+            wasEmpty = _tasks.empty();
+            _tasks.push_back(std::move(task));
+            _hasTasks.store(true, std::memory_order_release);
+        }
+        // A non-empty queue was already signalled, and the reactor thread runs the queue before
+        // it waits.
+        if (wasEmpty && !onThread) {
+            _wakeup();
+        }
+    }
+
+    bool onReactorThread() const override {
+        return _owner.load(std::memory_order_relaxed) == stdx::this_thread::get_id();
+    }
+
+    /**
+     * Returns a submission queue entry, which is submitted with the next poll. Must be called
+     * on the reactor thread.
+     */
+    io_uring_sqe* getSqe() {
+        auto sqe = io_uring_get_sqe(&_ring);
+        if (!sqe) {
+            // The submission queue is full, submit early to make room.
+            io_uring_submit(&_ring);
+            sqe = io_uring_get_sqe(&_ring);
+        }
+        uassert(ErrorCodes::InternalError, "The io_uring submission queue is full", sqe);
+        return sqe;
+    }
+
+    void submit(Op* op, io_uring_sqe* sqe) {
+        io_uring_sqe_set_data(sqe, op);
+    }
+
+    void cancel(Op* op) {
+        auto sqe = getSqe();
+        io_uring_prep_cancel64(sqe, reinterpret_cast<uint64_t>(op), 0);
+        io_uring_sqe_set_data64(sqe, kIgnoredTag);
+    }
+
+    void removeTimeout(Op* op) {
+        auto sqe = getSqe();
+        io_uring_prep_timeout_remove(sqe, reinterpret_cast<uint64_t>(op), 0);
+        io_uring_sqe_set_data64(sqe, kIgnoredTag);
+    }
+
+    char* recvBuffer(unsigned id) const {
+        return _recvBuffers.get() + static_cast<size_t>(id) * _recvBufferSize;
+    }
+
+    /**
+     * Hands a receive buffer back to the kernel once its contents have been consumed.
+     */
+    void recycleRecvBuffer(unsigned id) {
+        io_uring_buf_ring_add(_bufRing,
+                              recvBuffer(id),
+                              _recvBufferSize,
+                              id,
+                              io_uring_buf_ring_mask(_recvBufferCount),
+                              0);
+        io_uring_buf_ring_advance(_bufRing, 1);
+    }
+
+private:
+    struct Completion {
+        uint64_t userData;
+        int res;
+        unsigned flags;
+    };
+
+    void _setOwner() {
+        _owner.store(stdx::this_thread::get_id(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Runs the scheduled tasks, submits everything prepared since the previous call with a single
+     * io_uring_enter, waiting up to 'wait' for a completion if there was nothing to do, and runs
+     * the completion handlers. Returns how many tasks and handlers ran.
+     */
+    size_t _runOnce(Milliseconds wait) {
+        size_t ran = _runTasks();
+        if (ran == 0 && wait > Milliseconds(0) && io_uring_cq_ready(&_ring) == 0) {
+            auto ts = toTimespec(wait);
+            io_uring_cqe* cqe;
+            int ret = io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, &ts, nullptr);
+            if (ret < 0 && ret != -ETIME && ret != -EINTR) {
+                LOG(1) << "io_uring_submit_and_wait_timeout failed: "
+                       << errnoWithDescription(-ret);
+            }
+        } else if (io_uring_sq_ready(&_ring) > 0) {
+            int ret = io_uring_submit(&_ring);
+            if (ret < 0 && ret != -EINTR) {
+                LOG(1) << "io_uring_submit failed: " << errnoWithDescription(-ret);
+            }
+        }
+        return ran + _reap();
+    }
+
+    size_t _runTasks() {
+        if (!_hasTasks.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        {
+            stdx::lock_guard<stdx::mutex> lk(_tasksMutex);
+            _runningTasks.swap(_tasks);
+            _hasTasks.store(false, std::memory_order_relaxed);
+        }
+        const size_t count = _runningTasks.size();
+        for (auto& task : _runningTasks) {
+            task();
+        }
+        _runningTasks.clear();
+        return count;
+    }
+
+    size_t _reap() {
+        io_uring_cqe* cqes[kReapBatch];
+        Completion batch[kReapBatch];
+        size_t reaped = 0;
+        unsigned count;
+        do {
+            count = io_uring_peek_batch_cqe(&_ring, cqes, kReapBatch);
+            for (unsigned i = 0; i < count; ++i) {
+                batch[i] = {io_uring_cqe_get_data64(cqes[i]), cqes[i]->res, cqes[i]->flags};
+            }
+            // Handlers may prepare new submissions, so the slots are released before they run.
+            io_uring_cq_advance(&_ring, count);
+            for (unsigned i = 0; i < count; ++i) {
+                _complete(batch[i]);
+            }
+            reaped += count;
+        } while (count == kReapBatch);
+        return reaped;
+    }
+
+    void _complete(const Completion& completion) {
+        const bool more = completion.flags & IORING_CQE_F_MORE;
+        if (completion.userData == kIgnoredTag) {
+            return;
+        }
+        if (completion.userData == kWakeupTag) {
+            uint64_t count;
+            if (::read(_eventFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                LOG(1) << "Failed to read the reactor eventfd: " << errnoWithDescription();
+            }
+            if (!more) {
+                _armWakeup();
+            }
+            return;
+        }
+
+        auto op = reinterpret_cast<Op*>(completion.userData);
+        if (!op->complete(completion.res, completion.flags) && !more) {
+            delete op;
+        }
+    }
+
+    void _armWakeup() {
+        auto sqe = getSqe();
+        io_uring_prep_poll_multishot(sqe, _eventFd, POLLIN);
+        io_uring_sqe_set_data64(sqe, kWakeupTag);
+    }
+
+    void _wakeup() {
+        const uint64_t one = 1;
+        if (::write(_eventFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOG(1) << "Failed to wake up the reactor: " << errnoWithDescription();
+        }
+    }
+
+    io_uring _ring;
+    bool _ringInitialized = false;
+
+    io_uring_buf_ring* _bufRing = nullptr;
+    std::unique_ptr<char[]> _recvBuffers;
+    unsigned _recvBufferCount = 0;
+    size_t _recvBufferSize = 0;
+
+    int _eventFd = -1;
+
+    stdx::mutex _tasksMutex;
+    std::vector<Task> _tasks;
+    std::atomic<bool> _hasTasks{false};
+    // Only used by the reactor thread.
+    std::vector<Task> _runningTasks;
+
+    std::atomic<stdx::thread::id> _owner{};
+    AtomicWord<bool> _stopped{false};
+};
+
+/**
+ * A timer backed by IORING_OP_TIMEOUT. The timeout is submitted and removed on the reactor
+ * thread, the futures are filled there too.
+ */
+class TransportLayerUring::UringTimer final : public ReactorTimer {
+public:
+    explicit UringTimer(std::shared_ptr<UringReactor> reactor) : _reactor(std::move(reactor)) {}
+
+    ~UringTimer() {
+        cancel();
+    }
+
+    void cancel(const BatonHandle& baton = nullptr) override {
+        auto state = std::exchange(_state, nullptr);
+        if (!state) {
+            return;
+        }
+        _reactor->schedule(Reactor::kDispatch, [ reactor = _reactor, state ] {
+            if (state->done) {
+                return;
+            }
+            state->done = true;
+            if (state->op) {
+                reactor->removeTimeout(state->op);
+            }
+            state->promise.setError({ErrorCodes::CallbackCanceled, "Timer was canceled"});
+        });
+    }
+
+    Future<void> waitFor(Milliseconds timeout, const BatonHandle& baton = nullptr) override {
+        return waitUntil(_reactor->now() + timeout, baton);
+    }
+
+    Future<void> waitUntil(Date_t deadline, const BatonHandle& baton = nullptr) override {
+        cancel();
+        auto pf = makePromiseFuture<void>();
+        _state = std::make_shared<State>(std::move(pf.promise));
+        _reactor->schedule(Reactor::kDispatch, [ reactor = _reactor, state = _state, deadline ] {
+            if (state->done) {
+                return;
+            }
+            const auto remaining = deadline - reactor->now();
+            if (remaining <= Milliseconds(0)) {
+                state->done = true;
+                state->promise.emplaceValue();
+                return;
+            }
+            auto sqe = reactor->getSqe();
+            auto op = new TimeoutOp(state);
+            op->ts = toTimespec(remaining);
+            io_uring_prep_timeout(sqe, &op->ts, 0, 0);
+            reactor->submit(op, sqe);
+            state->op = op;
+        });
+        return std::move(pf.future);
+    }
+
+private:
+    struct State {
+        explicit State(Promise<void> p) : promise(std::move(p)) {}
+
+        Promise<void> promise;
+        // The submitted timeout, until it completes.
+        UringReactor::Op* op = nullptr;
+        bool done = false;
+    };
+
+    class TimeoutOp final : public UringReactor::Op {
+    public:
+        explicit TimeoutOp(std::shared_ptr<State> state) : _state(std::move(state)) {}
+
+        bool complete(int res, unsigned flags) override {
+            _state->op = nullptr;
+            if (!_state->done) {
+                _state->done = true;
+                if (res == -ETIME || res == 0) {
+                    _state->promise.emplaceValue();
+                } else {
+                    _state->promise.setError(errnoToStatus(-res));
+                }
+            }
+            return false;
+        }
+
+        __kernel_timespec ts;
+
+    private:
+        const std::shared_ptr<State> _state;
+    };
+
+    const std::shared_ptr<UringReactor> _reactor;
+    std::shared_ptr<State> _state;
+};
+
+std::unique_ptr<ReactorTimer> TransportLayerUring::UringReactor::makeTimer() {
+    return stdx::make_unique<UringTimer>(shared_from_this());
+}
+
+/**
+ * An accepted connection. While a message is being sourced, a multishot recv appends whatever
+ * arrives to the input buffer, so pipelined requests are received without further submissions.
+ * Asynchronous operations run on the session's reactor; when called from another thread they
+ * are handed over to it.
+ */
+class TransportLayerUring::UringSession final : public Session {
+public:
+    UringSession(TransportLayerUring* tl,
+                 std::shared_ptr<UringReactor> reactor,
+                 int reactorId,
+                 int fd,
+                 const SockAddr& remote)
+        : _tl(tl),
+          _reactor(std::move(reactor)),
+          _reactorId(reactorId),
+          _fd(fd),
+          _remote(remote) {
+        sockaddr_storage local;
+        socklen_t len = sizeof(local);
+        if (::getsockname(_fd, reinterpret_cast<sockaddr*>(&local), &len) == 0) {
+            _local = HostAndPort(SockAddr(local, len));
+        }
+    }
+
+    ~UringSession() {
+        end();
+        ::close(_fd);
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    int ingressReactorId() const override {
+        return _reactorId;
+    }
+
+    void end() override {
+        // Shutting the socket down completes the pending recv, which releases the session.
+        if (!_ended.swap(true)) {
+            ::shutdown(_fd, SHUT_RDWR);
+        }
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        while (true) {
+            auto swMessage = _takeMessage();
+            if (!swMessage.isOK()) {
+                return swMessage.getStatus();
+            }
+            if (swMessage.getValue()) {
+                return std::move(*swMessage.getValue());
+            }
+            if (!_recvStatus.isOK()) {
+                return _recvStatus;
+            }
+
+            auto status = _waitFor(POLLIN);
+            if (!status.isOK()) {
+                return status;
+            }
+            char buffer[4096];
+            auto received = ::recv(_fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                _consume(buffer, received);
+            } else if (received == 0) {
+                _setRecvStatus(kClosedStatus);
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                _setRecvStatus(errnoToStatus(errno));
+            }
+        }
+    }
+
+    Future<Message> asyncSourceMessage(const BatonHandle& baton = nullptr) override {
+        if (!_reactor->onReactorThread()) {
+            return _reactor->execute([self = _self()] { return self->asyncSourceMessage(); });
+        }
+        invariant(!_sourcePromise);
+
+        auto swMessage = _takeMessage();
+        if (!swMessage.isOK()) {
+            return Future<Message>::makeReady(swMessage.getStatus());
+        }
+        if (swMessage.getValue()) {
+            return Future<Message>::makeReady(std::move(*swMessage.getValue()));
+        }
+        if (!_recvStatus.isOK()) {
+            return Future<Message>::makeReady(_recvStatus);
+        }
+
+        auto pf = makePromiseFuture<Message>();
+        _sourcePromise.emplace(std::move(pf.promise));
+        _armRecv();
+        return std::move(pf.future);
+    }
+
+    Status sinkMessage(Message message) override {
+        const char* data = message.buf();
+        size_t remaining = message.size();
+        while (remaining > 0) {
+            auto sent = ::send(_fd, data, remaining, MSG_NOSIGNAL);
+            if (sent >= 0) {
+                data += sent;
+                remaining -= sent;
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return errnoToStatus(errno);
+            }
+            auto status = _waitFor(POLLOUT);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        networkCounter.hitPhysicalOut(message.size());
+        return Status::OK();
+    }
+
+    Future<void> asyncSinkMessage(Message message, const BatonHandle& baton = nullptr) override {
+        std::vector<Message> messages;
+        messages.push_back(std::move(message));
+        return asyncSinkMessages(std::move(messages), baton);
+    }
+
+    Future<void> asyncSinkMessages(std::vector<Message> messages,
+                                   const BatonHandle& baton = nullptr) override {
+        if (!_reactor->onReactorThread()) {
+            return _reactor->execute(
+                [ self = _self(), messages ] { return self->asyncSinkMessages(messages); });
+        }
+
+        auto pf = makePromiseFuture<void>();
+        auto op = new SendOp(_self(), std::move(messages), std::move(pf.promise));
+        _submitSend(op);
+        return std::move(pf.future);
+    }
+
+    bool hasBufferedInput() const override {
+        // Called by the thread running the session, while the reactor thread receives.
+        return _bufferedBytes.load(std::memory_order_acquire) > 0;
+    }
+
+    void cancelAsyncOperations(const BatonHandle& baton = nullptr) override {
+        _reactor->schedule(Reactor::kDispatch, [self = _self()] {
+            self->_cancelRecv();
+            self->_failSource({ErrorCodes::CallbackCanceled, "Callback was canceled"});
+        });
+    }
+
+    void setTimeout(boost::optional<Milliseconds> timeout) override {
+        _timeout = timeout;
+    }
+
+    bool isConnected() override {
+        if (hasBufferedInput()) {
+            return true;
+        }
+        if (_recvFailed.load()) {
+            return false;
+        }
+
+        pollfd pfd{_fd, POLLIN, 0};
+        int ret = ::poll(&pfd, 1, 0);
+        if (ret <= 0) {
+            return ret == 0;
+        }
+        char testByte;
+        auto received = ::recv(_fd, &testByte, 1, MSG_PEEK | MSG_DONTWAIT);
+        return received > 0 || (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+
+private:
+    class RecvOp final : public UringReactor::Op {
+    public:
+        explicit RecvOp(std::shared_ptr<UringSession> session) : _session(std::move(session)) {}
+
+        bool complete(int res, unsigned flags) override {
+            _session->_onRecv(res, flags);
+            return false;
+        }
+
+    private:
+        const std::shared_ptr<UringSession> _session;
+    };
+
+    class SendOp final : public UringReactor::Op {
+    public:
+        SendOp(std::shared_ptr<UringSession> session,
+               std::vector<Message> messages,
+               Promise<void> promise)
+            : _session(std::move(session)),
+              _messages(std::move(messages)),
+              _promise(std::move(promise)) {
+            _iovecs.reserve(_messages.size());
+            for (auto& message : _messages) {
+                _iovecs.push_back({const_cast<char*>(message.buf()), message.size()});
+                _total += message.size();
+            }
+            memset(&_msghdr, 0, sizeof(_msghdr));
+        }
+
+        /**
+         * Points the message header at the bytes which have not been sent yet.
+         */
+        msghdr* msgHeader() {
+            _msghdr.msg_iov = _iovecs.data() + _next;
+            _msghdr.msg_iovlen = _iovecs.size() - _next;
+            return &_msghdr;
+        }
+
+        bool complete(int res, unsigned flags) override {
+            if (res < 0) {
+                _promise.setError(errnoToStatus(-res));
+                return false;
+            }
+
+            // A short send leaves the rest of the messages for another submission.
+            size_t sent = res;
+            while (_next < _iovecs.size() && sent >= _iovecs[_next].iov_len) {
+                sent -= _iovecs[_next].iov_len;
+                ++_next;
+            }
+            if (_next < _iovecs.size()) {
+                auto& iov = _iovecs[_next];
+                iov.iov_base = static_cast<char*>(iov.iov_base) + sent;
+                iov.iov_len -= sent;
+                _session->_submitSend(this);
+                return true;
+            }
+
+            networkCounter.hitPhysicalOut(_total);
+            _promise.emplaceValue();
+            return false;
+        }
+
+    private:
+        const std::shared_ptr<UringSession> _session;
+        const std::vector<Message> _messages;
+        Promise<void> _promise;
+        std::vector<iovec> _iovecs;
+        size_t _next = 0;
+        size_t _total = 0;
+        msghdr _msghdr;
+    };
+
+    std::shared_ptr<UringSession> _self() {
+        return std::static_pointer_cast<UringSession>(shared_from_this());
+    }
+
+    /**
+     * Returns the next complete message out of the received bytes, if there is one.
+     */
+    StatusWith<boost::optional<Message>> _takeMessage() {
+        if (_messages.empty()) {
+            return boost::optional<Message>();
+        }
+        auto message = std::move(_messages.front());
+        _messages.pop_front();
+        _bufferedBytes.fetch_sub(message.size(), std::memory_order_release);
+        networkCounter.hitPhysicalIn(message.size());
+        return boost::optional<Message>(std::move(message));
+    }
+
+    /**
+     * Copies received bytes straight into the buffers of the messages they belong to.
+     */
+    void _consume(const char* data, size_t len) {
+        _bufferedBytes.fetch_add(len, std::memory_order_release);
+        while (len > 0 && _recvStatus.isOK()) {
+            if (!_partial) {
+                const size_t headerBytes = std::min(len, kHeaderSize - _headerSize);
+                memcpy(_header + _headerSize, data, headerBytes);
+                _headerSize += headerBytes;
+                data += headerBytes;
+                len -= headerBytes;
+                if (_headerSize < kHeaderSize) {
+                    return;
+                }
+
+                const auto msgLen = size_t(MSGHEADER::ConstView(_header).getMessageLength());
+                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+                    StringBuilder sb;
+                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
+                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+                    const auto str = sb.str();
+                    LOG(0) << str;
+                    _setRecvStatus({ErrorCodes::ProtocolError, str});
+                    return;
+                }
+                _partial = SharedBuffer::allocatePooled(msgLen);
+                memcpy(_partial.get(), _header, kHeaderSize);
+                _partialSize = kHeaderSize;
+                _headerSize = 0;
+            }
+
+            const size_t msgLen = MSGHEADER::ConstView(_partial.get()).getMessageLength();
+            const size_t bodyBytes = std::min(len, msgLen - _partialSize);
+            memcpy(_partial.get() + _partialSize, data, bodyBytes);
+            _partialSize += bodyBytes;
+            data += bodyBytes;
+            len -= bodyBytes;
+            if (_partialSize == msgLen) {
+                _messages.emplace_back(std::move(_partial));
+                _partial = {};
+                _partialSize = 0;
+            }
+        }
+    }
+
+    void _setRecvStatus(Status status) {
+        _recvStatus = std::move(status);
+        _recvFailed.store(true);
+    }
+
+    void _armRecv() {
+        if (_recvOp) {
+            return;
+        }
+        auto sqe = _reactor->getSqe();
+        io_uring_prep_recv_multishot(sqe, _fd, nullptr, 0, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kRecvBufferGroup;
+        _recvOp = new RecvOp(_self());
+        _reactor->submit(_recvOp, sqe);
+    }
+
+    void _cancelRecv() {
+        if (_recvOp && !_recvCanceled) {
+            _recvCanceled = true;
+            _reactor->cancel(_recvOp);
+        }
+    }
+
+    void _onRecv(int res, unsigned flags) {
+        const bool more = flags & IORING_CQE_F_MORE;
+        if (res > 0) {
+            invariant(flags & IORING_CQE_F_BUFFER);
+            const unsigned bufferId = flags >> IORING_CQE_BUFFER_SHIFT;
+            _consume(_reactor->recvBuffer(bufferId), res);
+            _reactor->recycleRecvBuffer(bufferId);
+        } else if (res == 0) {
+            _setRecvStatus(kClosedStatus);
+        } else if (res != -ECANCELED && res != -ENOBUFS) {
+            // Running out of provided buffers ends the multishot recv, the next source arms it
+            // again.
+            _setRecvStatus(errnoToStatus(-res));
+        }
+
+        if (!more) {
+            _recvOp = nullptr;
+            _recvCanceled = false;
+        }
+
+        _fulfillSource();
+
+        if (_sourcePromise && !_recvOp && _recvStatus.isOK()) {
+            _armRecv();
+        } else if (!_sourcePromise &&
+                   _bufferedBytes.load(std::memory_order_relaxed) >= kMaxBufferedInput) {
+            _cancelRecv();
+        }
+    }
+
+    void _fulfillSource() {
+        if (!_sourcePromise) {
+            return;
+        }
+        auto swMessage = _takeMessage();
+        if (!swMessage.isOK()) {
+            _failSource(swMessage.getStatus());
+        } else if (swMessage.getValue()) {
+            auto promise = std::move(*_sourcePromise);
+            _sourcePromise.reset();
+            promise.emplaceValue(std::move(*swMessage.getValue()));
+        } else if (!_recvStatus.isOK()) {
+            _failSource(_recvStatus);
+        }
+    }
+
+    void _failSource(Status status) {
+        if (!_sourcePromise) {
+            return;
+        }
+        auto promise = std::move(*_sourcePromise);
+        _sourcePromise.reset();
+        promise.setError(std::move(status));
+    }
+
+    void _submitSend(SendOp* op) {
+        auto sqe = _reactor->getSqe();
+        io_uring_prep_sendmsg(sqe, _fd, op->msgHeader(), MSG_NOSIGNAL);
+        _reactor->submit(op, sqe);
+    }
+
+    Status _waitFor(short events) {
+        pollfd pfd{_fd, events, 0};
+        const int timeoutMs =
+            _timeout ? static_cast<int>(durationCount<Milliseconds>(*_timeout)) : -1;
+        int ret;
+        do {
+            ret = ::poll(&pfd, 1, timeoutMs);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0) {
+            return errnoToStatus(errno);
+        }
+        if (ret == 0) {
+            return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+        }
+        return Status::OK();
+    }
+
+    TransportLayerUring* const _tl;
+    const std::shared_ptr<UringReactor> _reactor;
+    const int _reactorId;
+    const int _fd;
+    HostAndPort _remote;
+    HostAndPort _local;
+
+    AtomicWord<bool> _ended{false};
+    boost::optional<Milliseconds> _timeout;
+
+    // Received messages which have not been sourced yet.
+    std::deque<Message> _messages;
+    // Message being received, once its header is, and how much of it was.
+    SharedBuffer _partial;
+    size_t _partialSize = 0;
+    // Header being received.
+    char _header[kHeaderSize];
+    size_t _headerSize = 0;
+    // Bytes received and not sourced yet. Read by other threads than the one receiving.
+    std::atomic<size_t> _bufferedBytes{0};
+
+    // Set once the remote host closed the connection or receiving failed. _recvFailed publishes
+    // it to other threads than the one receiving.
+    Status _recvStatus = Status::OK();
+    AtomicWord<bool> _recvFailed{false};
+    boost::optional<Promise<Message>> _sourcePromise;
+    // The armed multishot recv, until its last completion.
+    RecvOp* _recvOp = nullptr;
+    bool _recvCanceled = false;
+};
+
+TransportLayerUring::TransportLayerUring(const TransportLayerASIO::Options& opts,
+                                         ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {
+    // In run-to-completion mode every coroutine thread group polls one ingress reactor.
+    const size_t ingressReactorCnt = serverGlobalParams.runToCompletion
+        ? serverGlobalParams.reservedThreadNum
+        : serverGlobalParams.adaptiveThreadNum;
+    _ingressReactors.reserve(ingressReactorCnt);
+    for (size_t i = 0; i < ingressReactorCnt; ++i) {
+        _ingressReactors.emplace_back(std::make_shared<UringReactor>());
+    }
+}
+
+TransportLayerUring::~TransportLayerUring() {
+    for (auto& listener : _listeners) {
+        ::close(listener.fd);
+    }
+    if (_listenerWakeupFd >= 0) {
+        ::close(_listenerWakeupFd);
+    }
+}
+
+Status TransportLayerUring::checkSupported(const ServerGlobalParams* config) {
+    if (config->serviceExecutor != "adaptive") {
+        return {ErrorCodes::IllegalOperation,
+                "The io_uring transport layer requires the adaptive service executor"};
+    }
+#ifdef MONGO_CONFIG_SSL
+    if (getSSLGlobalParams().sslMode.load() != SSLParams::SSLMode_disabled) {
+        return {ErrorCodes::IllegalOperation, "The io_uring transport layer does not support TLS"};
+    }
+#endif
+    return probeKernel();
+}
+
+StatusWith<SessionHandle> TransportLayerUring::connect(HostAndPort peer,
+                                                       ConnectSSLMode sslMode,
+                                                       Milliseconds timeout) {
+    return {ErrorCodes::IllegalOperation,
+            "The io_uring transport layer does not make egress connections"};
+}
+
+Future<SessionHandle> TransportLayerUring::asyncConnect(HostAndPort peer,
+                                                        ConnectSSLMode sslMode,
+                                                        const ReactorHandle& reactor,
+                                                        Milliseconds timeout) {
+    return Future<SessionHandle>::makeReady(
+        Status(ErrorCodes::IllegalOperation,
+               "The io_uring transport layer does not make egress connections"));
+}
+
+Status TransportLayerUring::setup() {
+    for (auto& reactor : _ingressReactors) {
+        auto status = reactor->init();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    _listenerWakeupFd = ::eventfd(0, EFD_CLOEXEC);
+    if (_listenerWakeupFd < 0) {
+        return systemError(errno, "eventfd");
+    }
+
+    std::vector<std::string> listenAddrs;
+    if (_listenerOptions.ipList.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    } else {
+        listenAddrs = _listenerOptions.ipList;
+    }
+    if (_listenerOptions.useUnixSockets) {
+        listenAddrs.emplace_back(makeUnixSockPath(_listenerOptions.port));
+    }
+
+    _listenerPort = _listenerOptions.port;
+    const sa_family_t familyHint = _listenerOptions.enableIPv6 ? AF_UNSPEC : AF_INET;
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            warning() << "Skipping empty bind address";
+            continue;
+        }
+
+        auto addrs = SockAddr::createAll(ip, _listenerPort, familyHint);
+        if (addrs.empty()) {
+            warning() << "Found no addresses for " << ip;
+            continue;
+        }
+
+        for (auto& addr : addrs) {
+            const auto family = addr.getType();
+            if (family == AF_UNIX && ::unlink(addr.getAddr().c_str()) == -1 && errno != ENOENT) {
+                return systemError(errno,
+                                   str::stream() << "Unlinking socket file " << addr.getAddr());
+            }
+
+            int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return systemError(errno, "socket");
+            }
+            _listeners.push_back({addr, fd});
+
+            const int one = 1;
+            if (family != AF_UNIX &&
+                ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0) {
+                return systemError(errno, "setsockopt(SO_REUSEADDR)");
+            }
+            if (family == AF_INET6 &&
+                ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &one, sizeof(one)) != 0) {
+                return systemError(errno, "setsockopt(IPV6_V6ONLY)");
+            }
+            if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+                return systemError(errno, str::stream() << "bind to " << addr.toString());
+            }
+
+            if (family == AF_UNIX &&
+                ::chmod(addr.getAddr().c_str(), serverGlobalParams.unixSocketPermissions) == -1) {
+                return systemError(errno,
+                                   str::stream() << "chmod of socket file " << addr.getAddr());
+            }
+
+            if (_listenerOptions.port == 0 && addr.isIP()) {
+                if (_listenerPort != _listenerOptions.port) {
+                    return Status(ErrorCodes::BadValue,
+                                  "Port 0 (ephemeral port) is not allowed when"
+                                  " listening on multiple IP interfaces");
+                }
+                sockaddr_storage bound;
+                socklen_t len = sizeof(bound);
+                if (::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &len) != 0) {
+                    return systemError(errno, "getsockname");
+                }
+                _listenerPort = SockAddr(bound, len).getPort();
+            }
+        }
+    }
+
+    if (_listeners.empty()) {
+        return Status(ErrorCodes::SocketException, "No available addresses/ports to bind to");
+    }
+
+    return Status::OK();
+}
+
+Status TransportLayerUring::start() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _running.store(true);
+
+    for (auto& listener : _listeners) {
+        if (::listen(listener.fd, serverGlobalParams.listenBacklog) != 0) {
+            return systemError(errno, str::stream() << "listen on " << listener.addr.toString());
+        }
+    }
+
+    _listenerThread = stdx::thread([this] {
+        setThreadName("listener");
+        _acceptLoop();
+    });
+
+    log() << "waiting for connections on port " << _listenerPort << " (io_uring)";
+    return Status::OK();
+}
+
+void TransportLayerUring::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _running.store(false);
+
+    if (_listenerThread.joinable()) {
+        const uint64_t one = 1;
+        if (::write(_listenerWakeupFd, &one, sizeof(one)) < 0) {
+            warning() << "Failed to wake up the listener thread: " << errnoWithDescription();
+        }
+        _listenerThread.join();
+    }
+
+    // Closing the listening sockets prevents new connections from being opened.
+    for (auto& listener : _listeners) {
+        ::close(listener.fd);
+        auto& addr = listener.addr;
+        if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
+            auto path = addr.getAddr();
+            log() << "removing socket file: " << path;
+            if (::unlink(path.c_str()) != 0) {
+                const auto ewd = errnoWithDescription();
+                warning() << "Unable to remove UNIX socket " << path << ": " << ewd;
+            }
+        }
+    }
+    _listeners.clear();
+}
+
+ReactorHandle TransportLayerUring::getReactor(WhichReactor which) {
+    switch (which) {
+        case TransportLayer::kIngress:
+        case TransportLayer::kEgress:
+            MONGO_UNREACHABLE;
+        case TransportLayer::kNewReactor: {
+            auto reactor = std::make_shared<UringReactor>();
+            uassertStatusOK(reactor->init());
+            return reactor;
+        }
+    }
+
+    MONGO_UNREACHABLE;
+}
+
+std::vector<ReactorHandle> TransportLayerUring::getIngressReactors() {
+    std::vector<ReactorHandle> reactorHandles;
+    reactorHandles.reserve(_ingressReactors.size());
+    for (auto& uringReactor : _ingressReactors) {
+        reactorHandles.emplace_back(std::static_pointer_cast<Reactor>(uringReactor));
+    }
+    return reactorHandles;
+}
+
+void TransportLayerUring::_acceptLoop() {
+    std::vector<pollfd> fds;
+    for (auto& listener : _listeners) {
+        fds.push_back({listener.fd, POLLIN, 0});
+    }
+    fds.push_back({_listenerWakeupFd, POLLIN, 0});
+
+    while (_running.load()) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno != EINTR) {
+                error() << "Failed to poll the listening sockets: " << errnoWithDescription();
+            }
+            continue;
+        }
+        for (size_t i = 0; i < _listeners.size() && _running.load(); ++i) {
+            if (fds[i].revents) {
+                _acceptConnections(_listeners[i]);
+            }
+        }
+    }
+}
+
+void TransportLayerUring::_acceptConnections(const Listener& listener) {
+    // Takes every connection waiting in the backlog before polling again.
+    while (_running.load()) {
+        sockaddr_storage remote;
+        socklen_t len = sizeof(remote);
+        int fd = ::accept4(listener.fd,
+                           reinterpret_cast<sockaddr*>(&remote),
+                           &len,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            const int err = errno;
+            if (err == EINTR || err == ECONNABORTED) {
+                continue;
+            }
+            if (err != EAGAIN && err != EWOULDBLOCK) {
+                log() << "Error accepting new connection on " << listener.addr.toString() << ": "
+                      << errnoWithDescription(err);
+            }
+            return;
+        }
+
+        if (listener.addr.getType() != AF_UNIX) {
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+            setSocketKeepAliveParams(fd);
+        }
+
+        const size_t reactorId = ++_acceptedCount % _ingressReactors.size();
+        std::shared_ptr<UringSession> session;
+        try {
+            session = std::make_shared<UringSession>(this,
+                                                     _ingressReactors[reactorId],
+                                                     static_cast<int>(reactorId),
+                                                     fd,
+                                                     SockAddr(remote, len));
+        } catch (const DBException& e) {
+            ::close(fd);
+            warning() << "Error accepting new connection " << e;
+            continue;
+        }
+
+        try {
+            _sep->startSession(std::move(session));
+        } catch (const DBException& e) {
+            warning() << "Error accepting new connection " << e;
+        }
+    }
+}
+
+}  // namespace transport
+}  // namespace mongo
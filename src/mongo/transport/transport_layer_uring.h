@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/net/sockaddr.h"
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+/**
+ * An ingress-only TransportLayer which runs accepted sessions on io_uring.
+ *
+ * Every ingress reactor owns a ring. Sessions receive with a multishot recv drawing from a ring
+ * of buffers registered with the kernel, so an idle connection holds no receive buffer and a busy
+ * one needs no new submission per message. Operations prepared while handlers and coroutines run
+ * are submitted together the next time the reactor is polled, which makes one io_uring_enter per
+ * iteration of the coroutine ThreadGroup loop.
+ *
+ * TLS is not supported, and egress connections must go through another transport layer.
+ */
+class TransportLayerUring final : public TransportLayer {
+    MONGO_DISALLOW_COPYING(TransportLayerUring);
+
+public:
+    TransportLayerUring(const TransportLayerASIO::Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerUring();
+
+    /**
+     * Returns OK if this build, the configuration and the running kernel support everything the
+     * io_uring transport layer needs.
+     */
+    static Status checkSupported(const ServerGlobalParams* config);
+
+    StatusWith<SessionHandle> connect(HostAndPort peer,
+                                      ConnectSSLMode sslMode,
+                                      Milliseconds timeout) final;
+
+    Future<SessionHandle> asyncConnect(HostAndPort peer,
+                                       ConnectSSLMode sslMode,
+                                       const ReactorHandle& reactor,
+                                       Milliseconds timeout) final;
+
+    Status setup() final;
+
+    ReactorHandle getReactor(WhichReactor which) final;
+    std::vector<ReactorHandle> getIngressReactors();
+
+    Status start() final;
+
+    void shutdown() final;
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class UringReactor;
+    class UringTimer;
+    class UringSession;
+
+    struct Listener {
+        SockAddr addr;
+        int fd;
+    };
+
+    void _acceptLoop();
+    void _acceptConnections(const Listener& listener);
+
+    stdx::mutex _mutex;
+
+    std::vector<std::shared_ptr<UringReactor>> _ingressReactors;
+    size_t _acceptedCount{0};
+
+    std::vector<Listener> _listeners;
+    // Wakes the listener thread up on shutdown.
+    int _listenerWakeupFd = -1;
+    stdx::thread _listenerThread;
+
+    ServiceEntryPoint* const _sep = nullptr;
+    AtomicWord<bool> _running{false};
+    TransportLayerASIO::Options _listenerOptions;
+    // The real incoming port in case of _listenerOptions.port==0 (ephemeral).
+    int _listenerPort = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
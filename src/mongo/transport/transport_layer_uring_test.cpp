@@ -0,0 +1,346 @@
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_uring.h"
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/transport_layer_manager.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/map_util.h"
+
+#include "asio.hpp"
+
+namespace mongo {
+namespace {
+
+class ServiceEntryPointUtil : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _sessions.push_back(std::move(session));
+        _cv.notify_one();
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        std::vector<transport::SessionHandle> oldSessions;
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            oldSessions.swap(_sessions);
+        }
+        // Ending a session completes its pending receive, which releases it on the reactor.
+        for (auto& session : oldSessions) {
+            session->end();
+        }
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    transport::SessionHandle waitForSession() {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        _cv.wait(lock, [&] { return !_sessions.empty(); });
+        return _sessions.back();
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::vector<transport::SessionHandle> _sessions;
+};
+
+/**
+ * Runs the ingress reactor of the transport layer, which a coroutine thread group or the adaptive
+ * executor would otherwise run.
+ */
+class ReactorThread {
+public:
+    explicit ReactorThread(transport::ReactorHandle reactor) : _reactor(std::move(reactor)) {
+        _thread = stdx::thread([this] { _reactor->run(); });
+    }
+
+    ~ReactorThread() {
+        _reactor->stop();
+        _thread.join();
+        // Reaps the completions of the sessions ended last.
+        _reactor->drain();
+    }
+
+private:
+    transport::ReactorHandle _reactor;
+    stdx::thread _thread;
+};
+
+/**
+ * Sets a server parameter for the lifetime of this object.
+ */
+class ServerParameterGuard {
+public:
+    ServerParameterGuard(StringData name, StringData value)
+        : _parameter(mapFindWithDefault(ServerParameterSet::getGlobal()->getMap(),
+                                        name.toString(),
+                                        static_cast<ServerParameter*>(nullptr))) {
+        invariant(_parameter);
+        BSONObjBuilder bob;
+        _parameter->append(nullptr, bob, "value");
+        _oldValue = bob.obj();
+        ASSERT_OK(_parameter->setFromString(value.toString()));
+    }
+
+    ~ServerParameterGuard() {
+        ASSERT_OK(_parameter->set(_oldValue["value"]));
+    }
+
+private:
+    ServerParameter* const _parameter;
+    BSONObj _oldValue;
+};
+
+class Connection {
+public:
+    explicit Connection(int port)
+        : _ctx(), _sock(_ctx), _endpoint(asio::ip::address_v4::loopback(), port) {
+        std::error_code ec;
+        _sock.connect(_endpoint, ec);
+        ASSERT_EQ(ec, std::error_code());
+    }
+
+    void send(const std::vector<Message>& messages) {
+        std::vector<asio::const_buffer> buffers;
+        for (auto& msg : messages) {
+            buffers.push_back(asio::buffer(msg.buf(), msg.size()));
+        }
+        std::error_code ec;
+        asio::write(_sock, buffers, ec);
+        ASSERT_FALSE(ec);
+    }
+
+    Message receive() {
+        MSGHEADER::Value header;
+        std::error_code ec;
+        asio::read(_sock, asio::buffer(header.view().view2ptr(), sizeof(header)), ec);
+        ASSERT_FALSE(ec);
+
+        const auto msgLen = size_t(header.constView().getMessageLength());
+        auto buffer = SharedBuffer::allocate(msgLen);
+        memcpy(buffer.get(), header.view().view2ptr(), sizeof(header));
+        asio::read(_sock, asio::buffer(buffer.get() + sizeof(header), msgLen - sizeof(header)), ec);
+        ASSERT_FALSE(ec);
+        return Message(std::move(buffer));
+    }
+
+private:
+    asio::io_context _ctx;
+    asio::ip::tcp::socket _sock;
+    asio::ip::tcp::endpoint _endpoint;
+};
+
+Message makeMessage(const BSONObj& body, int32_t id) {
+    OpMsgBuilder builder;
+    builder.setBody(body);
+    Message msg = builder.finish();
+    msg.header().setId(id);
+    msg.header().setResponseToMsgId(0);
+    return msg;
+}
+
+ServerGlobalParams makeParams() {
+    ServerGlobalParams params;
+    params.noUnixSocket = true;
+    params.serviceExecutor = "adaptive";
+    return params;
+}
+
+/**
+ * Returns a started io_uring transport layer listening on an ephemeral port, or nullptr if the
+ * running kernel does not support it.
+ */
+std::unique_ptr<transport::TransportLayerUring> makeAndStartTL(ServiceEntryPoint* sep) {
+    auto params = makeParams();
+    auto status = transport::TransportLayerUring::checkSupported(&params);
+    if (!status.isOK()) {
+        log() << "Skipping test, io_uring is unavailable: " << status;
+        return nullptr;
+    }
+
+    transport::TransportLayerASIO::Options opts(&params);
+    opts.port = 0;
+    opts.transportMode = transport::Mode::kAsynchronous;
+
+    auto tl = stdx::make_unique<transport::TransportLayerUring>(opts, sep);
+    ASSERT_OK(tl->setup());
+    ASSERT_OK(tl->start());
+    ASSERT_GT(tl->listenerPort(), 0);
+    return tl;
+}
+
+TEST(TransportLayerUring, SourceAndSink) {
+    ServiceEntryPointUtil sep;
+    auto tl = makeAndStartTL(&sep);
+    if (!tl) {
+        return;
+    }
+    auto reactors = tl->getIngressReactors();
+    ReactorThread reactorThread(reactors.front());
+
+    Connection conn(tl->listenerPort());
+    auto session = sep.waitForSession();
+
+    conn.send({makeMessage(BSON("ping" << 1), 1)});
+    auto request = session->asyncSourceMessage().get();
+    ASSERT_EQ(request.header().getId(), 1);
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(request).body, BSON("ping" << 1));
+
+    session->asyncSinkMessage(makeMessage(BSON("ok" << 1), 2)).get();
+    auto response = conn.receive();
+    ASSERT_EQ(response.header().getId(), 2);
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(response).body, BSON("ok" << 1));
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+// Requests written together are received with one recv and sourced one at a time, and responses
+// sunk together reach the client in order.
+TEST(TransportLayerUring, PipelinedMessages) {
+    ServiceEntryPointUtil sep;
+    auto tl = makeAndStartTL(&sep);
+    if (!tl) {
+        return;
+    }
+    auto reactors = tl->getIngressReactors();
+    ReactorThread reactorThread(reactors.front());
+
+    Connection conn(tl->listenerPort());
+    auto session = sep.waitForSession();
+
+    const int kMessages = 8;
+    std::vector<Message> requests;
+    for (int i = 0; i < kMessages; ++i) {
+        requests.push_back(makeMessage(BSON("ping" << i), i));
+    }
+    conn.send(requests);
+
+    std::vector<Message> responses;
+    for (int i = 0; i < kMessages; ++i) {
+        auto request = session->asyncSourceMessage().get();
+        ASSERT_EQ(request.header().getId(), i);
+        ASSERT_BSONOBJ_EQ(OpMsg::parse(request).body, BSON("ping" << i));
+        responses.push_back(makeMessage(BSON("ok" << i), kMessages + i));
+    }
+    ASSERT_FALSE(session->hasBufferedInput());
+
+    session->asyncSinkMessages(std::move(responses)).get();
+    for (int i = 0; i < kMessages; ++i) {
+        auto response = conn.receive();
+        ASSERT_EQ(response.header().getId(), kMessages + i);
+        ASSERT_BSONOBJ_EQ(OpMsg::parse(response).body, BSON("ok" << i));
+    }
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+// A message larger than all the provided receive buffers together ends the multishot recv with
+// ENOBUFS, and the session arms it again until the message is complete.
+TEST(TransportLayerUring, ProvidedBuffersExhausted) {
+    ServerParameterGuard bufferCount("ioUringRecvBufferCount", "2");
+    ServerParameterGuard bufferKB("ioUringRecvBufferKB", "1");
+
+    ServiceEntryPointUtil sep;
+    auto tl = makeAndStartTL(&sep);
+    if (!tl) {
+        return;
+    }
+    auto reactors = tl->getIngressReactors();
+    ReactorThread reactorThread(reactors.front());
+
+    Connection conn(tl->listenerPort());
+    auto session = sep.waitForSession();
+
+    const std::string payload(256 * 1024, 'x');
+    conn.send({makeMessage(BSON("payload" << payload), 1), makeMessage(BSON("ping" << 1), 2)});
+
+    auto request = session->asyncSourceMessage().get();
+    ASSERT_EQ(request.header().getId(), 1);
+    ASSERT_EQ(OpMsg::parse(request).body["payload"].str(), payload);
+
+    request = session->asyncSourceMessage().get();
+    ASSERT_EQ(request.header().getId(), 2);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, ClosedConnectionFailsSource) {
+    ServiceEntryPointUtil sep;
+    auto tl = makeAndStartTL(&sep);
+    if (!tl) {
+        return;
+    }
+    auto reactors = tl->getIngressReactors();
+    ReactorThread reactorThread(reactors.front());
+
+    auto session = [&] {
+        Connection conn(tl->listenerPort());
+        return sep.waitForSession();
+    }();
+
+    auto swRequest = session->asyncSourceMessage().getNoThrow();
+    ASSERT_EQ(swRequest.getStatus(), ErrorCodes::HostUnreachable);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, UnsupportedConfigurationIsRejected) {
+    auto params = makeParams();
+    params.serviceExecutor = "synchronous";
+    ASSERT_EQ(transport::TransportLayerUring::checkSupported(&params),
+              ErrorCodes::IllegalOperation);
+}
+
+// When io_uring can't be used, the server runs on the asio transport layer instead.
+TEST(TransportLayerUring, FallsBackToASIO) {
+    setGlobalServiceContext(ServiceContext::make());
+    auto serviceContext = getGlobalServiceContext();
+
+    auto params = makeParams();
+    params.transportLayer = "uring";
+    params.serviceExecutor = "synchronous";
+    params.port = 0;
+
+    auto tl = transport::TransportLayerManager::createWithConfig(&params, serviceContext);
+    ASSERT(tl);
+    ASSERT(dynamic_cast<transport::ServiceExecutorSynchronous*>(
+        serviceContext->getServiceExecutor()));
+    ASSERT_OK(tl->setup());
+    ASSERT_OK(tl->start());
+    tl->shutdown();
+}
+
+}  // namespace
+}  // namespace mongo
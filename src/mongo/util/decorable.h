@@ -127,11 +127,28 @@ public:
         typename DecorationContainer<D>::template DecorationDescriptorWithType<T> _raw;
     };
 
+    /**
+     * Declares a decoration of type T. Must be called before the first D is created, usually by
+     * the initializer of a namespace scope variable.
+     *
+     * If DecorationTraits<D>::kLazy, the decoration is only constructed when first accessed, which
+     * may be by another thread than the one which created the D, or never. Decorations whose
+     * constructor has side effects beyond the decoration itself must then be declared with
+     * declareEagerDecoration().
+     */
     template <typename T>
     static Decoration<T> declareDecoration() {
         return Decoration<T>(getRegistry()->template declareDecoration<T>());
     }
 
+    /**
+     * Declares a decoration of type T which is always constructed with the D.
+     */
+    template <typename T>
+    static Decoration<T> declareEagerDecoration() {
+        return Decoration<T>(getRegistry()->template declareEagerDecoration<T>());
+    }
+
     /*
      * Called by Decorable class manually.
      */
@@ -28,8 +28,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <type_traits>
+
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
@@ -39,6 +43,26 @@ class DecorationRegistry;
 template <typename DecoratedType>
 class Decorable;
 
+/**
+ * How the decorations of a decorated type are managed. A decorated type may specialize this next
+ * to its declaration to opt into the non-default behaviors.
+ */
+template <typename DecoratedType>
+struct DecorationTraits {
+    /**
+     * Whether decorations are constructed on first access instead of with the decorated object.
+     * Decorations declared with declareEagerDecoration() are always constructed with the object.
+     */
+    static constexpr bool kLazy = false;
+
+    /**
+     * Whether Decorable::resetAllDecorations() resets the decorations for the reuse of a pooled
+     * object. Decorations then need a reset() member function, unless they are fundamental types,
+     * which are reset to their default value.
+     */
+    static constexpr bool kResettable = false;
+};
+
 /**
  * An container for decorations.
  */
@@ -61,9 +85,15 @@ public:
         friend DecorationRegistry<DecoratedType>;
         friend Decorable<DecoratedType>;
 
-        explicit DecorationDescriptor(size_t index) : _index(index) {}
+        DecorationDescriptor(size_t index, size_t ordinal, bool lazy)
+            : _index(index), _ordinal(ordinal), _lazy(lazy) {}
 
+        // Byte offset of the decoration in the container's storage.
         size_t _index;
+        // Position of the decoration in the registry's declaration order.
+        size_t _ordinal;
+        // Constructed on first access, see DecorationTraits::kLazy.
+        bool _lazy;
     };
 
     /**
@@ -96,7 +126,8 @@ public:
     explicit DecorationContainer(Decorable<DecoratedType>* const decorated,
                                  const DecorationRegistry<DecoratedType>* const registry)
         : _registry(registry),
-          _decorationData(new unsigned char[registry->getDecorationBufferSizeBytes()]) {
+          _decorationData(new unsigned char[registry->getDecorationBufferSizeBytes()]),
+          _states(kLazy ? new std::atomic<uint8_t>[registry->getDecorationCount()]() : nullptr) {
         // Because the decorations live in the externally allocated storage buffer at
         // `_decorationData`, there needs to be a way to get back from a known location within this
         // buffer to the type which owns those decorations.  We place a pointer to ourselves, a
@@ -133,6 +164,9 @@ public:
      */
     template <typename T>
     T& getDecoration(DecorationDescriptorWithType<T> descriptor) {
+        if (kLazy && descriptor._raw._lazy) {
+            _touch(descriptor._raw);
+        }
         return *static_cast<T*>(getDecoration(descriptor._raw));
     }
 
@@ -141,12 +175,68 @@ public:
      */
     template <typename T>
     const T& getDecoration(DecorationDescriptorWithType<T> descriptor) const {
+        if (kLazy && descriptor._raw._lazy) {
+            const_cast<DecorationContainer*>(this)->_touch(descriptor._raw);
+        }
         return *static_cast<const T*>(getDecoration(descriptor._raw));
     }
 
+    /**
+     * Lazy decorations are constructed on first access, and only the ones used since the previous
+     * reset are reset when a pooled object is reused.
+     */
+    static constexpr bool kLazy = DecorationTraits<DecoratedType>::kLazy;
+
+    enum DecorationState : uint8_t {
+        kUnconstructed = 0,
+        kConstructing,
+        // Constructed and untouched since it was constructed or last reset.
+        kClean,
+        // Accessed since it was constructed or last reset.
+        kDirty,
+    };
+
+    /**
+     * State of a lazily constructed decoration. Only valid if kLazy, for lazy descriptors.
+     */
+    std::atomic<uint8_t>& state(DecorationDescriptor descriptor) {
+        return _states[descriptor._ordinal];
+    }
+
 private:
+    void _touch(DecorationDescriptor descriptor) {
+        auto& decorationState = state(descriptor);
+        uint8_t current = decorationState.load(std::memory_order_acquire);
+        if (current == kDirty) {
+            return;
+        }
+        if (current == kClean) {
+            decorationState.store(kDirty, std::memory_order_relaxed);
+            return;
+        }
+
+        // Other threads may inspect an operation, e.g. for currentOp, so construction races with
+        // them are resolved here.
+        if (current == kUnconstructed &&
+            decorationState.compare_exchange_strong(current, kConstructing)) {
+            try {
+                _registry->constructOne(descriptor, getDecoration(descriptor));
+            } catch (...) {
+                decorationState.store(kUnconstructed, std::memory_order_release);
+                throw;
+            }
+            decorationState.store(kDirty, std::memory_order_release);
+            return;
+        }
+        while (decorationState.load(std::memory_order_acquire) < kClean) {
+            stdx::this_thread::yield();
+        }
+        decorationState.store(kDirty, std::memory_order_relaxed);
+    }
+
     const DecorationRegistry<DecoratedType>* const _registry;
     const std::unique_ptr<unsigned char[]> _decorationData;
+    const std::unique_ptr<std::atomic<uint8_t>[]> _states;
 };
 
 }  // namespace mongo
@@ -42,7 +42,6 @@
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
-class OperationContext;
 
 /**
  * Registry of decorations.
@@ -63,25 +62,45 @@ public:
      * Declares a decoration of type T, constructed with T's default constructor, and
      * returns a descriptor for accessing that decoration.
      *
+     * If DecorationTraits<DecoratedType>::kLazy, the decoration is constructed on first access,
+     * possibly by another thread than the one which created the decorated object, or never.
+     * Decorations whose constructor has side effects outside of the decoration, or must run
+     * when the decorated object is created, must use declareEagerDecoration() instead.
+     *
      * NOTE: T's destructor must not throw exceptions.
      */
     template <typename T>
     auto declareDecoration() {
-        MONGO_STATIC_ASSERT_MSG(std::is_nothrow_destructible<T>::value,
-                                "Decorations must be nothrow destructible");
-        return
-            typename DecorationContainer<DecoratedType>::template DecorationDescriptorWithType<T>(
-                std::move(declareDecoration(sizeof(T),
-                                            std::alignment_of<T>::value,
-                                            &constructAt<T>,
-                                            &destroyAt<T>,
-                                            &resetAt<T>)));
+        return declareDecoration<T>(DecorationContainer<DecoratedType>::kLazy);
+    }
+
+    /**
+     * Same as declareDecoration(), but the decoration is always constructed with the decorated
+     * object.
+     */
+    template <typename T>
+    auto declareEagerDecoration() {
+        return declareDecoration<T>(false);
     }
 
     size_t getDecorationBufferSizeBytes() const {
         return _totalSizeBytes;
     }
 
+    size_t getDecorationCount() const {
+        return _decorationInfo.size();
+    }
+
+    /**
+     * Constructs a single lazily constructed decoration at 'location'.
+     *
+     * Called by the DecorationContainer on first access. Do not call directly.
+     */
+    void constructOne(typename DecorationContainer<DecoratedType>::DecorationDescriptor descriptor,
+                      void* location) const {
+        _decorationInfo[descriptor._ordinal].constructor(location);
+    }
+
     /**
      * Constructs the decorations declared in this registry on the given instance of
      * "decorable".
@@ -98,8 +117,10 @@ public:
             std::for_each(std::make_reverse_iterator(iter),
                           crend(this->_decorationInfo),
                           [&](auto&& decoration) {
-                              decoration.destructor(
-                                  container->getDecoration(decoration.descriptor));
+                              if (!decoration.descriptor._lazy) {
+                                  decoration.destructor(
+                                      container->getDecoration(decoration.descriptor));
+                              }
                           });
         };
 
@@ -108,7 +129,9 @@ public:
         using std::cend;
 
         for (; iter != cend(_decorationInfo); ++iter) {
-            iter->constructor(container->getDecoration(iter->descriptor));
+            if (!iter->descriptor._lazy) {
+                iter->constructor(container->getDecoration(iter->descriptor));
+            }
         }
 
         cleanup.Dismiss();
@@ -121,6 +144,11 @@ public:
      */
     void destroy(DecorationContainer<DecoratedType>* const container) const noexcept try {
         for (auto& decoration : _decorationInfo) {
+            if (decoration.descriptor._lazy &&
+                container->state(decoration.descriptor).load(std::memory_order_acquire) <
+                    DecorationContainer<DecoratedType>::kClean) {
+                continue;
+            }
             decoration.destructor(container->getDecoration(decoration.descriptor));
         }
     } catch (...) {
@@ -134,6 +162,15 @@ public:
      */
     void resetAll(DecorationContainer<DecoratedType>* const container) {
         for (auto& decoration : _decorationInfo) {
+            if (decoration.descriptor._lazy) {
+                // Decorations nobody touched are still in their initial state.
+                auto& state = container->state(decoration.descriptor);
+                if (state.load(std::memory_order_relaxed) !=
+                    DecorationContainer<DecoratedType>::kDirty) {
+                    continue;
+                }
+                state.store(DecorationContainer<DecoratedType>::kClean, std::memory_order_relaxed);
+            }
             decoration.resetor(container->getDecoration(decoration.descriptor));
         }
     }
@@ -186,8 +223,7 @@ private:
 
     template <typename T>
     static void resetAt(void* location) {
-        // reset decorations only apply on class OperationContext
-        if constexpr (!std::is_same_v<DecoratedType, OperationContext>) {
+        if constexpr (!DecorationTraits<DecoratedType>::kResettable) {
             return;
         } else {
             T* ptr = static_cast<T*>(location);
@@ -203,6 +239,20 @@ private:
         }
     }
 
+    template <typename T>
+    auto declareDecoration(bool lazy) {
+        MONGO_STATIC_ASSERT_MSG(std::is_nothrow_destructible<T>::value,
+                                "Decorations must be nothrow destructible");
+        return
+            typename DecorationContainer<DecoratedType>::template DecorationDescriptorWithType<T>(
+                std::move(declareDecoration(sizeof(T),
+                                            std::alignment_of<T>::value,
+                                            lazy,
+                                            &constructAt<T>,
+                                            &destroyAt<T>,
+                                            &resetAt<T>)));
+    }
+
     /**
      * Declares a decoration with given "constructor" and "destructor" functions,
      * of "sizeBytes" bytes.
@@ -212,6 +262,7 @@ private:
     typename DecorationContainer<DecoratedType>::DecorationDescriptor declareDecoration(
         const size_t sizeBytes,
         const size_t alignBytes,
+        const bool lazy,
         const DecorationConstructorFn constructor,
         const DecorationDestructorFn destructor,
         const DecorationResetorFn resetor) {
@@ -219,7 +270,8 @@ private:
         if (misalignment) {
             _totalSizeBytes += alignBytes - misalignment;
         }
-        typename DecorationContainer<DecoratedType>::DecorationDescriptor result(_totalSizeBytes);
+        typename DecorationContainer<DecoratedType>::DecorationDescriptor result(
+            _totalSizeBytes, _decorationInfo.size(), lazy);
         _decorationInfo.push_back(DecorationInfo(result, constructor, destructor, resetor));
         _totalSizeBytes += sizeBytes;
         return result;
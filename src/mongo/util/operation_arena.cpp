@@ -0,0 +1,164 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/operation_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+thread_local OperationArena* currentArena = nullptr;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Every OperationArenaAllocated object is preceded by a header recording where it came from.
+struct alignas(std::max_align_t) AllocationHeader {
+    OperationArena* arena;
+};
+
+}  // namespace
+
+OperationArena::~OperationArena() {
+    while (_blocks) {
+        Block* next = _blocks->next;
+        std::free(_blocks);
+        _blocks = next;
+    }
+}
+
+void* OperationArena::allocate(size_t size, size_t alignment) {
+    dassert(alignment && (alignment & (alignment - 1)) == 0);
+
+    char* start = reinterpret_cast<char*>(
+        alignUp(reinterpret_cast<uintptr_t>(_cursor), alignment));
+    if (!_cursor || start + size > _end) {
+        _addBlock(size + alignment);
+        start = reinterpret_cast<char*>(alignUp(reinterpret_cast<uintptr_t>(_cursor), alignment));
+    }
+
+    _cursor = start + size;
+    _bytesAllocated += size;
+    return start;
+}
+
+void OperationArena::reset() {
+    _bytesAllocated = 0;
+    if (!_blocks) {
+        return;
+    }
+
+    while (_blocks->next) {
+        Block* next = _blocks->next;
+        std::free(_blocks);
+        _blocks = next;
+    }
+
+    // Only keep the first block if it has the regular size. An operation that started with a
+    // huge allocation should not pin that memory in the OperationContext pool.
+    if (_blocks->size > kInitialBlockSize) {
+        std::free(_blocks);
+        _blocks = nullptr;
+        _cursor = nullptr;
+        _end = nullptr;
+        return;
+    }
+    _cursor = reinterpret_cast<char*>(_blocks + 1);
+    _end = _cursor + _blocks->size;
+}
+
+size_t OperationArena::blockCount() const {
+    size_t count = 0;
+    for (Block* block = _blocks; block; block = block->next) {
+        ++count;
+    }
+    return count;
+}
+
+void OperationArena::_addBlock(size_t minSize) {
+    // Each block doubles the previous one, so that large operations need few blocks.
+    size_t size = _blocks ? std::min(_blocks->size * 2, kMaxBlockSize) : kInitialBlockSize;
+    // Allocations larger than a regular block get a block of their own.
+    size = std::max(size, minSize);
+
+    Block* block = static_cast<Block*>(mongoMalloc(sizeof(Block) + size));
+    block->next = _blocks;
+    block->size = size;
+    _blocks = block;
+    _cursor = reinterpret_cast<char*>(block + 1);
+    _end = _cursor + size;
+}
+
+OperationArena::Scope::Scope(OperationArena* arena) : _previous(currentArena) {
+    currentArena = arena && arena->bytesAllocated() < kMaxScopedBytes ? arena : nullptr;
+}
+
+OperationArena::Scope::~Scope() {
+    currentArena = _previous;
+}
+
+OperationArena* OperationArena::current() {
+    return currentArena;
+}
+
+OperationArena* OperationArena::releaseCurrent() {
+    OperationArena* arena = currentArena;
+    currentArena = nullptr;
+    return arena;
+}
+
+void OperationArena::setCurrent(OperationArena* arena) {
+    currentArena = arena;
+}
+
+void* OperationArenaAllocated::operator new(size_t size) {
+    OperationArena* arena = currentArena;
+    void* raw = arena ? arena->allocate(sizeof(AllocationHeader) + size, alignof(AllocationHeader))
+                      : mongoMalloc(sizeof(AllocationHeader) + size);
+    auto header = new (raw) AllocationHeader{arena};
+    return header + 1;
+}
+
+void OperationArenaAllocated::operator delete(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto header = static_cast<AllocationHeader*>(ptr) - 1;
+    if (!header->arena) {
+        std::free(header);
+    }
+}
+
+}  // namespace mongo
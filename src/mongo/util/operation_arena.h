@@ -0,0 +1,178 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+/**
+ * A bump allocator for objects which live no longer than the operation that created them.
+ *
+ * Memory is handed out from a chain of blocks and never freed individually. reset() releases
+ * everything at once, keeping the first block so that a recycled OperationContext serves its
+ * next operation without touching malloc.
+ *
+ * Not thread safe. An arena is only used by the thread currently running its operation.
+ */
+class OperationArena {
+    MONGO_DISALLOW_COPYING(OperationArena);
+
+public:
+    static constexpr size_t kInitialBlockSize = 8 * 1024;
+    static constexpr size_t kMaxBlockSize = 256 * 1024;
+
+    // Scopes stop placing objects in an arena holding this many bytes, so that operations which
+    // parse many statements do not grow their arena without bound.
+    static constexpr size_t kMaxScopedBytes = 1024 * 1024;
+
+    OperationArena() = default;
+    ~OperationArena();
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Releases every allocation made since the previous reset. Objects living in the arena must
+     * have been destroyed already.
+     */
+    void reset();
+
+    /**
+     * Bytes handed out since the previous reset.
+     */
+    size_t bytesAllocated() const {
+        return _bytesAllocated;
+    }
+
+    /**
+     * Number of blocks currently held, including the retained first block.
+     */
+    size_t blockCount() const;
+
+    /**
+     * Makes 'arena' the arena which OperationArenaAllocated objects created on this thread are
+     * placed in, for the lifetime of the scope. Scopes nest. If 'arena' already holds
+     * kMaxScopedBytes, objects created in the scope come from the heap instead.
+     *
+     * A coroutine suspended inside a scope must take the current arena with it, see
+     * releaseCurrent() and setCurrent().
+     */
+    class Scope {
+        MONGO_DISALLOW_COPYING(Scope);
+
+    public:
+        explicit Scope(OperationArena* arena);
+        ~Scope();
+
+    private:
+        OperationArena* const _previous;
+    };
+
+    static OperationArena* current();
+
+    static OperationArena* releaseCurrent();
+    static void setCurrent(OperationArena* arena);
+
+    /**
+     * Allocator for containers whose lifetime is bounded by the operation. Deallocation is a
+     * no-op, memory is reclaimed when the arena is reset.
+     */
+    template <typename T>
+    class Allocator {
+    public:
+        using value_type = T;
+
+        explicit Allocator(OperationArena* arena) : _arena(arena) {}
+
+        template <typename U>
+        Allocator(const Allocator<U>& other) : _arena(other.arena()) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, size_t) {}
+
+        OperationArena* arena() const {
+            return _arena;
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const {
+            return _arena == other.arena();
+        }
+
+        template <typename U>
+        bool operator!=(const Allocator<U>& other) const {
+            return _arena != other.arena();
+        }
+
+    private:
+        OperationArena* _arena;
+    };
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    void _addBlock(size_t minSize);
+
+    // Most recently added block first, the retained first block is at the tail.
+    Block* _blocks{nullptr};
+    char* _cursor{nullptr};
+    char* _end{nullptr};
+    size_t _bytesAllocated{0};
+};
+
+/**
+ * Base class for types which opt into operation arena allocation.
+ *
+ * Objects created with new while an OperationArena::Scope is active on the thread are placed in
+ * that arena; other objects come from the heap as usual. Deleting an arena object only runs its
+ * destructor. Only use a scope where every object created in it is destroyed before the
+ * operation ends.
+ */
+class OperationArenaAllocated {
+public:
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
+    // Keep placement new usable for derived types.
+    static void* operator new(size_t, void* where) {
+        return where;
+    }
+    static void operator delete(void*, void*) {}
+};
+
+}  // namespace mongo
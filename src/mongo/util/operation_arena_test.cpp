@@ -0,0 +1,139 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/operation_arena.h"
+
+namespace mongo {
+namespace {
+
+struct Node : public OperationArenaAllocated {
+    explicit Node(int v) : value(v) {}
+    virtual ~Node() {
+        ++destroyed;
+    }
+
+    int value;
+    static int destroyed;
+};
+
+int Node::destroyed = 0;
+
+TEST(OperationArenaTest, AllocationsAreAligned) {
+    OperationArena arena;
+    arena.allocate(1, 1);
+    void* ptr = arena.allocate(sizeof(double), alignof(double));
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % alignof(double));
+    ptr = arena.allocate(3, 64);
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % 64);
+    ASSERT_EQ(1U, arena.blockCount());
+}
+
+TEST(OperationArenaTest, ResetKeepsFirstBlock) {
+    OperationArena arena;
+    void* first = arena.allocate(16);
+    for (int i = 0; i < 100; ++i) {
+        arena.allocate(1024);
+    }
+    ASSERT_GT(arena.blockCount(), 1U);
+
+    arena.reset();
+    ASSERT_EQ(1U, arena.blockCount());
+    ASSERT_EQ(0U, arena.bytesAllocated());
+    ASSERT_EQ(first, arena.allocate(16));
+}
+
+TEST(OperationArenaTest, ResetReleasesOversizedFirstBlock) {
+    OperationArena arena;
+    arena.allocate(OperationArena::kInitialBlockSize * 4);
+    arena.reset();
+    ASSERT_EQ(0U, arena.blockCount());
+}
+
+TEST(OperationArenaTest, ContainersUseArena) {
+    OperationArena arena;
+    std::vector<int, OperationArena::Allocator<int>> values(OperationArena::Allocator<int>(&arena));
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(i);
+    }
+    ASSERT_GTE(arena.bytesAllocated(), 100 * sizeof(int));
+}
+
+TEST(OperationArenaTest, OptedInTypesUseCurrentArena) {
+    OperationArena arena;
+    Node::destroyed = 0;
+
+    auto onHeap = std::make_unique<Node>(1);
+    ASSERT_EQ(0U, arena.bytesAllocated());
+
+    {
+        OperationArena::Scope scope(&arena);
+        ASSERT_EQ(&arena, OperationArena::current());
+
+        auto inArena = std::make_unique<Node>(2);
+        ASSERT_GT(arena.bytesAllocated(), sizeof(Node));
+        ASSERT_EQ(2, inArena->value);
+    }
+    ASSERT_EQ(nullptr, OperationArena::current());
+    ASSERT_EQ(1, Node::destroyed);
+
+    onHeap.reset();
+    ASSERT_EQ(2, Node::destroyed);
+}
+
+TEST(OperationArenaTest, FullArenaFallsBackToHeap) {
+    OperationArena arena;
+    arena.allocate(OperationArena::kMaxScopedBytes);
+
+    OperationArena::Scope scope(&arena);
+    ASSERT_EQ(nullptr, OperationArena::current());
+}
+
+TEST(OperationArenaTest, ScopesNest) {
+    OperationArena outer;
+    OperationArena inner;
+    OperationArena::Scope outerScope(&outer);
+    {
+        OperationArena::Scope innerScope(&inner);
+        ASSERT_EQ(&inner, OperationArena::current());
+    }
+    ASSERT_EQ(&outer, OperationArena::current());
+
+    // A suspended coroutine takes the arena with it.
+    OperationArena* arena = OperationArena::releaseCurrent();
+    ASSERT_EQ(nullptr, OperationArena::current());
+    OperationArena::setCurrent(arena);
+    ASSERT_EQ(&outer, OperationArena::current());
+}
+
+}  // namespace
+}  // namespace mongo
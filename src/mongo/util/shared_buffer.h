@@ -51,6 +51,17 @@ public:
         return takeOwnership(mongoMalloc(sizeof(Holder) + bytes), bytes);
     }
 
+    /**
+     * Like allocate(), but rounds the capacity up to a size class and reuses a buffer released
+     * on the calling thread if there is one. When its last reference goes away, the buffer is
+     * cached by the releasing thread instead of being freed. Sizes above the largest class are
+     * allocated by allocate().
+     *
+     * Meant for short-lived buffers allocated at a high rate, such as received messages. See
+     * shared_buffer_pool.h.
+     */
+    static SharedBuffer allocatePooled(size_t bytes);
+
     /**
      * Resizes the buffer, copying the current contents.
      *
@@ -99,8 +110,8 @@ public:
 private:
     class Holder {
     public:
-        explicit Holder(AtomicUInt32::WordType initial, size_t capacity)
-            : _refCount(initial), _capacity(capacity) {
+        explicit Holder(AtomicUInt32::WordType initial, size_t capacity, uint32_t sizeClass = 0)
+            : _refCount(initial), _capacity(capacity), _sizeClass(sizeClass) {
             invariant(capacity == _capacity);
         }
 
@@ -111,9 +122,18 @@ private:
 
         friend void intrusive_ptr_release(Holder* h) {
             if (h->_refCount.subtractAndFetch(1) == 0) {
-                // We placement new'ed a Holder in takeOwnership above,
-                // so we must destroy the object here.
-                h->~Holder();
+                destroy(h);
+            }
+        }
+
+        static void destroy(Holder* h) {
+            // We placement new'ed a Holder in takeOwnership above,
+            // so we must destroy the object here.
+            const uint32_t sizeClass = h->_sizeClass;
+            h->~Holder();
+            if (sizeClass) {
+                _releasePooled(h, sizeClass);
+            } else {
                 free(h);
             }
         }
@@ -132,8 +152,17 @@ private:
 
         AtomicUInt32 _refCount;
         uint32_t _capacity;
+        // 1-based size class of a buffer from allocatePooled(), 0 for other buffers.
+        uint32_t _sizeClass;
+        // Keeps data() aligned to 16 bytes.
+        uint32_t _padding{0};
     };
 
+    /**
+     * Caches or frees the memory of a pooled buffer whose last reference went away.
+     */
+    static void _releasePooled(void* holderPrefixedData, uint32_t sizeClass);
+
     explicit SharedBuffer(Holder* holder) : _holder(holder, /*add_ref=*/false) {
         // NOTE: The 'false' above is because we have already initialized the Holder with a
         // refcount of '1' in takeOwnership below. This avoids an atomic increment.
@@ -146,12 +175,14 @@ private:
      * This class will call free(holderPrefixedData), so it must have been allocated in a way
      * that makes that valid.
      */
-    static SharedBuffer takeOwnership(void* holderPrefixedData, size_t capacity) {
+    static SharedBuffer takeOwnership(void* holderPrefixedData,
+                                      size_t capacity,
+                                      uint32_t sizeClass = 0) {
         // Initialize the refcount to 1 so we don't need to increment it in the constructor
         // (see private Holder* constructor above).
         //
         // TODO: Should dassert alignment of holderPrefixedData here if possible.
-        return SharedBuffer(new (holderPrefixedData) Holder(1U, capacity));
+        return SharedBuffer(new (holderPrefixedData) Holder(1U, capacity, sizeClass));
     }
 
     boost::intrusive_ptr<Holder> _holder;
@@ -0,0 +1,164 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/shared_buffer_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+AtomicInt32 sharedBufferPoolThreadCacheBytes(1024 * 1024);
+
+namespace {
+
+struct SizeClassStats {
+    // Buffers obtained from, and given back to, the allocator.
+    std::atomic<uint64_t> allocated{0};
+    std::atomic<uint64_t> freed{0};
+};
+
+SizeClassStats sizeClassStats[SharedBufferPool::kSizeClassCnt];
+
+struct LocalCache {
+    ~LocalCache() {
+        for (size_t i = 0; i < SharedBufferPool::kSizeClassCnt; ++i) {
+            for (void* buffer : buffers[i]) {
+                std::free(buffer);
+            }
+            sizeClassStats[i].freed.fetch_add(buffers[i].size(), std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<void*> buffers[SharedBufferPool::kSizeClassCnt];
+    size_t bytes{0};
+};
+
+// Buffers may be released while the thread exits, after its thread_local objects have been
+// destroyed, so the cache is reached through a trivially destructible pointer.
+thread_local LocalCache* localCache = nullptr;
+thread_local bool localCacheDestroyed = false;
+
+struct LocalCacheOwner {
+    ~LocalCacheOwner() {
+        delete localCache;
+        localCache = nullptr;
+        localCacheDestroyed = true;
+    }
+};
+
+thread_local LocalCacheOwner localCacheOwner;
+
+LocalCache* getLocalCache() {
+    if (!localCache && !localCacheDestroyed) {
+        // Constructs the owner on this thread, so that the cache is freed when the thread exits.
+        (void)&localCacheOwner;
+        localCache = new LocalCache();
+    }
+    return localCache;
+}
+
+size_t sizeClassBytes(uint32_t sizeClass) {
+    return SharedBufferPool::kSizeClassBytes[sizeClass - 1];
+}
+
+}  // namespace
+
+uint32_t SharedBufferPool::sizeClassFor(size_t bytes) {
+    for (size_t i = 0; i < kSizeClassCnt; ++i) {
+        if (bytes <= kSizeClassBytes[i]) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+size_t SharedBufferPool::localCacheBytes() {
+    return localCache ? localCache->bytes : 0;
+}
+
+void SharedBufferPool::appendStats(BSONObjBuilder* bob) {
+    bob->append("threadCacheBytes", sharedBufferPoolThreadCacheBytes.load());
+    for (size_t i = 0; i < kSizeClassCnt; ++i) {
+        BSONObjBuilder sizeClass(bob->subobjStart(std::to_string(kSizeClassBytes[i])));
+        sizeClass.append(
+            "allocated",
+            static_cast<long long>(sizeClassStats[i].allocated.load(std::memory_order_relaxed)));
+        sizeClass.append(
+            "freed",
+            static_cast<long long>(sizeClassStats[i].freed.load(std::memory_order_relaxed)));
+    }
+}
+
+SharedBuffer SharedBuffer::allocatePooled(size_t bytes) {
+    const uint32_t sizeClass = SharedBufferPool::sizeClassFor(sizeof(Holder) + bytes);
+    if (!sizeClass) {
+        return allocate(bytes);
+    }
+
+    const size_t classBytes = sizeClassBytes(sizeClass);
+    void* ptr = nullptr;
+    if (auto cache = getLocalCache()) {
+        auto& buffers = cache->buffers[sizeClass - 1];
+        if (!buffers.empty()) {
+            ptr = buffers.back();
+            buffers.pop_back();
+            cache->bytes -= classBytes;
+        }
+    }
+    if (!ptr) {
+        ptr = mongoMalloc(classBytes);
+        sizeClassStats[sizeClass - 1].allocated.fetch_add(1, std::memory_order_relaxed);
+    }
+    return takeOwnership(ptr, classBytes - sizeof(Holder), sizeClass);
+}
+
+void SharedBuffer::_releasePooled(void* holderPrefixedData, uint32_t sizeClass) {
+    const size_t classBytes = sizeClassBytes(sizeClass);
+    auto cache = getLocalCache();
+    if (cache &&
+        cache->bytes + classBytes <=
+            static_cast<size_t>(std::max(0, sharedBufferPoolThreadCacheBytes.load()))) {
+        cache->buffers[sizeClass - 1].push_back(holderPrefixedData);
+        cache->bytes += classBytes;
+        return;
+    }
+
+    std::free(holderPrefixedData);
+    sizeClassStats[sizeClass - 1].freed.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace mongo
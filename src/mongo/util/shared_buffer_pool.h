@@ -0,0 +1,71 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+class BSONObjBuilder;
+
+/*
+  Thread caches of buffers returned by SharedBuffer::allocatePooled().
+
+  Pooled buffers come in a few size classes. A released buffer is kept by the releasing thread
+  as long as that thread's cache stays within sharedBufferPoolThreadCacheBytes, and freed
+  otherwise. Threads which both receive and process requests, such as the coroutine thread
+  groups in run-to-completion mode, serve most of their receive buffers from their own cache.
+*/
+extern AtomicInt32 sharedBufferPoolThreadCacheBytes;
+
+class SharedBufferPool {
+public:
+    static constexpr size_t kSizeClassCnt = 4;
+
+    /*
+      Allocation size of each class, including the buffer header.
+    */
+    static constexpr size_t kSizeClassBytes[kSizeClassCnt] = {1024, 4096, 16384, 65536};
+
+    /*
+      Returns the 1-based size class of an allocation of 'bytes', or 0 if it is too large for
+      every class.
+    */
+    static uint32_t sizeClassFor(size_t bytes);
+
+    /*
+      Number of bytes cached by the calling thread.
+    */
+    static size_t localCacheBytes();
+
+    static void appendStats(BSONObjBuilder* bob);
+};
+
+}  // namespace mongo
@@ -0,0 +1,78 @@
+/*    Copyright 2018 MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/shared_buffer.h"
+#include "mongo/util/shared_buffer_pool.h"
+
+namespace mongo {
+namespace {
+
+TEST(SharedBufferPoolTest, SizeClasses) {
+    ASSERT_EQ(1U, SharedBufferPool::sizeClassFor(1));
+    ASSERT_EQ(1U, SharedBufferPool::sizeClassFor(1024));
+    ASSERT_EQ(2U, SharedBufferPool::sizeClassFor(1025));
+    ASSERT_EQ(4U, SharedBufferPool::sizeClassFor(65536));
+    ASSERT_EQ(0U, SharedBufferPool::sizeClassFor(65537));
+}
+
+TEST(SharedBufferPoolTest, CapacityFillsSizeClass) {
+    auto buffer = SharedBuffer::allocatePooled(100);
+    ASSERT_EQ(1024U - 16U, buffer.capacity());
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(buffer.get()) % 16);
+
+    auto large = SharedBuffer::allocatePooled(1 << 20);
+    ASSERT_EQ(size_t(1 << 20), large.capacity());
+}
+
+TEST(SharedBufferPoolTest, ReleasedBuffersAreReused) {
+    const size_t cachedBefore = SharedBufferPool::localCacheBytes();
+    char* data;
+    {
+        auto buffer = SharedBuffer::allocatePooled(2000);
+        data = buffer.get();
+    }
+    ASSERT_EQ(cachedBefore + 4096, SharedBufferPool::localCacheBytes());
+
+    auto buffer = SharedBuffer::allocatePooled(3000);
+    ASSERT_EQ(data, buffer.get());
+    ASSERT_EQ(cachedBefore, SharedBufferPool::localCacheBytes());
+}
+
+TEST(SharedBufferPoolTest, BuffersBeyondTheBudgetAreFreed) {
+    const int oldBudget = sharedBufferPoolThreadCacheBytes.load();
+    sharedBufferPoolThreadCacheBytes.store(0);
+    const size_t cachedBefore = SharedBufferPool::localCacheBytes();
+    { auto buffer = SharedBuffer::allocatePooled(20000); }
+    ASSERT_EQ(cachedBefore, SharedBufferPool::localCacheBytes());
+    sharedBufferPoolThreadCacheBytes.store(oldBudget);
+}
+
+}  // namespace
+}  // namespace mongo